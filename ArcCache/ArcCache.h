@@ -1,3 +1,5 @@
+#include "../CacheMetrics.h"
+#include "../CacheProbe.h"
 #include "../ICachePolicy.h"
 #include "ArcLruPart.h" 
 #include "ArcLfuPart.h"
@@ -5,17 +7,19 @@
 
 namespace XrmsCache
 {
-template<typename Key, typename Value>
+// Hasher为key的哈希函数（默认CacheHash），LRU和LFU两部分的索引共用
+template<typename Key, typename Value, typename Hasher = CacheHash<Key>>
 class ArcCache : public ICachePolicy<Key, Value>
 {
 // std::make_unique就是创建并返回一个 std::unique_ptr 智能指针
 public:
     // 构造函数 初始化缓存容量和转换阈值 并且构建LRU和LFU部分的缓存实例 
-    explicit ArcCache(size_t capacity = 10, size_t transformThreshold = 2)
+    // resource为两部分节点和索引的内存来源，为空时使用默认的malloc
+    explicit ArcCache(size_t capacity = 10, size_t transformThreshold = 2, std::pmr::memory_resource* resource = nullptr)
         : capacity_(capacity)
         , transformThreshold_(transformThreshold)
-        , lruPart_(std::make_unique<ArcLruPart<Key, Value>>(capacity, transformThreshold))
-        , lfuPart_(std::make_unique<ArcLfuPart<Key, Value>>(capacity, transformThreshold))
+        , lruPart_(std::make_unique<ArcLruPart<Key, Value, Hasher>>(capacity, transformThreshold, resource))
+        , lfuPart_(std::make_unique<ArcLfuPart<Key, Value, Hasher>>(capacity, transformThreshold, resource))
     {}
 
     // 析构函数，使用默认实现
@@ -24,6 +28,7 @@ public:
     // 向缓存中插入键值对
     void put(Key key, Value value) override
     {
+        LatencyTimer timer(stats_ ? &stats_->putLatency : nullptr);
         // 检查幽灵缓存中是否存在该键
         bool inGhost = checkGhostCaches(key);
 
@@ -42,6 +47,10 @@ public:
             // 如果幽灵缓存中存在该键，只将键值对插入LRU邠
             lruPart_->put(key, value);
         }
+        if (stats_)
+        {
+            stats_->setEntries(lruPart_->size() + lfuPart_->size());
+        }
     }
 
     // 从缓存中获取键对应的值
@@ -49,6 +58,11 @@ public:
     // 如果键不存在，返回false
     bool get(Key key, Value& value) override
     {
+        LatencyTimer timer(stats_ ? &stats_->getLatency : nullptr);
+        if (stats_ && stats_->mrc)
+        {
+            stats_->access(Hasher()(key));
+        }
         // 检查幽灵缓存中是否存在该键
         checkGhostCaches(key);
 
@@ -62,10 +76,20 @@ public:
                 // 将键值对插入LFU部分
                 lfuPart_->put(key, value);
             }
+            XRMS_CACHE_PROBE_KEY(hit, this, key);
+            countLookup(true);
             return true;
         }
         // 如果LRU部分找不到，尝试从LFU部分获取
-        return lfuPart_->get(key, value);
+        if (lfuPart_->get(key, value))
+        {
+            XRMS_CACHE_PROBE_KEY(hit, this, key);
+            countLookup(true);
+            return true;
+        }
+        XRMS_CACHE_PROBE_KEY(miss, this, key);
+        countLookup(false);
+        return false;
     }
 
     // 从缓存中获取键对应的值
@@ -80,7 +104,54 @@ public:
         return value;
     }
 
+    // 挂上运行指标（见CacheMetrics.h），两部分的淘汰和锁竞争计入同一组；为空则停止统计。
+    // 条目数为两部分之和，同一个key可能同时在两部分中，各计一次；需在并发访问开始之前设置
+    void setStats(std::shared_ptr<CacheStats> stats)
+    {
+        stats_ = std::move(stats);
+        lruPart_->setStats(stats_.get());
+        lfuPart_->setStats(stats_.get());
+        if (stats_)
+        {
+            stats_->capacity.store(capacity_, std::memory_order_relaxed);
+            stats_->setEntries(lruPart_->size() + lfuPart_->size());
+        }
+    }
+
+    // 在metrics中登记一组指标（标签cache=name），estimateMrc为true时同时估计未命中率曲线
+    void setMetrics(CacheMetrics& metrics, const std::string& name, bool estimateMrc = true)
+    {
+        std::shared_ptr<CacheStats> stats = metrics.addStats(name);
+        if (estimateMrc)
+        {
+            stats->mrc = metrics.addEstimator(name, capacity_ * 4);
+        }
+        setStats(std::move(stats));
+    }
+
+    // LRU和LFU两部分内存占用之和；同一个key可能同时在两部分中，各计一次
+    CacheMemoryUsage memoryUsage()
+    {
+        CacheMemoryUsage usage = lruPart_->memoryUsage();
+        usage += lfuPart_->memoryUsage();
+        return usage;
+    }
+
+    void setWeigher(CacheWeigher<Key, Value> weigher)
+    {
+        lruPart_->setWeigher(weigher);
+        lfuPart_->setWeigher(weigher);
+    }
+
 private:
+    void countLookup(bool hit)
+    {
+        if (stats_)
+        {
+            CacheStats::bump(hit ? stats_->hits : stats_->misses);
+        }
+    }
+
     /* 检查幽灵缓存中是否存在指定的键
      * 如果存在，根据情况调整LRU部分和LFU部分的容量
      * 返回是否能在幽灵缓存中找到该建
@@ -91,6 +162,12 @@ private:
         // 检查LRU部分的幽灵缓存中是否存在该键
         if (lruPart_->checkGhost(key))
         {
+            XRMS_CACHE_PROBE4(ghost_hit, static_cast<const void*>(this),
+                              CacheProbe::keyData(key), CacheProbe::keySize(key), 0);
+            if (stats_)
+            {
+                CacheStats::bump(stats_->ghostHits);
+            }
             // 如果存在，尝试减少LFU部分的容量
             if (lfuPart_->decreaseCapacity())
             {
@@ -101,6 +178,12 @@ private:
         }// 如果LRU部分的幽灵缓存中不存在该键，检查LFU部分的幽灵缓存
         else if (lfuPart_->checkGhost(key))
         {
+            XRMS_CACHE_PROBE4(ghost_hit, static_cast<const void*>(this),
+                              CacheProbe::keyData(key), CacheProbe::keySize(key), 1);
+            if (stats_)
+            {
+                CacheStats::bump(stats_->ghostHits);
+            }
             // 如果存在，尝试减少LRU部分的容量
             if (lruPart_->decreaseCapacity())
             {
@@ -118,8 +201,10 @@ private:
     size_t transformThreshold_;
 
     // 指向LRU部分缓存的智能指针
-    std::unique_ptr<ArcLruPart<Key, Value>> lruPart_;
+    std::unique_ptr<ArcLruPart<Key, Value, Hasher>> lruPart_;
     // 指向LFU部分缓存的智能指针
-    std::unique_ptr<ArcLfuPart<Key, Value>> lfuPart_;
+    std::unique_ptr<ArcLfuPart<Key, Value, Hasher>> lfuPart_;
+    // 运行指标，为空表示不统计
+    std::shared_ptr<CacheStats> stats_;
 };
 } // namespace XrmsCache
\ No newline at end of file
@@ -32,10 +32,10 @@ public:
     // ======================
 
     /** @brief 获取节点键 */
-    Key getKey() const { return key_; }
+    const Key& getKey() const { return key_; }
 
     /** @brief 获取节点值 */
-    Value getValue() const { return value_; }
+    const Value& getValue() const { return value_; }
 
     /** @brief 获取访问计数 （用于LFU策略） */
     size_t getAccessCount() const { return accessCount_; }
@@ -60,8 +60,8 @@ public:
      * ArcLfuPart：ARC算法的LFU部分
      * 允许这两个部分访问私有成员（链表操作需要修改prev/next指针）
      */
-    template<typename K, typename V> friend class ArcLruPart;
-    template<typename K, typename V> friend class ArcLfuPart;
+    template<typename K, typename V, typename H> friend class ArcLruPart;
+    template<typename K, typename V, typename H> friend class ArcLfuPart;
 };
 
 } // namespace XrmsCache
\ No newline at end of file
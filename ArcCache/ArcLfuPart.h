@@ -1,34 +1,66 @@
 #pragma once
 
 #include "ArcCacheNode.h"
-#include <unordered_map>
+#include "../CacheHash.h"
+#include "../CacheIndex.h"
+#include "../CacheMemory.h"
+#include "../CacheMetrics.h"
+#include "../CachePhase.h"
+#include "../CacheProbe.h"
+#include <algorithm>
+#include <iterator>
+#include <list>
 #include <map>
 #include <mutex>
+#include <vector>
 
 namespace XrmsCache 
 {
 
 // 定义一个模板类 ArcLfuPart，用于实现 ARC（Adaptive Replacement Cache）缓存算法中的 LFU（Least Frequently Used）部分
 // Key 是缓存键的类型，Value 是缓存值的类型
-template<typename Key, typename Value>
+// Hasher 是主缓存和幽灵缓存索引使用的哈希函数
+template<typename Key, typename Value, typename Hasher = CacheHash<Key>>
 class ArcLfuPart 
 {
 public:
     // 定义类型别名，方便后续使用
     using NodeType = ArcNode<Key, Value>;  // 节点类型，使用 ArcNode 模板类
     using NodePtr = std::shared_ptr<NodeType>;  // 节点指针类型，使用智能指针管理节点
-    using NodeMap = std::unordered_map<Key, NodePtr>;  // 主缓存和幽灵缓存使用的映射类型，键为 Key，值为节点指针
-    using FreqMap = std::map<size_t, std::list<NodePtr>>;  // 频率映射类型，键为访问频率，值为节点指针列表
+    using NodeMap = IncrementalHashMap<Key, NodePtr, Hasher>;  // 幽灵缓存使用的映射类型，渐进式扩容，容量转移时不会一次性重新散列
+    using FreqList = std::pmr::list<NodePtr>;  // 同一访问频率的节点，按进入该频率的先后排列
+    using FreqMap = std::pmr::map<size_t, FreqList>;  // 频率映射类型，键为访问频率，值为节点指针列表，与节点使用同一个内存来源
+
+    // 主缓存的条目：节点和它在频率列表中的位置，命中时用splice把节点移到下一个频率列表，不用遍历也不用分配
+    struct MainEntry
+    {
+        NodePtr node;
+        typename FreqList::iterator pos;
+    };
+    using MainMap = IncrementalHashMap<Key, MainEntry, Hasher>;
 
     // 构造函数，接受缓存容量和转换阈值作为参数
     // capacity 表示主缓存的容量
     // transformThreshold 表示从 LFU 部分转换到其他部分的阈值
-    explicit ArcLfuPart(size_t capacity, size_t transformThreshold)
+    // resource 为节点、索引和频率列表的内存来源，为空时使用默认的malloc
+    explicit ArcLfuPart(size_t capacity, size_t transformThreshold, std::pmr::memory_resource* resource = nullptr)
         : capacity_(capacity)  // 初始化主缓存容量
         , ghostCapacity_(capacity)  // 初始化幽灵缓存容量，与主缓存容量相同
         , transformThreshold_(transformThreshold)  // 初始化转换阈值
-        , minFreq_(0)  // 初始化最小访问频率为 0
+        , nodeMemory_(resource)
+        , frequencyMemory_(resource)
+        , mainCache_(capacity, resource)  // 按初始容量预分配索引
+        , ghostCache_(capacity, resource)
+        , freqMap_(&frequencyMemory_)
+        , nodeAllocator_(&nodeMemory_)
     {
+        // 备用频率列表在构造时就备好（映射节点连同空列表），全新的缓存在命中时建立频率列表也不必分配
+        size_t spares = std::min(capacity_ + 1, kMaxSpareFreqLists);
+        spareFreqLists_.reserve(kMaxSpareFreqLists);
+        for (size_t freq = 0; freq < spares; ++freq)
+        {
+            spareFreqLists_.push_back(freqMap_.extract(freqMap_.try_emplace(freq).first));
+        }
         initializeLists();  // 调用初始化函数，初始化幽灵缓存的链表
     }
 
@@ -36,16 +68,16 @@ public:
     // key 是要插入的键
     // value 是要插入的值
     // 返回插入是否成功
-    bool put(Key key, Value value) 
+    bool put(const Key& key, const Value& value)
     {
         if (capacity_ == 0) 
             return false;  // 如果缓存容量为 0，插入失败
 
-        std::lock_guard<std::mutex> lock(mutex_);  // 加锁，保证线程安全
-        auto it = mainCache_.find(key);  // 在主缓存中查找键
-        if (it != mainCache_.end()) 
+        std::unique_lock<std::mutex> lock = CacheProbe::lock(mutex_, this, contendedCounter());  // 加锁，保证线程安全
+        MainEntry* entry = XRMS_CACHE_PHASE(Lookup, mainCache_.find(key));  // 在主缓存中查找键
+        if (entry) 
         {
-            return updateExistingNode(it->second, value);  // 如果键已存在，更新节点的值和频率
+            return updateExistingNode(*entry, value);  // 如果键已存在，更新节点的值和频率
         }
         return addNewNode(key, value);  // 如果键不存在，添加新节点
     }
@@ -56,12 +88,12 @@ public:
     // 返回是否成功获取到值
     bool get(Key key, Value& value) 
     {
-        std::lock_guard<std::mutex> lock(mutex_);  // 加锁，保证线程安全
-        auto it = mainCache_.find(key);  // 在主缓存中查找键
-        if (it != mainCache_.end()) 
+        std::unique_lock<std::mutex> lock = CacheProbe::lock(mutex_, this, contendedCounter());  // 加锁，保证线程安全
+        MainEntry* entry = XRMS_CACHE_PHASE(Lookup, mainCache_.find(key));  // 在主缓存中查找键
+        if (entry) 
         {
-            updateNodeFrequency(it->second);  // 如果键存在，更新节点的访问频率
-            value = it->second->getValue();  // 获取节点的值
+            XRMS_CACHE_PHASE(Promote, updateNodeFrequency(*entry));  // 如果键存在，更新节点的访问频率
+            XRMS_CACHE_PHASE(ValueCopy, value = entry->node->value_);  // 获取节点的值
             return true;  // 返回获取成功
         }
         return false;  // 如果键不存在，返回获取失败
@@ -72,16 +104,58 @@ public:
     // 返回幽灵缓存中是否存在该键
     bool checkGhost(Key key) 
     {
-        auto it = ghostCache_.find(key);  // 在幽灵缓存中查找键
-        if (it != ghostCache_.end()) 
+        NodePtr* node = XRMS_CACHE_PHASE(Lookup, ghostCache_.find(key));  // 在幽灵缓存中查找键
+        if (node) 
         {
-            removeFromGhost(it->second);  // 如果键存在，从幽灵缓存中移除该节点
-            ghostCache_.erase(it);  // 从幽灵缓存映射中删除该键值对
+            removeFromGhost(*node);  // 如果键存在，从幽灵缓存中移除该节点
+            XRMS_CACHE_PHASE(IndexErase, ghostCache_.erase(key));  // 从幽灵缓存映射中删除该键值对
             return true;  // 返回存在该键
         }
         return false;  // 如果键不存在，返回不存在该键
     }
 
+    // 内存占用：节点和频率映射经计数的resource分配，节点大小都相同，幽灵节点按个数从中分出；
+    // 索引按表的大小计
+    CacheMemoryUsage memoryUsage()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        CacheMemoryUsage usage;
+        size_t allocations = nodeMemory_.allocations();
+        size_t ghostNodes = allocations == 0 ? 0 : nodeMemory_.bytes() / allocations * ghostCache_.size();
+        usage.entries = mainCache_.size();
+        usage.index = mainCache_.memoryBytes();
+        usage.nodes = nodeMemory_.bytes() - ghostNodes;
+        usage.ghost = ghostCache_.memoryBytes() + ghostNodes;
+        usage.frequency = frequencyMemory_.bytes();
+        for (const auto& pair : freqMap_)
+        {
+            for (const NodePtr& node : pair.second)
+            {
+                usage.values += CacheMemory::weigh(weigher_, node->key_, node->value_);
+            }
+        }
+        return usage;
+    }
+
+    void setWeigher(CacheWeigher<Key, Value> weigher)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        weigher_ = std::move(weigher);
+    }
+
+    // 淘汰和锁竞争计入stats，由ArcCache设置
+    void setStats(CacheStats* stats)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_ = stats;
+    }
+
+    size_t size()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return mainCache_.size();
+    }
+
     // 增加主缓存的容量
     void increaseCapacity() { ++capacity_; }
     
@@ -92,30 +166,42 @@ public:
         if (capacity_ <= 0) return false;  // 如果容量已经为 0，减少失败
         if (mainCache_.size() == capacity_) 
         {
-            evictLeastFrequent();  // 如果主缓存已满，移除最不常使用的节点
+            evictLeastFrequent(CacheProbe::EvictReason::Adapt);  // 如果主缓存已满，移除最不常使用的节点
         }
         --capacity_;  // 减少容量
         return true;  // 返回减少成功
     }
 
 private:
+    std::atomic<uint64_t>* contendedCounter() const
+    {
+        return stats_ ? &stats_->lockContended : nullptr;
+    }
+
+    // 节点连同shared_ptr控制块一起从resource分配
+    template<typename... Args>
+    NodePtr makeNode(Args&&... args)
+    {
+        return std::allocate_shared<NodeType>(nodeAllocator_, std::forward<Args>(args)...);
+    }
+
     // 初始化幽灵缓存的链表
     void initializeLists() 
     {
-        ghostHead_ = std::make_shared<NodeType>();  // 创建幽灵缓存链表的头节点
-        ghostTail_ = std::make_shared<NodeType>();  // 创建幽灵缓存链表的尾节点
+        ghostHead_ = makeNode();  // 创建幽灵缓存链表的头节点
+        ghostTail_ = makeNode();  // 创建幽灵缓存链表的尾节点
         ghostHead_->next_ = ghostTail_;  // 头节点的下一个节点指向尾节点
         ghostTail_->prev_ = ghostHead_;  // 尾节点的前一个节点指向头节点
     }
 
     // 更新已存在节点的值和频率
-    // node 是要更新的节点指针
+    // entry 是节点在主缓存中的条目
     // value 是要更新的值
     // 返回更新是否成功
-    bool updateExistingNode(NodePtr node, const Value& value) 
+    bool updateExistingNode(MainEntry& entry, const Value& value) 
     {
-        node->setValue(value);  // 更新节点的值
-        updateNodeFrequency(node);  // 更新节点的访问频率
+        XRMS_CACHE_PHASE(ValueCopy, entry.node->setValue(value));  // 更新节点的值
+        XRMS_CACHE_PHASE(Promote, updateNodeFrequency(entry));  // 更新节点的访问频率
         return true;  // 返回更新成功
     }
 
@@ -127,75 +213,97 @@ private:
     {
         if (mainCache_.size() >= capacity_) 
         {
-            evictLeastFrequent();  // 如果主缓存已满，移除最不常使用的节点
+            evictLeastFrequent(CacheProbe::EvictReason::Capacity);  // 如果主缓存已满，移除最不常使用的节点
         }
 
-        NodePtr newNode = std::make_shared<NodeType>(key, value);  // 创建新节点
-        mainCache_[key] = newNode;  // 将新节点添加到主缓存映射中
+        NodePtr newNode = XRMS_CACHE_PHASE(Alloc, makeNode(key, value));  // 创建新节点
+
+        // 将新节点添加到频率为 1 的列表末尾
+        auto pos = XRMS_CACHE_PHASE(Promote, addToFreqOne(newNode));
+        XRMS_CACHE_PHASE(IndexInsert, mainCache_.insertOrAssign(key, MainEntry{newNode, pos}));  // 将新节点添加到主缓存映射中
         
-        // 将新节点添加到频率为 1 的列表中
-        if (freqMap_.find(1) == freqMap_.end()) 
+        return true;  // 返回添加成功
+    }
+
+    // 新节点放到频率为 1 的列表末尾，返回它在列表中的位置
+    typename FreqList::iterator addToFreqOne(const NodePtr& node)
+    {
+        auto it = freqMap_.find(1);
+        if (it == freqMap_.end())
         {
-            freqMap_[1] = std::list<NodePtr>();  // 如果频率为 1 的列表不存在，创建一个新的列表
+            it = insertFreqList(1);
+        }
+        FreqList& list = it->second;
+        list.push_back(node);
+        return std::prev(list.end());
+    }
+
+    // 更新节点的访问频率：节点从旧频率列表splice到新频率列表末尾，不分配内存
+    // entry 是节点在主缓存中的条目
+    void updateNodeFrequency(MainEntry& entry) 
+    {
+        size_t oldFreq = entry.node->getAccessCount();  // 获取节点的旧访问频率
+        entry.node->incrementAccessCount();  // 增加节点的访问频率
+        size_t newFreq = entry.node->getAccessCount();  // 获取节点的新访问频率
+
+        auto oldIt = freqMap_.find(oldFreq);
+        auto newIt = freqMap_.find(newFreq);
+        if (newIt == freqMap_.end() && oldIt->second.size() == 1)
+        {
+            // 节点独占旧频率列表且新频率还没有列表：把这个列表直接改记为新频率，节点不用移动
+            auto freqList = freqMap_.extract(oldIt);
+            freqList.key() = newFreq;
+            freqMap_.insert(std::move(freqList));
+            return;
+        }
+        if (newIt == freqMap_.end())
+        {
+            newIt = insertFreqList(newFreq);
+        }
+        newIt->second.splice(newIt->second.end(), oldIt->second, entry.pos);  // 迭代器在splice后仍然有效
+        if (oldIt->second.empty())
+        {
+            recycleFreqList(oldIt);  // 旧频率列表已空，留作备用
         }
-        freqMap_[1].push_back(newNode);  // 将新节点添加到频率为 1 的列表末尾
-        minFreq_ = 1;  // 更新最小访问频率为 1
-        
-        return true;  // 返回添加成功
     }
 
-    // 更新节点的访问频率
-    // node 是要更新频率的节点指针
-    void updateNodeFrequency(NodePtr node) 
+    // 新建频率列表：优先复用备用的映射节点，没有时才分配
+    typename FreqMap::iterator insertFreqList(size_t freq)
     {
-        size_t oldFreq = node->getAccessCount();  // 获取节点的旧访问频率
-        node->incrementAccessCount();  // 增加节点的访问频率
-        size_t newFreq = node->getAccessCount();  // 获取节点的新访问频率
-
-        // 从旧频率列表中移除节点
-        auto& oldList = freqMap_[oldFreq];
-        oldList.remove(node);
-        if (oldList.empty()) 
+        if (spareFreqLists_.empty())
         {
-            freqMap_.erase(oldFreq);  // 如果旧频率列表为空，从频率映射中删除该频率项
-            if (oldFreq == minFreq_) 
-            {
-                minFreq_ = newFreq;  // 如果旧频率是最小频率，更新最小频率为新频率
-            }
+            return freqMap_.try_emplace(freq).first;
         }
+        auto freqList = std::move(spareFreqLists_.back());
+        spareFreqLists_.pop_back();
+        freqList.key() = freq;
+        return freqMap_.insert(std::move(freqList)).position;
+    }
 
-        // 添加到新频率列表
-        if (freqMap_.find(newFreq) == freqMap_.end()) 
+    // 摘下空的频率列表，连同映射节点留作备用；备用数量有上限，超出时直接释放
+    void recycleFreqList(typename FreqMap::iterator it)
+    {
+        if (spareFreqLists_.size() < kMaxSpareFreqLists)
         {
-            freqMap_[newFreq] = std::list<NodePtr>();  // 如果新频率列表不存在，创建一个新的列表
+            spareFreqLists_.push_back(freqMap_.extract(it));
+        }
+        else
+        {
+            freqMap_.erase(it);
         }
-        freqMap_[newFreq].push_back(node);  // 将节点添加到新频率列表末尾
     }
 
     // 移除最不常使用的节点
-    void evictLeastFrequent() 
+    void evictLeastFrequent(CacheProbe::EvictReason reason) 
     {
         if (freqMap_.empty()) 
             return;  // 如果频率映射为空，直接返回
 
-        // 获取最小频率的列表
-        auto& minFreqList = freqMap_[minFreq_];
-        if (minFreqList.empty()) 
-            return;  // 如果最小频率列表为空，直接返回
-
-        // 移除最少使用的节点
-        NodePtr leastNode = minFreqList.front();
-        minFreqList.pop_front();
-
-        // 如果该频率的列表为空，则删除该频率项
-        if (minFreqList.empty()) 
+        NodePtr leastNode = XRMS_CACHE_PHASE(Victim, takeLeastFrequent());
+        XRMS_CACHE_PROBE_EVICT(this, leastNode->getKey(), reason);
+        if (stats_)
         {
-            freqMap_.erase(minFreq_);
-            // 更新最小频率
-            if (!freqMap_.empty()) 
-            {
-                minFreq_ = freqMap_.begin()->first;
-            }
+            CacheStats::bump(stats_->evictions);
         }
 
         // 将节点移到幽灵缓存
@@ -206,7 +314,26 @@ private:
         addToGhost(leastNode);  // 将节点添加到幽灵缓存
         
         // 从主缓存中移除
-        mainCache_.erase(leastNode->getKey());
+        XRMS_CACHE_PHASE(IndexErase, mainCache_.erase(leastNode->getKey()));
+    }
+
+    // 从最小频率列表头部摘下节点
+    NodePtr takeLeastFrequent()
+    {
+        // 频率映射按频率有序，第一项就是最小频率的列表，同一频率中最早进入的节点在列表头部
+        auto it = freqMap_.begin();
+        FreqList& minFreqList = it->second;
+
+        // 移除最少使用的节点
+        NodePtr leastNode = std::move(minFreqList.front());
+        minFreqList.pop_front();
+
+        // 如果该频率的列表为空，则留作备用
+        if (minFreqList.empty()) 
+        {
+            recycleFreqList(it);
+        }
+        return leastNode;
     }
 
     // 从幽灵缓存链表中移除指定节点
@@ -225,7 +352,7 @@ private:
         node->prev_ = ghostTail_->prev_;  // 节点的前一个节点指向尾节点的前一个节点
         ghostTail_->prev_->next_ = node;  // 尾节点的前一个节点的下一个节点指向该节点
         ghostTail_->prev_ = node;  // 尾节点的前一个节点指向该节点
-        ghostCache_[node->getKey()] = node;  // 将节点添加到幽灵缓存映射中
+        XRMS_CACHE_PHASE(IndexInsert, ghostCache_.insertOrAssign(node->getKey(), node));  // 将节点添加到幽灵缓存映射中
     }
 
     // 移除幽灵缓存中最旧的节点
@@ -235,20 +362,28 @@ private:
         if (oldestGhost != ghostTail_) 
         {
             removeFromGhost(oldestGhost);  // 从幽灵缓存链表中移除该节点
-            ghostCache_.erase(oldestGhost->getKey());  // 从幽灵缓存映射中删除该键值对
+            XRMS_CACHE_PHASE(IndexErase, ghostCache_.erase(oldestGhost->getKey()));  // 从幽灵缓存映射中删除该键值对
         }
     }
 
 private:
+    static constexpr size_t kMaxSpareFreqLists = 64;  // 备用频率列表的数量上限
+
     size_t capacity_;  // 主缓存的容量
     size_t ghostCapacity_;  // 幽灵缓存的容量
     size_t transformThreshold_;  // 从 LFU 部分转换到其他部分的阈值
-    size_t minFreq_;  // 最小访问频率
     std::mutex mutex_;  // 互斥锁，用于保证线程安全
+    // 节点和频率映射的内存来源，统计各自的占用；须在持有节点的成员之前声明
+    CacheMemory::CountingResource nodeMemory_;
+    CacheMemory::CountingResource frequencyMemory_;
 
-    NodeMap mainCache_;  // 主缓存映射，存储键值对
+    MainMap mainCache_;  // 主缓存映射，存储节点及其在频率列表中的位置
     NodeMap ghostCache_;  // 幽灵缓存映射，存储被移除的节点
     FreqMap freqMap_;  // 频率映射，存储每个访问频率对应的节点列表
+    std::vector<typename FreqMap::node_type> spareFreqLists_;  // 已清空、备用的频率列表（连同映射节点），构造时预先备好
+    std::pmr::polymorphic_allocator<NodeType> nodeAllocator_;  // 经nodeMemory_分配节点
+    CacheWeigher<Key, Value> weigher_;  // 统计values的权重函数，为空时用默认估计
+    CacheStats* stats_ = nullptr;  // 运行指标，由ArcCache持有
     
     NodePtr ghostHead_;  // 幽灵缓存链表的头节点
     NodePtr ghostTail_;  // 幽灵缓存链表的尾节点
@@ -1,55 +1,66 @@
 #pragma once
 
 #include "ArcCacheNode.h"
-#include <unordered_map>
+#include "../CacheHash.h"
+#include "../CacheIndex.h"
+#include "../CacheMemory.h"
+#include "../CacheMetrics.h"
+#include "../CachePhase.h"
+#include "../CacheProbe.h"
 #include <mutex>
 
 namespace XrmsCache
 {
 
-template<typename Key, typename Value>
+template<typename Key, typename Value, typename Hasher = CacheHash<Key>>
 class ArcLruPart
 {
 public:
     using NodeType = ArcNode<Key, Value>;
     using NodePtr = std::shared_ptr<NodeType>;
-    using NodeMap = std::unordered_map<Key, NodePtr>;
+    // 容量会随幽灵命中在两部分之间转移，索引用渐进式扩容的哈希表，避免扩容时一次性重新散列
+    using NodeMap = IncrementalHashMap<Key, NodePtr, Hasher>;
 
     // 构造函数 初始化缓存容量和转换阈值，并初始化链表
-    explicit ArcLruPart(size_t capacity, size_t transformThreshold)
+    // resource为节点和索引的内存来源，为空时使用默认的malloc
+    explicit ArcLruPart(size_t capacity, size_t transformThreshold, std::pmr::memory_resource* resource = nullptr)
         : capacity_(capacity)
         , ghostCapacity_(capacity)
         , transformThreshold_(transformThreshold)
+        , nodeMemory_(resource)
+        , mainCache_(capacity, resource)
+        , ghostCache_(capacity, resource)
+        , nodeAllocator_(&nodeMemory_)
     {
         initializeLists();
     }
 
 
     // 向缓存中插入键值对
-    bool put (Key key, Value value)
+    bool put(const Key& key, const Value& value)
     {
         if (capacity_ == 0) return false;
 
         // 使用互斥锁保护对缓存的并发访问
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::unique_lock<std::mutex> lock = CacheProbe::lock(mutex_, this, contendedCounter());
         // 在主缓存中查找键
-        auto it = mainCache_.find(key);
+        NodePtr* node = XRMS_CACHE_PHASE(Lookup, mainCache_.find(key));
         // 存在
-        if (it != mainCache_.end())
+        if (node)
         {
-            return updateExistingNode(it->second, value);
+            return updateExistingNode(*node, value);
         }
         return addNewNode(key, value);
     }
 
     bool get(Key key, Value& value, bool& shouldTransform)
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = mainCache_.find(key);
-        if (it != mainCache_.end())
+        std::unique_lock<std::mutex> lock = CacheProbe::lock(mutex_, this, contendedCounter());
+        NodePtr* node = XRMS_CACHE_PHASE(Lookup, mainCache_.find(key));
+        if (node)
         {
-            shouldTransform = updateNodeAccess(it->second);
-            value = it->second->getValue();
+            shouldTransform = XRMS_CACHE_PHASE(Promote, updateNodeAccess(*node));
+            XRMS_CACHE_PHASE(ValueCopy, value = (*node)->value_);
             return true;
         }
         return false;
@@ -57,16 +68,53 @@ public:
     // 检查幽灵缓存中是否存在键
     bool checkGhost (Key key)
     {
-        auto it = ghostCache_.find(key);
-        if (it != ghostCache_.end())
+        NodePtr* node = XRMS_CACHE_PHASE(Lookup, ghostCache_.find(key));
+        if (node)
         {
-            removeFromGhost(it->second);
-            ghostCache_.erase(it);
+            removeFromGhost(*node);
+            XRMS_CACHE_PHASE(IndexErase, ghostCache_.erase(key));
             return true;
         }
         return false;
     }
 
+    // 内存占用：节点经计数的resource分配，大小都相同，幽灵节点按个数从中分出；索引按表的大小计
+    CacheMemoryUsage memoryUsage()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        CacheMemoryUsage usage;
+        size_t allocations = nodeMemory_.allocations();
+        size_t ghostNodes = allocations == 0 ? 0 : nodeMemory_.bytes() / allocations * ghostCache_.size();
+        usage.entries = mainCache_.size();
+        usage.index = mainCache_.memoryBytes();
+        usage.nodes = nodeMemory_.bytes() - ghostNodes;
+        usage.ghost = ghostCache_.memoryBytes() + ghostNodes;
+        for (NodeType* node = mainHead_->next_.get(); node != mainTail_.get(); node = node->next_.get())
+        {
+            usage.values += CacheMemory::weigh(weigher_, node->key_, node->value_);
+        }
+        return usage;
+    }
+
+    void setWeigher(CacheWeigher<Key, Value> weigher)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        weigher_ = std::move(weigher);
+    }
+
+    // 淘汰、插入和锁竞争计入stats，由ArcCache设置
+    void setStats(CacheStats* stats)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_ = stats;
+    }
+
+    size_t size()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return mainCache_.size();
+    }
+
     // 增加缓存容量
     void increaseCapacity() { ++capacity_; }
 
@@ -77,23 +125,35 @@ public:
         if (mainCache_.size() == capacity_)
         {
             // 如果当前缓存已经满了 驱逐最近最少使用节点
-            evictLeastRecent();
+            evictLeastRecent(CacheProbe::EvictReason::Adapt);
         }
         -- capacity_;
         return true;
     }
 
 private:
+    std::atomic<uint64_t>* contendedCounter() const
+    {
+        return stats_ ? &stats_->lockContended : nullptr;
+    }
+
+    // 节点连同shared_ptr控制块一起从resource分配
+    template<typename... Args>
+    NodePtr makeNode(Args&&... args)
+    {
+        return std::allocate_shared<NodeType>(nodeAllocator_, std::forward<Args>(args)...);
+    }
+
     // 初始化主链表和幽灵链表的头节点和尾节点
     void initializeLists()
     {
-        mainHead_ = std::make_shared<NodeType>();
-        mainTail_ = std::make_shared<NodeType>();
+        mainHead_ = makeNode();
+        mainTail_ = makeNode();
         mainHead_->next_ = mainTail_;
         mainTail_->prev_ = mainHead_;
 
-        ghostHead_ = std::make_shared<NodeType>();
-        ghostTail_ = std::make_shared<NodeType>();
+        ghostHead_ = makeNode();
+        ghostTail_ = makeNode();
         ghostHead_->next_ = ghostTail_;
         ghostTail_->prev_ = ghostHead_;
     }
@@ -101,8 +161,8 @@ private:
     //  将节点移动到链表头部，以此表明它是最近被使用的
     bool updateExistingNode(NodePtr node, const Value& value)
     {
-        node->setValue(value);
-        moveToFront(node);
+        XRMS_CACHE_PHASE(ValueCopy, node->setValue(value));
+        XRMS_CACHE_PHASE(Promote, moveToFront(node));
         return true;
     }
 
@@ -112,13 +172,18 @@ private:
         if (mainCache_.size() >= capacity_)
         {
             // 主缓存满了 驱逐最近最少使用节点
-            evictLeastRecent();
+            evictLeastRecent(CacheProbe::EvictReason::Capacity);
         }
 
-        NodePtr newNode = std::make_shared<NodeType>(key, value);
-        mainCache_[key] = newNode;
+        XRMS_CACHE_PROBE_KEY(insert, this, key);
+        if (stats_)
+        {
+            CacheStats::bump(stats_->inserts);
+        }
+        NodePtr newNode = XRMS_CACHE_PHASE(Alloc, makeNode(key, value));
+        XRMS_CACHE_PHASE(IndexInsert, mainCache_.insertOrAssign(key, newNode));
         // 将新节点添加到主链表的头部
-        addToFront(newNode);
+        XRMS_CACHE_PHASE(Promote, addToFront(newNode));
         return true;
     }
 
@@ -152,15 +217,20 @@ private:
 
     // 驱逐主链表中最近最少使用的节点
     // 并移动到幽灵链表中
-    void evictLeastRecent()
+    void evictLeastRecent(CacheProbe::EvictReason reason)
     {
         // 最近最少使用的节点在主链表的末尾
         NodePtr leastRecent = mainTail_->prev_;
         if (leastRecent == mainHead_) // 主链表为空
             return;
+        XRMS_CACHE_PROBE_EVICT(this, leastRecent->getKey(), reason);
+        if (stats_)
+        {
+            CacheStats::bump(stats_->evictions);
+        }
         
         // 从主链表中移除
-        removeFromMain(leastRecent);
+        XRMS_CACHE_PHASE(Victim, removeFromMain(leastRecent));
 
         // 添加到幽灵缓存
         if (ghostCache_.size() >= ghostCapacity_) // 判断幽灵缓存是否已满
@@ -170,7 +240,7 @@ private:
         addToGhost(leastRecent);
 
         // 从主缓存映射中移除
-        mainCache_.erase(leastRecent->getKey());
+        XRMS_CACHE_PHASE(IndexErase, mainCache_.erase(leastRecent->getKey()));
     }
 
     // 从主链表中移除节点
@@ -200,7 +270,7 @@ private:
         ghostHead_->next_ = node;
 
         // 添加到幽灵缓存映射
-        ghostCache_[node->getKey()] = node;
+        XRMS_CACHE_PHASE(IndexInsert, ghostCache_.insertOrAssign(node->getKey(), node));
     }
 
     // 移除幽灵链表中最旧的节点 也就是最末的节点
@@ -211,7 +281,7 @@ private:
             return; // 幽灵链表为空
         
         removeFromGhost(oldestGhost);
-        ghostCache_.erase(oldestGhost->getKey());
+        XRMS_CACHE_PHASE(IndexErase, ghostCache_.erase(oldestGhost->getKey()));
     }
 
 private:
@@ -219,9 +289,13 @@ private:
     size_t ghostCapacity_;      // 幽灵缓存的容量
     size_t transformThreshold_; // 转换门槛值
     std::mutex mutex_;          // 互斥锁
+    CacheMemory::CountingResource nodeMemory_;  // 节点的内存来源，统计节点占用；须在持有节点的成员之前声明
 
     NodeMap mainCache_;     // 主缓存映射，用于快速查找主缓存中的节点
     NodeMap ghostCache_;    // 幽灵缓存映射，用于快速查找幽灵缓存中的节点
+    std::pmr::polymorphic_allocator<NodeType> nodeAllocator_;  // 经nodeMemory_分配节点
+    CacheWeigher<Key, Value> weigher_;  // 统计values的权重函数，为空时用默认估计
+    CacheStats* stats_ = nullptr;       // 运行指标，由ArcCache持有
 
     // 主链表的头尾节点 
     NodePtr mainHead_;
@@ -0,0 +1,335 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// 缓存背后的持久化存储
+namespace XrmsCache
+{
+
+/*
+ * BackingStore 缓存的后端存储接口
+ * 写回模式下缓存只在淘汰或定期刷新时调用write/writeBatch；读穿透时未命中调用read/readBatch；
+ * 读写都返回bool，false表示读不到或写失败，缓存据此决定是否保留脏数据稍后重试。
+ * 接口没有删除操作：缓存的remove只丢弃尚未写出的修改，存储中已写入的值不受影响。
+ * 实现需自行保证线程安全，多个分片可能同时调用。
+ */
+template<typename Key, typename Value>
+class BackingStore
+{
+public:
+    virtual ~BackingStore() = default;
+
+    virtual bool read(const Key& key, Value& value) = 0;
+    virtual bool write(const Key& key, const Value& value) = 0;
+
+    // 批量读取：values与keys一一对应，读不到的为空；整批失败时返回false
+    // 默认逐条读；能把一批合并成一次请求的存储应重写它
+    virtual bool readBatch(const std::vector<Key>& keys, std::vector<std::optional<Value>>& values)
+    {
+        values.assign(keys.size(), std::nullopt);
+        Value value;
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            if (read(keys[i], value))
+            {
+                values[i] = std::move(value);
+            }
+        }
+        return true;
+    }
+
+    // 批量写入，默认逐条写；能把一批合并成一次IO的存储应重写它
+    virtual bool writeBatch(const std::vector<std::pair<Key, Value>>& entries)
+    {
+        for (const auto& entry : entries)
+        {
+            if (!write(entry.first, entry.second))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+// 文件存储使用的序列化：std::string按原始字节，其余类型要求可平凡拷贝
+template<typename T, typename = void>
+struct StoreCodec
+{
+    static_assert(std::is_trivially_copyable<T>::value, "StoreCodec requires std::string or a trivially copyable type");
+
+    static void encode(const T& value, std::string& out)
+    {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    static bool decode(const char* data, size_t size, T& value)
+    {
+        if (size != sizeof(T))
+        {
+            return false;
+        }
+        std::memcpy(&value, data, sizeof(T));
+        return true;
+    }
+};
+
+template<>
+struct StoreCodec<std::string>
+{
+    static void encode(const std::string& value, std::string& out) { out.append(value); }
+
+    static bool decode(const char* data, size_t size, std::string& value)
+    {
+        value.assign(data, size);
+        return true;
+    }
+};
+
+/*
+ * FileBackingStore 基于单个追加写日志文件的简单存储，用作测试和示例的后端
+ * 每条记录为 [key长度 u32][value长度 u32][key][value]，同一key以最后一条为准；
+ * 内存中维护key到记录位置的索引，打开已有文件时扫描一遍重建索引（末尾残缺的记录被忽略）。
+ * writeBatch把整批记录拼成一块缓冲区，用一次write追加到文件末尾。
+ */
+template<typename Key, typename Value>
+class FileBackingStore : public BackingStore<Key, Value>
+{
+public:
+    explicit FileBackingStore(const std::string& path)
+        : path_(path)
+    {
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd_ < 0)
+        {
+            throw std::runtime_error("FileBackingStore: open " + path + ": " + std::strerror(errno));
+        }
+        loadIndex();
+    }
+
+    ~FileBackingStore() override
+    {
+        ::close(fd_);
+    }
+
+    FileBackingStore(const FileBackingStore&) = delete;
+    FileBackingStore& operator=(const FileBackingStore&) = delete;
+
+    bool read(const Key& key, Value& value) override
+    {
+        Location location;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = index_.find(key);
+            if (it == index_.end())
+            {
+                return false;
+            }
+            location = it->second;
+        }
+        std::string buffer(location.size, '\0');
+        if (!readFully(&buffer[0], location.size, location.offset))
+        {
+            return false;
+        }
+        readCalls_.fetch_add(1, std::memory_order_relaxed);
+        return StoreCodec<Value>::decode(buffer.data(), buffer.size(), value);
+    }
+
+    // 一次加锁查出整批记录的位置，再按文件偏移顺序读取
+    bool readBatch(const std::vector<Key>& keys, std::vector<std::optional<Value>>& values) override
+    {
+        values.assign(keys.size(), std::nullopt);
+        std::vector<std::pair<Location, size_t>> locations;   // (位置, 在keys中的下标)
+        locations.reserve(keys.size());
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (size_t i = 0; i < keys.size(); ++i)
+            {
+                auto it = index_.find(keys[i]);
+                if (it != index_.end())
+                {
+                    locations.emplace_back(it->second, i);
+                }
+            }
+        }
+        std::sort(locations.begin(), locations.end(),
+                  [](const auto& a, const auto& b) { return a.first.offset < b.first.offset; });
+        readBatchCalls_.fetch_add(1, std::memory_order_relaxed);
+
+        std::string buffer;
+        Value value;
+        for (const auto& location : locations)
+        {
+            buffer.resize(location.first.size);
+            if (!readFully(&buffer[0], buffer.size(), location.first.offset))
+            {
+                return false;
+            }
+            if (StoreCodec<Value>::decode(buffer.data(), buffer.size(), value))
+            {
+                values[location.second] = std::move(value);
+            }
+        }
+        return true;
+    }
+
+    bool write(const Key& key, const Value& value) override
+    {
+        return writeBatch({ {key, value} });
+    }
+
+    bool writeBatch(const std::vector<std::pair<Key, Value>>& entries) override
+    {
+        if (entries.empty())
+        {
+            return true;
+        }
+        std::string buffer;
+        std::vector<std::pair<size_t, uint32_t>> valueAt;   // 每条记录value在buffer中的位置和长度
+        valueAt.reserve(entries.size());
+        for (const auto& entry : entries)
+        {
+            size_t header = buffer.size();
+            buffer.append(2 * sizeof(uint32_t), '\0');
+            StoreCodec<Key>::encode(entry.first, buffer);
+            size_t valueBegin = buffer.size();
+            StoreCodec<Value>::encode(entry.second, buffer);
+            uint32_t keySize = static_cast<uint32_t>(valueBegin - header - 2 * sizeof(uint32_t));
+            uint32_t valueSize = static_cast<uint32_t>(buffer.size() - valueBegin);
+            std::memcpy(&buffer[header], &keySize, sizeof(keySize));
+            std::memcpy(&buffer[header + sizeof(keySize)], &valueSize, sizeof(valueSize));
+            valueAt.emplace_back(valueBegin, valueSize);
+        }
+
+        // 追加位置和索引更新在同一把锁内完成，保证索引与文件内容一致
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!writeFully(buffer.data(), buffer.size(), fileSize_))
+        {
+            return false;
+        }
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            index_[entries[i].first] = Location{fileSize_ + valueAt[i].first, valueAt[i].second};
+        }
+        fileSize_ += buffer.size();
+        writeCalls_.fetch_add(1, std::memory_order_relaxed);
+        recordsWritten_.fetch_add(entries.size(), std::memory_order_relaxed);
+        return true;
+    }
+
+    size_t size()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return index_.size();
+    }
+
+    uint64_t readCalls() const { return readCalls_.load(std::memory_order_relaxed); }
+    uint64_t readBatchCalls() const { return readBatchCalls_.load(std::memory_order_relaxed); }
+    uint64_t writeCalls() const { return writeCalls_.load(std::memory_order_relaxed); }
+    uint64_t recordsWritten() const { return recordsWritten_.load(std::memory_order_relaxed); }
+
+private:
+    struct Location
+    {
+        uint64_t offset = 0;    // value在文件中的偏移
+        uint32_t size = 0;
+    };
+
+    bool readFully(char* data, size_t size, uint64_t offset)
+    {
+        while (size > 0)
+        {
+            ssize_t n = ::pread(fd_, data, size, static_cast<off_t>(offset));
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            data += n;
+            size -= static_cast<size_t>(n);
+            offset += static_cast<uint64_t>(n);
+        }
+        return true;
+    }
+
+    bool writeFully(const char* data, size_t size, uint64_t offset)
+    {
+        while (size > 0)
+        {
+            ssize_t n = ::pwrite(fd_, data, size, static_cast<off_t>(offset));
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            data += n;
+            size -= static_cast<size_t>(n);
+            offset += static_cast<uint64_t>(n);
+        }
+        return true;
+    }
+
+    void loadIndex()
+    {
+        struct stat st;
+        if (::fstat(fd_, &st) != 0)
+        {
+            throw std::runtime_error("FileBackingStore: stat " + path_ + ": " + std::strerror(errno));
+        }
+        uint64_t end = static_cast<uint64_t>(st.st_size);
+        uint64_t offset = 0;
+        std::string keyBuffer;
+        while (offset + 2 * sizeof(uint32_t) <= end)
+        {
+            uint32_t sizes[2];
+            if (!readFully(reinterpret_cast<char*>(sizes), sizeof(sizes), offset))
+            {
+                break;
+            }
+            uint64_t valueOffset = offset + sizeof(sizes) + sizes[0];
+            if (valueOffset + sizes[1] > end)
+            {
+                break;
+            }
+            keyBuffer.resize(sizes[0]);
+            Key key{};
+            if (!readFully(&keyBuffer[0], sizes[0], offset + sizeof(sizes))
+                || !StoreCodec<Key>::decode(keyBuffer.data(), keyBuffer.size(), key))
+            {
+                break;
+            }
+            index_[key] = Location{valueOffset, sizes[1]};
+            offset = valueOffset + sizes[1];
+        }
+        // 残缺的尾部记录之后的内容会被新记录覆盖
+        fileSize_ = offset;
+    }
+
+private:
+    std::string path_;
+    int         fd_ = -1;
+    std::mutex  mutex_;                             // 保护index_和fileSize_
+    std::unordered_map<Key, Location> index_;       // key -> 最新记录中value的位置
+    uint64_t    fileSize_ = 0;                      // 下一条记录的写入位置
+    std::atomic<uint64_t> readCalls_{0};
+    std::atomic<uint64_t> readBatchCalls_{0};
+    std::atomic<uint64_t> writeCalls_{0};
+    std::atomic<uint64_t> recordsWritten_{0};
+};
+
+} // namespace XrmsCache
@@ -0,0 +1,456 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 文件块缓存：用缓存策略在用户态缓存大文件的数据块
+namespace XrmsCache
+{
+
+// 缓存的key：文件编号 + 块号
+struct BlockKey
+{
+    uint32_t fileId = 0;
+    uint64_t blockNo = 0;
+
+    bool operator==(const BlockKey& other) const
+    {
+        return fileId == other.fileId && blockNo == other.blockNo;
+    }
+};
+
+// 缓存的值：指向块数据的引用，拷贝只增加引用计数，不拷贝数据
+// 一次合并读取的多个块共用同一块缓冲区（shared_ptr别名构造），最后一个引用释放时缓冲区才释放
+struct BlockRef
+{
+    std::shared_ptr<const char> data;
+    uint32_t size = 0;      // 块内有效字节数，文件最后一块可能不满
+
+    explicit operator bool() const { return data != nullptr; }
+};
+
+} // namespace XrmsCache
+
+namespace std
+{
+template<>
+struct hash<XrmsCache::BlockKey>
+{
+    size_t operator()(const XrmsCache::BlockKey& key) const
+    {
+        uint64_t h = (static_cast<uint64_t>(key.fileId) << 40) ^ key.blockNo;
+        h *= 0x9e3779b97f4a7c15ull;
+        return static_cast<size_t>(h ^ (h >> 29));
+    }
+};
+} // namespace std
+
+namespace XrmsCache
+{
+
+/*
+ * BlockCache 以(fileId, blockNo)为key、BlockRef为值，在任意缓存策略之上实现的用户态页缓存
+ * Cache 可以是 HashLruCaches<BlockKey, BlockRef>、ArcCache<BlockKey, BlockRef> 等，
+ * 只要求提供 get(key, value&) 和 put(key, value)，且自身线程安全。
+ *
+ * - pread: 与::pread语义相同，数据拷贝到调用方缓冲区
+ * - readBlocks / getBlock: 零拷贝，返回块引用，调用方持有期间块数据不会被释放
+ * - 一次请求中相邻的未命中块合并成一次::pread（最多maxCoalesceBlocks块）
+ * - 检测到顺序访问后由后台线程异步预读后面的readaheadBlocks块，readaheadBlocks为0时关闭预读
+ *
+ * 同一缓冲区中的块全部被淘汰后内存才归还，因此实际占用可能比容量多出最多一次合并读取的大小。
+ */
+template<typename Cache>
+class BlockCache
+{
+public:
+    struct Stats
+    {
+        uint64_t hits = 0;              // 请求命中的块数
+        uint64_t misses = 0;            // 请求未命中、同步读取的块数
+        uint64_t readCalls = 0;         // 发出的::pread次数（含预读）
+        uint64_t readaheadBlocks = 0;   // 预读读入的块数
+    };
+
+    BlockCache(Cache& cache, size_t blockSize = 4096, size_t readaheadBlocks = 32, size_t maxCoalesceBlocks = 32)
+        : cache_(cache)
+        , blockSize_(std::max<size_t>(blockSize, 1))
+        , readaheadBlocks_(readaheadBlocks)
+        , maxCoalesceBlocks_(std::max<size_t>(maxCoalesceBlocks, 1))
+    {
+        if (readaheadBlocks_ > 0)
+        {
+            readaheadThread_ = std::thread([this]() { readaheadLoop(); });
+        }
+    }
+
+    ~BlockCache()
+    {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex_);
+            stop_ = true;
+        }
+        queueCond_.notify_all();
+        if (readaheadThread_.joinable())
+        {
+            readaheadThread_.join();
+        }
+        for (auto& file : files_)
+        {
+            ::close(file->fd);
+        }
+    }
+
+    BlockCache(const BlockCache&) = delete;
+    BlockCache& operator=(const BlockCache&) = delete;
+
+    // 只读打开文件并返回文件编号，失败返回-1并设置errno
+    // 文件在BlockCache析构时关闭；文件内容在缓存期间不应被修改
+    int openFile(const std::string& path)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            return -1;
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0)
+        {
+            int err = errno;
+            ::close(fd);
+            errno = err;
+            return -1;
+        }
+        auto file = std::make_unique<FileState>();
+        file->fd = fd;
+        file->size = static_cast<uint64_t>(st.st_size);
+
+        std::lock_guard<std::mutex> lock(filesMutex_);
+        files_.push_back(std::move(file));
+        return static_cast<int>(files_.size() - 1);
+    }
+
+    size_t blockSize() const { return blockSize_; }
+
+    // 与::pread相同：返回读到的字节数，到达文件末尾返回0，出错返回-1并设置errno
+    ssize_t pread(int fileId, void* buf, size_t count, uint64_t offset)
+    {
+        std::vector<BlockRef> blocks;
+        ssize_t length = readBlocks(fileId, offset, count, blocks);
+        if (length <= 0)
+        {
+            return length;
+        }
+        char* out = static_cast<char*>(buf);
+        size_t skip = offset % blockSize_;
+        size_t remaining = static_cast<size_t>(length);
+        for (const BlockRef& block : blocks)
+        {
+            size_t n = std::min<size_t>(block.size - skip, remaining);
+            std::memcpy(out, block.data.get() + skip, n);
+            out += n;
+            remaining -= n;
+            skip = 0;
+        }
+        return length;
+    }
+
+    // 零拷贝读取：把覆盖[offset, offset + count)的块按顺序放入blocks，第一块从offset % blockSize()处开始有效
+    // 返回范围内的有效字节数（受文件大小截断），出错返回-1并设置errno
+    ssize_t readBlocks(int fileId, uint64_t offset, size_t count, std::vector<BlockRef>& blocks)
+    {
+        blocks.clear();
+        FileState* file = fileAt(fileId);
+        if (!file)
+        {
+            errno = EBADF;
+            return -1;
+        }
+        if (count == 0 || offset >= file->size)
+        {
+            return 0;
+        }
+        count = static_cast<size_t>(std::min<uint64_t>(count, file->size - offset));
+        uint64_t first = offset / blockSize_;
+        uint64_t last = (offset + count - 1) / blockSize_;
+        blocks.resize(static_cast<size_t>(last - first + 1));
+
+        uint64_t hits = 0;
+        for (uint64_t blockNo = first; blockNo <= last; ++blockNo)
+        {
+            if (cache_.get(BlockKey{static_cast<uint32_t>(fileId), blockNo}, blocks[blockNo - first])
+                && blocks[blockNo - first])
+            {
+                ++hits;
+            }
+        }
+        hits_.fetch_add(hits, std::memory_order_relaxed);
+        misses_.fetch_add(last - first + 1 - hits, std::memory_order_relaxed);
+
+        // 相邻的未命中块合并成一次读取
+        for (uint64_t blockNo = first; blockNo <= last; )
+        {
+            if (blocks[blockNo - first])
+            {
+                ++blockNo;
+                continue;
+            }
+            uint64_t runEnd = blockNo + 1;
+            while (runEnd <= last && !blocks[runEnd - first] && runEnd - blockNo < maxCoalesceBlocks_)
+            {
+                ++runEnd;
+            }
+            if (!fetchRun(static_cast<uint32_t>(fileId), *file, blockNo, runEnd - blockNo, &blocks[blockNo - first]))
+            {
+                blocks.clear();
+                return -1;
+            }
+            blockNo = runEnd;
+        }
+
+        onAccess(static_cast<uint32_t>(fileId), *file, first, last);
+        return static_cast<ssize_t>(count);
+    }
+
+    // 零拷贝读取单个块，块号超出文件范围或读取失败时返回空引用
+    BlockRef getBlock(int fileId, uint64_t blockNo)
+    {
+        std::vector<BlockRef> blocks;
+        if (readBlocks(fileId, blockNo * blockSize_, blockSize_, blocks) <= 0)
+        {
+            return BlockRef();
+        }
+        return blocks.front();
+    }
+
+    // 等待已提交的预读全部完成
+    void waitReadahead()
+    {
+        std::unique_lock<std::mutex> lock(queueMutex_);
+        idleCond_.wait(lock, [this]() { return queue_.empty() && !busy_; });
+    }
+
+    Stats stats() const
+    {
+        Stats s;
+        s.hits = hits_.load(std::memory_order_relaxed);
+        s.misses = misses_.load(std::memory_order_relaxed);
+        s.readCalls = readCalls_.load(std::memory_order_relaxed);
+        s.readaheadBlocks = readaheadBlocksRead_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    // 连续访问达到这么多块后认为是顺序读
+    static constexpr uint64_t kSequentialThreshold = 4;
+
+    struct FileState
+    {
+        int      fd = -1;
+        uint64_t size = 0;
+
+        std::mutex mutex;           // 保护下面的顺序访问检测状态
+        uint64_t nextBlock = 0;     // 上次访问的下一块
+        uint64_t sequentialRun = 0; // 连续顺序访问的块数
+        uint64_t readaheadEnd = 0;  // 已提交预读的结束块号（不含）
+    };
+
+    struct ReadaheadTask
+    {
+        uint32_t   fileId;
+        FileState* file;
+        uint64_t   first;
+        uint64_t   count;
+    };
+
+    FileState* fileAt(int fileId)
+    {
+        std::lock_guard<std::mutex> lock(filesMutex_);
+        if (fileId < 0 || static_cast<size_t>(fileId) >= files_.size())
+        {
+            return nullptr;
+        }
+        return files_[fileId].get();
+    }
+
+    uint64_t blockCount(const FileState& file) const
+    {
+        return (file.size + blockSize_ - 1) / blockSize_;
+    }
+
+    // 用一次::pread读入[first, first + count)这些块，切分成块引用后写入缓存并放入out
+    bool fetchRun(uint32_t fileId, FileState& file, uint64_t first, uint64_t count, BlockRef* out)
+    {
+        uint64_t begin = first * blockSize_;
+        size_t length = static_cast<size_t>(std::min<uint64_t>(count * blockSize_, file.size - begin));
+        std::shared_ptr<char> buffer(new char[length], std::default_delete<char[]>());
+
+        size_t done = 0;
+        while (done < length)
+        {
+            ssize_t n = ::pread(file.fd, buffer.get() + done, length - done, static_cast<off_t>(begin + done));
+            readCalls_.fetch_add(1, std::memory_order_relaxed);
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                return false;
+            }
+            if (n == 0)
+            {
+                // 文件被截断，按未读到的部分为0处理
+                std::memset(buffer.get() + done, 0, length - done);
+                break;
+            }
+            done += static_cast<size_t>(n);
+        }
+
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            size_t blockBegin = static_cast<size_t>(i * blockSize_);
+            BlockRef block;
+            block.data = std::shared_ptr<const char>(buffer, buffer.get() + blockBegin);
+            block.size = static_cast<uint32_t>(std::min<size_t>(blockSize_, length - blockBegin));
+            cache_.put(BlockKey{fileId, first + i}, block);
+            if (out)
+            {
+                out[i] = std::move(block);
+            }
+        }
+        return true;
+    }
+
+    // 顺序访问检测：连续访问足够多块后，在剩余预读量不足一半窗口时提交下一窗口的异步预读
+    void onAccess(uint32_t fileId, FileState& file, uint64_t first, uint64_t last)
+    {
+        if (readaheadBlocks_ == 0)
+        {
+            return;
+        }
+        ReadaheadTask task{fileId, &file, 0, 0};
+        {
+            std::lock_guard<std::mutex> lock(file.mutex);
+            if (first <= file.nextBlock && last + 1 >= file.nextBlock && file.nextBlock > 0)
+            {
+                file.sequentialRun += last + 1 - file.nextBlock;
+            }
+            else
+            {
+                file.sequentialRun = last + 1 - first;
+                file.readaheadEnd = 0;
+            }
+            file.nextBlock = last + 1;
+
+            if (file.sequentialRun < kSequentialThreshold)
+            {
+                return;
+            }
+            file.readaheadEnd = std::max(file.readaheadEnd, file.nextBlock);
+            uint64_t end = blockCount(file);
+            if (file.readaheadEnd >= end || file.readaheadEnd - file.nextBlock >= readaheadBlocks_ / 2)
+            {
+                return;
+            }
+            task.first = file.readaheadEnd;
+            task.count = std::min<uint64_t>(readaheadBlocks_, end - task.first);
+            file.readaheadEnd += task.count;
+        }
+        {
+            std::lock_guard<std::mutex> lock(queueMutex_);
+            queue_.push_back(task);
+        }
+        queueCond_.notify_one();
+    }
+
+    void readaheadLoop()
+    {
+        std::unique_lock<std::mutex> lock(queueMutex_);
+        while (true)
+        {
+            queueCond_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+            if (stop_)
+            {
+                return;
+            }
+            ReadaheadTask task = queue_.front();
+            queue_.pop_front();
+            busy_ = true;
+            lock.unlock();
+
+            runReadahead(task);
+
+            lock.lock();
+            busy_ = false;
+            if (queue_.empty())
+            {
+                idleCond_.notify_all();
+            }
+        }
+    }
+
+    // 只读取窗口中尚未缓存的块，相邻的仍然合并读取
+    void runReadahead(const ReadaheadTask& task)
+    {
+        uint64_t end = task.first + task.count;
+        BlockRef existing;
+        for (uint64_t blockNo = task.first; blockNo < end; )
+        {
+            if (cache_.get(BlockKey{task.fileId, blockNo}, existing) && existing)
+            {
+                ++blockNo;
+                continue;
+            }
+            uint64_t runEnd = blockNo + 1;
+            while (runEnd < end && runEnd - blockNo < maxCoalesceBlocks_
+                   && !(cache_.get(BlockKey{task.fileId, runEnd}, existing) && existing))
+            {
+                ++runEnd;
+            }
+            if (!fetchRun(task.fileId, *task.file, blockNo, runEnd - blockNo, nullptr))
+            {
+                return;
+            }
+            readaheadBlocksRead_.fetch_add(runEnd - blockNo, std::memory_order_relaxed);
+            blockNo = runEnd;
+        }
+    }
+
+private:
+    Cache&       cache_;
+    const size_t blockSize_;
+    const size_t readaheadBlocks_;
+    const size_t maxCoalesceBlocks_;
+
+    std::mutex filesMutex_;
+    std::vector<std::unique_ptr<FileState>> files_;
+
+    std::mutex                queueMutex_;
+    std::condition_variable   queueCond_;
+    std::condition_variable   idleCond_;
+    std::deque<ReadaheadTask> queue_;
+    bool                      busy_ = false;
+    bool                      stop_ = false;
+    std::thread               readaheadThread_;
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> readCalls_{0};
+    std::atomic<uint64_t> readaheadBlocksRead_{0};
+};
+
+} // namespace XrmsCache
@@ -0,0 +1,408 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "CacheMemory.h"
+
+namespace XrmsCache
+{
+
+/*
+ * 后台释放线程登记
+ * releaseInBackground启动的分离线程在缓存析构之后仍可能运行，它们归还内存时用到的resource
+ * 必须存活到线程结束。waitBackgroundRelease()阻塞到当前所有后台释放完成，
+ * 在销毁传给缓存的resource之前、或需要确认内存已经归还（如进程退出前）时调用。
+ */
+namespace BackgroundRelease
+{
+
+struct Registry
+{
+    std::mutex              mutex;
+    std::condition_variable idle;
+    size_t                  running = 0;
+};
+
+// 有意不析构：进程退出时仍在运行的释放线程也能安全地登记结束
+inline Registry& registry()
+{
+    static Registry* instance = new Registry;
+    return *instance;
+}
+
+template<typename F>
+void start(F&& task)
+{
+    Registry& reg = registry();
+    {
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        ++reg.running;
+    }
+    try
+    {
+        std::thread([fn = std::forward<F>(task)]() mutable {
+            fn();
+            Registry& reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            if (--reg.running == 0)
+            {
+                reg.idle.notify_all();
+            }
+        }).detach();
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        --reg.running;
+        throw;
+    }
+}
+
+} // namespace BackgroundRelease
+
+// 等待所有已启动的后台释放线程结束
+inline void waitBackgroundRelease()
+{
+    BackgroundRelease::Registry& reg = BackgroundRelease::registry();
+    std::unique_lock<std::mutex> lock(reg.mutex);
+    reg.idle.wait(lock, [&reg] { return reg.running == 0; });
+}
+
+/*
+ * NodeArena 节点内存池
+ * 按块批量申请节点内存，被淘汰的节点放入空闲链表复用；
+ * 清空或析构缓存时整块归还内存，不再逐个节点释放。
+ * 内存池本身不记录哪些槽位存活，存活对象的析构由持有链表的缓存负责，
+ * 对平凡析构的Key/Value可以完全跳过逐个析构。
+ * 内存块来自resource（为空时用malloc），见CacheMemory。
+ */
+template<typename T>
+class NodeArena
+{
+public:
+    explicit NodeArena(size_t maxChunkSize = 65536, std::pmr::memory_resource* resource = nullptr)
+        : maxChunkSize_(std::max<size_t>(maxChunkSize, 1))
+        , nextChunkSize_(std::min<size_t>(16, maxChunkSize_))
+        , resource_(resource)
+    {}
+
+    ~NodeArena() { release(); }
+
+    NodeArena(const NodeArena&) = delete;
+    NodeArena& operator=(const NodeArena&) = delete;
+
+    // 在池中构造一个对象：优先复用空闲槽位，其次从当前块中顺序切分
+    template<typename... Args>
+    T* create(Args&&... args)
+    {
+        Slot* slot = freeList_;
+        if (slot)
+        {
+            freeList_ = slot->next;
+        }
+        else
+        {
+            if (cursor_ == chunkEnd_)
+            {
+                allocateChunk(nextChunkSize_);
+                nextChunkSize_ = std::min(nextChunkSize_ * 2, maxChunkSize_);
+            }
+            slot = cursor_++;
+        }
+        return ::new (static_cast<void*>(slot->storage)) T(std::forward<Args>(args)...);
+    }
+
+    // 析构对象并把槽位放回空闲链表
+    void destroy(T* obj)
+    {
+        obj->~T();
+        Slot* slot = reinterpret_cast<Slot*>(obj);
+        slot->next = freeList_;
+        freeList_ = slot;
+    }
+
+    // 保证接下来的n次create不再申请内存，且新节点在一整块连续内存上（批量加载使用）
+    void reserve(size_t n)
+    {
+        size_t remaining = static_cast<size_t>(chunkEnd_ - cursor_);
+        if (remaining < n)
+        {
+            allocateChunk(n);
+        }
+    }
+
+    // 整块归还全部内存，不调用析构：存活对象须已由调用者析构，或本身为平凡析构类型
+    void release()
+    {
+        freeChunks(chunks_, resource_);
+        resetCursor();
+    }
+
+    // 把全部内存块交给后台分离线程：先执行destroyLive析构存活对象，再整块释放
+    // 调用方立即返回，池恢复为空，可以继续使用；用waitBackgroundRelease()等待释放完成
+    template<typename F>
+    void releaseInBackground(F&& destroyLive)
+    {
+        if (chunks_.empty())
+        {
+            destroyLive();
+            return;
+        }
+        BackgroundRelease::start([chunks = std::move(chunks_), resource = resource_, fn = std::forward<F>(destroyLive)]() mutable {
+            fn();
+            freeChunks(chunks, resource);
+        });
+        chunks_.clear();
+        resetCursor();
+    }
+
+    // 已申请的内存块字节数，含尚未切分和空闲链表中的槽位
+    size_t memoryBytes() const
+    {
+        size_t bytes = 0;
+        for (const Chunk& chunk : chunks_)
+        {
+            bytes += chunk.count * sizeof(Slot);
+        }
+        return bytes;
+    }
+
+private:
+    union Slot
+    {
+        Slot* next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    struct Chunk
+    {
+        Slot*  slots;
+        size_t count;
+    };
+
+    void allocateChunk(size_t n)
+    {
+        Slot* slots = static_cast<Slot*>(CacheMemory::allocate(resource_, n * sizeof(Slot), alignof(Slot)));
+        chunks_.push_back(Chunk{slots, n});
+        cursor_ = slots;
+        chunkEnd_ = cursor_ + n;
+    }
+
+    static void freeChunks(std::vector<Chunk>& chunks, std::pmr::memory_resource* resource)
+    {
+        for (const Chunk& chunk : chunks)
+        {
+            CacheMemory::deallocate(resource, chunk.slots, chunk.count * sizeof(Slot), alignof(Slot));
+        }
+        chunks.clear();
+    }
+
+    void resetCursor()
+    {
+        cursor_ = nullptr;
+        chunkEnd_ = nullptr;
+        freeList_ = nullptr;
+        nextChunkSize_ = std::min<size_t>(16, maxChunkSize_);
+    }
+
+private:
+    size_t  maxChunkSize_;          // 单个内存块最多容纳的节点数
+    size_t  nextChunkSize_;         // 下一次申请的块大小，从16开始倍增到上限
+    Slot*   cursor_ = nullptr;      // 当前块中下一个未使用的槽位
+    Slot*   chunkEnd_ = nullptr;    // 当前块的末尾
+    Slot*   freeList_ = nullptr;    // 空闲槽位链表
+    std::vector<Chunk> chunks_;     // 已申请的全部内存块
+    std::pmr::memory_resource* resource_;   // 内存块来源，为空时用malloc
+};
+
+/*
+ * SplitNodeArena 冷热分离的节点内存池
+ * 每块内存分为两个并行数组：Hot数组存链表指针、哈希值等每次操作都要访问的元数据，
+ * Cold数组存key、value等只在命中和写入时才访问的数据，同一槽位的Hot和Cold一一对应。
+ * 淘汰和链表调整只需访问Hot数组，一条缓存行能容纳更多节点；Cold平凡析构时，回收槽位也不会写Cold。
+ * Hot须以(Cold*, hotArgs...)构造，自行保存冷数据的地址。内存块来自resource（为空时用malloc）。
+ */
+template<typename Hot, typename Cold>
+class SplitNodeArena
+{
+public:
+    explicit SplitNodeArena(size_t maxChunkSize = 65536, std::pmr::memory_resource* resource = nullptr)
+        : maxChunkSize_(std::max<size_t>(maxChunkSize, 1))
+        , nextChunkSize_(std::min<size_t>(16, maxChunkSize_))
+        , resource_(resource)
+    {}
+
+    ~SplitNodeArena() { release(); }
+
+    SplitNodeArena(const SplitNodeArena&) = delete;
+    SplitNodeArena& operator=(const SplitNodeArena&) = delete;
+
+    // 冷数据由coldArgs中的参数构造（与std::piecewise_construct类似），热节点由(冷数据地址, hotArgs...)构造
+    template<typename... ColdArgs, typename... HotArgs>
+    Hot* create(std::tuple<ColdArgs...> coldArgs, HotArgs&&... hotArgs)
+    {
+        Slot* slot = freeList_;
+        ColdSlot* coldSlot;
+        if (slot)
+        {
+            freeList_ = slot->free.next;
+            coldSlot = slot->free.cold;
+        }
+        else
+        {
+            if (cursor_ == chunkEnd_)
+            {
+                allocateChunk(nextChunkSize_);
+                nextChunkSize_ = std::min(nextChunkSize_ * 2, maxChunkSize_);
+            }
+            slot = cursor_++;
+            coldSlot = coldCursor_++;
+        }
+        Cold* cold = std::apply([coldSlot](auto&&... args) {
+            return ::new (static_cast<void*>(coldSlot->storage)) Cold(std::forward<decltype(args)>(args)...);
+        }, std::move(coldArgs));
+        return ::new (static_cast<void*>(slot->storage)) Hot(cold, std::forward<HotArgs>(hotArgs)...);
+    }
+
+    // 析构同一槽位上的热节点和冷数据，槽位放回空闲链表，空闲链表只写在Hot数组中
+    void destroy(Hot* hot, Cold* cold)
+    {
+        cold->~Cold();
+        hot->~Hot();
+        Slot* slot = reinterpret_cast<Slot*>(hot);
+        slot->free.next = freeList_;
+        slot->free.cold = reinterpret_cast<ColdSlot*>(cold);
+        freeList_ = slot;
+    }
+
+    // 保证接下来的n次create不再申请内存（批量加载使用）
+    void reserve(size_t n)
+    {
+        size_t remaining = static_cast<size_t>(chunkEnd_ - cursor_);
+        if (remaining < n)
+        {
+            allocateChunk(n);
+        }
+    }
+
+    // 整块归还全部内存，不调用析构：存活对象须已由调用者析构，或本身为平凡析构类型
+    void release()
+    {
+        freeChunks(chunks_, resource_);
+        resetCursor();
+    }
+
+    // 把全部内存块交给后台分离线程：先执行destroyLive析构存活对象，再整块释放
+    template<typename F>
+    void releaseInBackground(F&& destroyLive)
+    {
+        if (chunks_.empty())
+        {
+            destroyLive();
+            return;
+        }
+        BackgroundRelease::start([chunks = std::move(chunks_), resource = resource_, fn = std::forward<F>(destroyLive)]() mutable {
+            fn();
+            freeChunks(chunks, resource);
+        });
+        chunks_.clear();
+        resetCursor();
+    }
+
+    // 已申请的内存块字节数（Hot和Cold两个数组合计），含尚未切分和空闲链表中的槽位
+    size_t memoryBytes() const
+    {
+        size_t bytes = 0;
+        for (const Chunk& chunk : chunks_)
+        {
+            bytes += chunk.count * (sizeof(Slot) + sizeof(ColdSlot));
+        }
+        return bytes;
+    }
+
+private:
+    struct ColdSlot
+    {
+        alignas(Cold) unsigned char storage[sizeof(Cold)];
+    };
+
+    union Slot;
+
+    // 空闲槽位记下同一槽位的冷数据地址，复用时不必再查找
+    struct FreeLink
+    {
+        Slot*       next;
+        ColdSlot*   cold;
+    };
+
+    union Slot
+    {
+        FreeLink free;
+        alignas(Hot) unsigned char storage[sizeof(Hot)];
+    };
+
+    struct Chunk
+    {
+        Slot*     slots;
+        ColdSlot* cold;
+        size_t    count;
+    };
+
+    void allocateChunk(size_t n)
+    {
+        Slot* slots = static_cast<Slot*>(CacheMemory::allocate(resource_, n * sizeof(Slot), alignof(Slot)));
+        ColdSlot* cold;
+        try
+        {
+            cold = static_cast<ColdSlot*>(CacheMemory::allocate(resource_, n * sizeof(ColdSlot), alignof(ColdSlot)));
+        }
+        catch (...)
+        {
+            CacheMemory::deallocate(resource_, slots, n * sizeof(Slot), alignof(Slot));
+            throw;
+        }
+        chunks_.push_back(Chunk{slots, cold, n});
+        cursor_ = slots;
+        chunkEnd_ = cursor_ + n;
+        coldCursor_ = cold;
+    }
+
+    static void freeChunks(std::vector<Chunk>& chunks, std::pmr::memory_resource* resource)
+    {
+        for (const Chunk& chunk : chunks)
+        {
+            CacheMemory::deallocate(resource, chunk.slots, chunk.count * sizeof(Slot), alignof(Slot));
+            CacheMemory::deallocate(resource, chunk.cold, chunk.count * sizeof(ColdSlot), alignof(ColdSlot));
+        }
+        chunks.clear();
+    }
+
+    void resetCursor()
+    {
+        cursor_ = nullptr;
+        chunkEnd_ = nullptr;
+        coldCursor_ = nullptr;
+        freeList_ = nullptr;
+        nextChunkSize_ = std::min<size_t>(16, maxChunkSize_);
+    }
+
+private:
+    size_t      maxChunkSize_;          // 单个内存块最多容纳的节点数
+    size_t      nextChunkSize_;         // 下一次申请的块大小，从16开始倍增到上限
+    Slot*       cursor_ = nullptr;      // 当前块中下一个未使用的槽位
+    Slot*       chunkEnd_ = nullptr;    // 当前块的末尾
+    ColdSlot*   coldCursor_ = nullptr;  // 与cursor_同一槽位的冷数据
+    Slot*       freeList_ = nullptr;    // 空闲槽位链表
+    std::vector<Chunk> chunks_;         // 每块的Hot数组和与之一一对应的Cold数组
+    std::pmr::memory_resource* resource_;   // 内存块来源，为空时用malloc
+};
+
+} // namespace XrmsCache
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace XrmsCache
+{
+
+/*
+ * CacheBatchOp 批量操作中的一条操作
+ * 分片缓存把一批操作按分片分组，每个分片只加一次锁并按原始顺序依次执行，
+ * 同一个key的操作必然落在同一分片，因此先后顺序不会被打乱。
+ */
+template<typename Key, typename Value>
+struct CacheBatchOp
+{
+    enum class Type
+    {
+        Get,     // 读取：命中时value为读到的值
+        Put,     // 写入：value为要写入的值
+        Remove,  // 删除：命中时value为被删除的值
+        Update   // 读改写：命中时在分片锁内调用update修改value，返回false表示放弃修改
+    };
+
+    Type    type = Type::Get;
+    Key     key{};
+    Value   value{};
+    bool    found = false;  // Get/Remove/Update执行后表示是否命中（Update还要求update返回true）
+    size_t  hash = 0;       // 分片缓存路由时算出的key哈希值，分片内直接复用
+    bool    (*update)(Value& value, const void* arg) = nullptr;
+    const void* updateArg = nullptr;
+};
+
+// 对sliceNum个分片各调用一次fn(分片号)：工作线程数不超过硬件线程数，调用线程也参与，
+// 各线程依次认领尚未处理的分片，分片比线程多时不会为每个分片都起一个线程
+template<typename Fn>
+void forEachSliceParallel(size_t sliceNum, Fn fn)
+{
+    size_t workerNum = std::min<size_t>(sliceNum, std::max(1u, std::thread::hardware_concurrency()));
+    std::atomic<size_t> next{0};
+    auto work = [&next, sliceNum, &fn]() {
+        for (size_t i = next.fetch_add(1); i < sliceNum; i = next.fetch_add(1))
+        {
+            fn(i);
+        }
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(workerNum > 0 ? workerNum - 1 : 0);
+    for (size_t i = 1; i < workerNum; ++i)
+    {
+        workers.emplace_back(work);
+    }
+    work();
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+} // namespace XrmsCache
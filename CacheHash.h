@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// 缓存默认使用的哈希函数
+namespace XrmsCache
+{
+
+namespace HashDetail
+{
+
+// wyhash使用的常数
+constexpr uint64_t kSecret0 = 0xa0761d6478bd642full;
+constexpr uint64_t kSecret1 = 0xe7037ed1a0b428dbull;
+constexpr uint64_t kSecret2 = 0x8ebc6af09c88c6e3ull;
+constexpr uint64_t kSecret3 = 0x589965cc75374cc3ull;
+
+// 64x64->128位乘法后高低两半异或：一条乘法指令让每个输入位影响所有输出位
+inline uint64_t foldedMultiply(uint64_t a, uint64_t b)
+{
+    __uint128_t product = static_cast<__uint128_t>(a) * b;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+}
+
+inline uint64_t read64(const uint8_t* p)
+{
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t read32(const uint8_t* p)
+{
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// 按wyhash的结构处理字节串：<=16字节不循环，较长的每轮并行吃48字节
+inline uint64_t hashBytes(const void* data, size_t len, uint64_t seed = 0)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    seed ^= foldedMultiply(seed ^ kSecret0, kSecret1);
+    uint64_t a = 0;
+    uint64_t b = 0;
+    if (len <= 16)
+    {
+        if (len >= 4)
+        {
+            size_t mid = (len >> 3) << 2;
+            a = (read32(p) << 32) | read32(p + mid);
+            b = (read32(p + len - 4) << 32) | read32(p + len - 4 - mid);
+        }
+        else if (len > 0)
+        {
+            a = (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[len >> 1]) << 8) | p[len - 1];
+        }
+    }
+    else
+    {
+        size_t rest = len;
+        if (rest > 48)
+        {
+            uint64_t seed1 = seed;
+            uint64_t seed2 = seed;
+            do
+            {
+                seed = foldedMultiply(read64(p) ^ kSecret1, read64(p + 8) ^ seed);
+                seed1 = foldedMultiply(read64(p + 16) ^ kSecret2, read64(p + 24) ^ seed1);
+                seed2 = foldedMultiply(read64(p + 32) ^ kSecret3, read64(p + 40) ^ seed2);
+                p += 48;
+                rest -= 48;
+            } while (rest > 48);
+            seed ^= seed1 ^ seed2;
+        }
+        while (rest > 16)
+        {
+            seed = foldedMultiply(read64(p) ^ kSecret1, read64(p + 8) ^ seed);
+            p += 16;
+            rest -= 16;
+        }
+        // 最后16字节（可能与已处理的部分重叠）
+        a = read64(p + rest - 16);
+        b = read64(p + rest - 8);
+    }
+    __uint128_t product = static_cast<__uint128_t>(a ^ kSecret1) * (b ^ seed);
+    return foldedMultiply(static_cast<uint64_t>(product) ^ kSecret0 ^ len,
+                          static_cast<uint64_t>(product >> 64) ^ kSecret1);
+}
+
+// 整数混合：std::hash对整数是恒等映射，连续或等间隔的key取模后会挤在少数分片/桶里
+inline uint64_t mixInteger(uint64_t x)
+{
+    return foldedMultiply(x ^ kSecret0, kSecret1);
+}
+
+} // namespace HashDetail
+
+/*
+ * CacheHash 各缓存和分片包装的默认Hasher
+ * - 整数和枚举：一次128位乘法混合，低位高位都均匀，可直接对分片数取模
+ * - std::string / std::string_view：wyhash风格的字节串哈希，比libstdc++的murmur实现快
+ * - 其他类型退回std::hash
+ * 结果只取决于key本身（没有随机种子），因此也可用于共享内存等跨进程的场景。
+ */
+template<typename Key, typename = void>
+struct CacheHash
+{
+    size_t operator()(const Key& key) const
+    {
+        return std::hash<Key>()(key);
+    }
+};
+
+template<typename Key>
+struct CacheHash<Key, std::enable_if_t<std::is_integral<Key>::value || std::is_enum<Key>::value>>
+{
+    size_t operator()(Key key) const
+    {
+        return static_cast<size_t>(HashDetail::mixInteger(static_cast<uint64_t>(key)));
+    }
+};
+
+template<>
+struct CacheHash<std::string>
+{
+    size_t operator()(const std::string& key) const
+    {
+        return static_cast<size_t>(HashDetail::hashBytes(key.data(), key.size()));
+    }
+};
+
+template<>
+struct CacheHash<std::string_view>
+{
+    size_t operator()(std::string_view key) const
+    {
+        return static_cast<size_t>(HashDetail::hashBytes(key.data(), key.size()));
+    }
+};
+
+} // namespace XrmsCache
@@ -0,0 +1,756 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <utility>
+
+#include "CacheMemory.h"
+
+namespace XrmsCache
+{
+
+/*
+ * IncrementalHashMap 渐进式扩容的开放寻址哈希表（线性探测）
+ * std::unordered_map扩容时一次性重新散列全部元素，缓存填充阶段会在持锁期间出现毫秒级的停顿。
+ * 这里扩容时先分配新表，旧表保留，此后每次插入/删除顺带把旧表中固定数量的槽位迁移到新表，
+ * 查找同时检查两张表；新表容量至少是元素数的8/3倍，迁移一定能在新表再次写满之前完成，
+ * 因此任何单次操作的开销都与元素总数无关。
+ *
+ * find/tryEmplace返回的指针在下一次插入或删除之前有效。
+ * 新表的控制字节来自calloc、条目按需构造，分配新表本身也不随容量线性增长；
+ * 删除时立即析构条目，值中持有的资源（如shared_ptr节点）不会滞留在表里。
+ * 表的内存来自resource（为空时用malloc/calloc），见CacheMemory。
+ */
+template<typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class IncrementalHashMap
+{
+public:
+    explicit IncrementalHashMap(size_t expected = 0, std::pmr::memory_resource* resource = nullptr)
+        : resource_(resource)
+    {
+        if (expected > 0)
+        {
+            reserve(expected);
+        }
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    bool rehashing() const { return old_.capacity() != 0; }
+
+    Value* find(const Key& key)
+    {
+        size_t hash = Hash()(key);
+        Entry* entry = findIn(cur_, key, hash);
+        if (!entry && rehashing())
+        {
+            entry = findIn(old_, key, hash);
+        }
+        return entry ? &entry->value : nullptr;
+    }
+
+    // key不存在时插入默认构造的值，返回值的指针和是否为新插入
+    std::pair<Value*, bool> tryEmplace(const Key& key)
+    {
+        migrateStep();
+        size_t hash = Hash()(key);
+        Entry* entry = findIn(cur_, key, hash);
+        if (!entry && rehashing())
+        {
+            entry = findIn(old_, key, hash);
+        }
+        if (entry)
+        {
+            return {&entry->value, false};
+        }
+        if ((cur_.used + 1) * 4 > cur_.capacity() * 3)
+        {
+            grow();
+        }
+        entry = insertNew(cur_, hash, key);
+        ++size_;
+        return {&entry->value, true};
+    }
+
+    void insertOrAssign(const Key& key, Value value)
+    {
+        *tryEmplace(key).first = std::move(value);
+    }
+
+    bool erase(const Key& key)
+    {
+        migrateStep();
+        size_t hash = Hash()(key);
+        if (eraseIn(cur_, key, hash) || (rehashing() && eraseIn(old_, key, hash)))
+        {
+            --size_;
+            return true;
+        }
+        return false;
+    }
+
+    // 一次性扩到能容纳n个元素而不再扩容，开销O(n)，只应在构造或预热时调用
+    void reserve(size_t n)
+    {
+        size_t capacity = capacityFor(n, 3, 4);
+        if (capacity <= cur_.capacity() && !rehashing())
+        {
+            return;
+        }
+        Table bigger(std::max(capacity, cur_.capacity()), resource_);
+        moveAll(cur_, bigger);
+        moveAll(old_, bigger);
+        cur_ = std::move(bigger);
+        old_ = Table();
+    }
+
+    // 清空元素，保留当前容量
+    void clear()
+    {
+        cur_ = Table(cur_.capacity(), resource_);
+        old_ = Table();
+        size_ = 0;
+    }
+
+    // 遍历所有元素：fn(const Key&, Value&)，遍历期间不能插入或删除
+    template<typename Fn>
+    void forEach(Fn fn)
+    {
+        forEachIn(cur_, fn);
+        forEachIn(old_, fn);
+    }
+
+    // 新旧两张表的控制字节和条目数组占用的字节数
+    size_t memoryBytes() const
+    {
+        return (cur_.capacity() + old_.capacity()) * (sizeof(uint8_t) + sizeof(Entry));
+    }
+
+private:
+    static constexpr uint8_t kEmpty = 0;
+    static constexpr uint8_t kFull = 1;
+    static constexpr uint8_t kDeleted = 2;      // 墓碑：保持探测链不断开
+    static constexpr size_t kMigrateSlots = 16; // 每次插入/删除迁移的旧表槽位数
+
+    struct Entry
+    {
+        Key   key;
+        Value value;
+    };
+
+    // 控制字节用calloc分配：大块内存直接来自mmap的零页，扩容时不需要先把整张新表写一遍；
+    // 条目只在占用时构造、释放时析构
+    struct Table
+    {
+        Table() = default;
+        Table(size_t capacity, std::pmr::memory_resource* memory)
+            : ctrl(static_cast<uint8_t*>(CacheMemory::allocateZeroed(memory, capacity)))
+            , cap(capacity)
+            , shift(64)
+            , resource(memory)
+        {
+            try
+            {
+                entries = static_cast<Entry*>(CacheMemory::allocate(memory, capacity * sizeof(Entry), alignof(Entry)));
+            }
+            catch (...)
+            {
+                CacheMemory::deallocate(memory, ctrl, capacity);
+                throw;
+            }
+            for (size_t c = capacity; c > 1; c >>= 1)
+            {
+                --shift;
+            }
+        }
+
+        ~Table() { release(); }
+
+        Table(const Table&) = delete;
+        Table& operator=(const Table&) = delete;
+
+        Table(Table&& other) noexcept { swap(other); }
+
+        Table& operator=(Table&& other) noexcept
+        {
+            if (this != &other)
+            {
+                release();
+                swap(other);
+            }
+            return *this;
+        }
+
+        size_t capacity() const { return cap; }
+
+        void swap(Table& other) noexcept
+        {
+            std::swap(ctrl, other.ctrl);
+            std::swap(entries, other.entries);
+            std::swap(cap, other.cap);
+            std::swap(used, other.used);
+            std::swap(full, other.full);
+            std::swap(shift, other.shift);
+            std::swap(resource, other.resource);
+        }
+
+        void release()
+        {
+            // 迁移完的旧表只剩墓碑，不必逐个槽位检查
+            for (size_t i = 0; full > 0 && i < cap; ++i)
+            {
+                if (ctrl[i] == kFull)
+                {
+                    entries[i].~Entry();
+                    --full;
+                }
+            }
+            CacheMemory::deallocate(resource, ctrl, cap);
+            CacheMemory::deallocate(resource, entries, cap * sizeof(Entry), alignof(Entry));
+            ctrl = nullptr;
+            entries = nullptr;
+            cap = 0;
+            used = 0;
+            full = 0;
+            shift = 64;
+        }
+
+        uint8_t* ctrl = nullptr;
+        Entry*   entries = nullptr;
+        size_t   cap = 0;
+        size_t   used = 0;      // 非空槽位数（含墓碑）
+        size_t   full = 0;      // 存放条目的槽位数
+        int      shift = 64;    // 斐波那契散列取高位的位移
+        std::pmr::memory_resource* resource = nullptr;
+    };
+
+    // 容量取2的幂，保证n个元素时负载不超过num/den
+    static size_t capacityFor(size_t n, size_t num, size_t den)
+    {
+        size_t capacity = 16;
+        while (capacity * num < n * den)
+        {
+            capacity <<= 1;
+        }
+        return capacity;
+    }
+
+    // 乘以黄金分割常数后取高位，连续整数等有规律的哈希值也能均匀分布
+    static size_t slotOf(const Table& table, size_t hash)
+    {
+        return static_cast<size_t>((static_cast<uint64_t>(hash) * 0x9e3779b97f4a7c15ull) >> table.shift);
+    }
+
+    static Entry* findIn(Table& table, const Key& key, size_t hash)
+    {
+        if (table.capacity() == 0)
+        {
+            return nullptr;
+        }
+        size_t mask = table.capacity() - 1;
+        for (size_t i = slotOf(table, hash); ; i = (i + 1) & mask)
+        {
+            if (table.ctrl[i] == kEmpty)
+            {
+                return nullptr;
+            }
+            if (table.ctrl[i] == kFull && KeyEqual()(table.entries[i].key, key))
+            {
+                return &table.entries[i];
+            }
+        }
+    }
+
+    // 调用方已确认key不存在：在探测链上第一个空槽或墓碑处构造条目
+    template<typename K, typename... Args>
+    static Entry* insertNew(Table& table, size_t hash, K&& key, Args&&... value)
+    {
+        size_t mask = table.capacity() - 1;
+        size_t i = slotOf(table, hash);
+        while (table.ctrl[i] == kFull)
+        {
+            i = (i + 1) & mask;
+        }
+        if (table.ctrl[i] == kEmpty)
+        {
+            ++table.used;
+        }
+        Entry* entry = new (&table.entries[i]) Entry{std::forward<K>(key), Value(std::forward<Args>(value)...)};
+        table.ctrl[i] = kFull;
+        ++table.full;
+        return entry;
+    }
+
+    static bool eraseIn(Table& table, const Key& key, size_t hash)
+    {
+        Entry* entry = findIn(table, key, hash);
+        if (!entry)
+        {
+            return false;
+        }
+        size_t i = static_cast<size_t>(entry - table.entries);
+        releaseSlot(table, i);
+        return true;
+    }
+
+    // 下一个槽位为空时没有探测链经过这里，可以直接置空，否则留下墓碑
+    static void releaseSlot(Table& table, size_t i)
+    {
+        table.entries[i].~Entry();
+        --table.full;
+        if (table.ctrl[(i + 1) & (table.capacity() - 1)] == kEmpty)
+        {
+            table.ctrl[i] = kEmpty;
+            --table.used;
+        }
+        else
+        {
+            table.ctrl[i] = kDeleted;
+        }
+    }
+
+    // 把from表第i个条目移到to表，原槽位留下墓碑
+    static void moveEntry(Table& from, size_t i, Table& to)
+    {
+        Entry& entry = from.entries[i];
+        insertNew(to, Hash()(entry.key), std::move(entry.key), std::move(entry.value));
+        entry.~Entry();
+        from.ctrl[i] = kDeleted;
+        --from.full;
+    }
+
+    static void moveAll(Table& from, Table& to)
+    {
+        for (size_t i = 0; i < from.capacity(); ++i)
+        {
+            if (from.ctrl[i] == kFull)
+            {
+                moveEntry(from, i, to);
+            }
+        }
+    }
+
+    template<typename Fn>
+    static void forEachIn(Table& table, Fn& fn)
+    {
+        for (size_t i = 0; i < table.capacity(); ++i)
+        {
+            if (table.ctrl[i] == kFull)
+            {
+                fn(static_cast<const Key&>(table.entries[i].key), table.entries[i].value);
+            }
+        }
+    }
+
+    // 当前表写满：旧表换下，分配足够大的新表，之后逐步迁移
+    void grow()
+    {
+        if (rehashing())
+        {
+            // 正常情况下不会发生：迁移速度保证旧表先于新表写满迁完
+            while (rehashing())
+            {
+                migrateStep();
+            }
+            if ((cur_.used + 1) * 4 <= cur_.capacity() * 3)
+            {
+                return;
+            }
+        }
+        Table bigger(capacityFor(size_ + 1, 3, 8), resource_);
+        if (size_ == 0)
+        {
+            cur_ = std::move(bigger);
+            return;
+        }
+        old_ = std::move(cur_);
+        cur_ = std::move(bigger);
+        migrateCursor_ = 0;
+    }
+
+    // 把旧表中接下来的若干槽位搬到新表，迁移过的槽位留下墓碑，旧表上的探测链保持完整
+    void migrateStep()
+    {
+        if (!rehashing())
+        {
+            return;
+        }
+        size_t end = std::min(migrateCursor_ + kMigrateSlots, old_.capacity());
+        for (; migrateCursor_ < end; ++migrateCursor_)
+        {
+            if (old_.ctrl[migrateCursor_] == kFull)
+            {
+                moveEntry(old_, migrateCursor_, cur_);
+            }
+        }
+        if (migrateCursor_ == old_.capacity())
+        {
+            old_ = Table();
+        }
+    }
+
+private:
+    Table  cur_;                // 新元素总是插入这张表
+    Table  old_;                // 迁移中的旧表，容量为0表示没有在迁移
+    size_t migrateCursor_ = 0;  // 旧表中下一个待迁移的槽位
+    size_t size_ = 0;
+    std::pmr::memory_resource* resource_;   // 表的内存来源，为空时用malloc
+};
+
+/*
+ * NodeIndex 节点自带哈希值和槽位的开放寻址索引（线性探测，删除时向前回填，不留墓碑）
+ * 槽位只存(哈希值, 节点指针)：查找先比较完整哈希值，相等才回调比较key；
+ * 节点记录自己所在的槽位，删除时直接定位，不需要重新计算哈希也不比较key。
+ * 节点类型需提供可被本类访问的成员 size_t hash_ 和 size_t slot_。
+ * 扩容时用槽位中保存的哈希值重新放置，同样不触碰key。槽位数组来自resource（为空时用calloc）。
+ */
+template<typename Node>
+class NodeIndex
+{
+public:
+    explicit NodeIndex(size_t expected = 0, std::pmr::memory_resource* resource = nullptr)
+        : resource_(resource)
+    {
+        if (expected > 0)
+        {
+            reserve(expected);
+        }
+    }
+
+    ~NodeIndex() { CacheMemory::deallocate(resource_, slots_, capacity_ * sizeof(Slot)); }
+
+    NodeIndex(const NodeIndex&) = delete;
+    NodeIndex& operator=(const NodeIndex&) = delete;
+
+    NodeIndex(NodeIndex&& other) noexcept { swap(other); }
+
+    NodeIndex& operator=(NodeIndex&& other) noexcept
+    {
+        NodeIndex(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    void swap(NodeIndex& other) noexcept
+    {
+        std::swap(slots_, other.slots_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(shift_, other.shift_);
+        std::swap(size_, other.size_);
+        std::swap(resource_, other.resource_);
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    // 查找哈希值为hash且match(node)为true的节点
+    template<typename Match>
+    Node* find(size_t hash, Match match) const
+    {
+        if (size_ == 0)
+        {
+            return nullptr;
+        }
+        size_t mask = capacity_ - 1;
+        for (size_t i = homeOf(hash); slots_[i].node; i = (i + 1) & mask)
+        {
+            if (slots_[i].hash == hash && match(slots_[i].node))
+            {
+                return slots_[i].node;
+            }
+        }
+        return nullptr;
+    }
+
+    // 登记新节点（调用方已确认不存在相同key），哈希值取node->hash_
+    void insert(Node* node)
+    {
+        if ((size_ + 1) * 4 > capacity_ * 3)
+        {
+            rehash(capacityFor(size_ + 1));
+        }
+        place(node->hash_, node);
+        ++size_;
+    }
+
+    // 按节点记录的槽位删除；后面同一探测链上的节点依次前移填补空位
+    void erase(Node* node)
+    {
+        size_t mask = capacity_ - 1;
+        size_t hole = node->slot_;
+        for (size_t i = (hole + 1) & mask; slots_[i].node; i = (i + 1) & mask)
+        {
+            // 槽位i的理想位置不在(hole, i]之间时，可以移到hole
+            size_t home = homeOf(slots_[i].hash);
+            if (((i - home) & mask) >= ((i - hole) & mask))
+            {
+                slots_[hole] = slots_[i];
+                slots_[hole].node->slot_ = hole;
+                hole = i;
+            }
+        }
+        slots_[hole] = Slot{};
+        --size_;
+    }
+
+    // 预留至少容纳n个节点的空间，负载不超过一半
+    void reserve(size_t n)
+    {
+        size_t capacity = capacityFor(n);
+        if (capacity > capacity_)
+        {
+            rehash(capacity);
+        }
+    }
+
+    // 索引本身占用的字节数
+    size_t memoryBytes() const { return capacity_ * sizeof(Slot); }
+
+    // 清空，保留容量
+    void clear()
+    {
+        if (slots_)
+        {
+            std::memset(static_cast<void*>(slots_), 0, capacity_ * sizeof(Slot));
+        }
+        size_ = 0;
+    }
+
+private:
+    struct Slot
+    {
+        size_t hash;
+        Node*  node;    // 为空表示空槽
+    };
+
+    static size_t capacityFor(size_t n)
+    {
+        size_t capacity = 8;
+        while (capacity < n * 2)
+        {
+            capacity <<= 1;
+        }
+        return capacity;
+    }
+
+    size_t homeOf(size_t hash) const
+    {
+        return static_cast<size_t>((static_cast<uint64_t>(hash) * 0x9e3779b97f4a7c15ull) >> shift_);
+    }
+
+    void place(size_t hash, Node* node)
+    {
+        size_t mask = capacity_ - 1;
+        size_t i = homeOf(hash);
+        while (slots_[i].node)
+        {
+            i = (i + 1) & mask;
+        }
+        slots_[i] = Slot{hash, node};
+        node->slot_ = i;
+    }
+
+    void rehash(size_t capacity)
+    {
+        Slot* slots = static_cast<Slot*>(CacheMemory::allocateZeroed(resource_, capacity * sizeof(Slot)));
+        Slot* old = slots_;
+        size_t oldCapacity = capacity_;
+        slots_ = slots;
+        capacity_ = capacity;
+        shift_ = 64;
+        for (size_t c = capacity; c > 1; c >>= 1)
+        {
+            --shift_;
+        }
+        for (size_t i = 0; i < oldCapacity; ++i)
+        {
+            if (old[i].node)
+            {
+                place(old[i].hash, old[i].node);
+            }
+        }
+        CacheMemory::deallocate(resource_, old, oldCapacity * sizeof(Slot));
+    }
+
+private:
+    Slot*  slots_ = nullptr;
+    size_t capacity_ = 0;   // 2的幂
+    int    shift_ = 64;     // 斐波那契散列取高位的位移
+    size_t size_ = 0;
+    std::pmr::memory_resource* resource_ = nullptr;    // 槽位数组的来源，为空时用calloc
+};
+
+/*
+ * DenseNodeIndex 稠密整数key的直接寻址索引
+ * key落在[0, maxKey]且按stride等间隔分布（分片缓存中每个分片的key模分片数相同）时，
+ * 槽位号就是key / stride，查找只是一次数组访问，没有哈希也没有探测。
+ * 槽位总数不超过预计条目数的kDirectRatio倍时用一整块直接数组；
+ * 范围更稀疏时用两级基数表：第一级按槽位号高位索引，第二级每页kLeafSize个槽位，页在首次写入时分配、空了就释放。
+ * 数组和页都来自resource（为空时用calloc）。
+ */
+template<typename Node>
+class DenseNodeIndex
+{
+public:
+    explicit DenseNodeIndex(std::pmr::memory_resource* resource = nullptr)
+        : resource_(resource)
+    {}
+
+    ~DenseNodeIndex() { release(); }
+
+    DenseNodeIndex(const DenseNodeIndex&) = delete;
+    DenseNodeIndex& operator=(const DenseNodeIndex&) = delete;
+
+    DenseNodeIndex(DenseNodeIndex&& other) noexcept { swap(other); }
+
+    DenseNodeIndex& operator=(DenseNodeIndex&& other) noexcept
+    {
+        DenseNodeIndex(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    void swap(DenseNodeIndex& other) noexcept
+    {
+        std::swap(direct_, other.direct_);
+        std::swap(leaves_, other.leaves_);
+        std::swap(leafCount_, other.leafCount_);
+        std::swap(slotCount_, other.slotCount_);
+        std::swap(size_, other.size_);
+        std::swap(resource_, other.resource_);
+    }
+
+    // 覆盖slotCount个槽位，expected为预计条目数，用于在直接数组和两级表之间选择
+    void init(uint64_t slotCount, size_t expected)
+    {
+        release();
+        slotCount_ = slotCount;
+        if (slotCount <= std::max<uint64_t>(static_cast<uint64_t>(expected) * kDirectRatio, kLeafSize))
+        {
+            direct_ = static_cast<Node**>(CacheMemory::allocateZeroed(resource_, static_cast<size_t>(slotCount) * sizeof(Node*)));
+        }
+        else
+        {
+            leafCount_ = static_cast<size_t>((slotCount + kLeafSize - 1) / kLeafSize);
+            leaves_ = static_cast<Leaf**>(CacheMemory::allocateZeroed(resource_, leafCount_ * sizeof(Leaf*)));
+        }
+    }
+
+    bool enabled() const { return slotCount_ != 0; }
+    uint64_t slotCount() const { return slotCount_; }
+    size_t size() const { return size_; }
+
+    Node* find(uint64_t slot) const
+    {
+        if (direct_)
+        {
+            return direct_[slot];
+        }
+        Leaf* leaf = leaves_[slot / kLeafSize];
+        return leaf ? leaf->slots[slot % kLeafSize] : nullptr;
+    }
+
+    // 调用方已确认该槽位为空
+    void insert(uint64_t slot, Node* node)
+    {
+        ++size_;
+        if (direct_)
+        {
+            direct_[slot] = node;
+            return;
+        }
+        Leaf*& leaf = leaves_[slot / kLeafSize];
+        if (!leaf)
+        {
+            leaf = static_cast<Leaf*>(CacheMemory::allocateZeroed(resource_, sizeof(Leaf), alignof(Leaf)));
+        }
+        leaf->slots[slot % kLeafSize] = node;
+        ++leaf->count;
+    }
+
+    void erase(uint64_t slot)
+    {
+        --size_;
+        if (direct_)
+        {
+            direct_[slot] = nullptr;
+            return;
+        }
+        Leaf*& leaf = leaves_[slot / kLeafSize];
+        leaf->slots[slot % kLeafSize] = nullptr;
+        if (--leaf->count == 0)
+        {
+            CacheMemory::deallocate(resource_, leaf, sizeof(Leaf), alignof(Leaf));
+            leaf = nullptr;
+        }
+    }
+
+    // 清空，保留槽位范围
+    void clear()
+    {
+        if (direct_)
+        {
+            std::memset(static_cast<void*>(direct_), 0, static_cast<size_t>(slotCount_) * sizeof(Node*));
+        }
+        for (size_t i = 0; i < leafCount_; ++i)
+        {
+            CacheMemory::deallocate(resource_, leaves_[i], sizeof(Leaf), alignof(Leaf));
+            leaves_[i] = nullptr;
+        }
+        size_ = 0;
+    }
+
+    // 索引本身占用的字节数
+    size_t memoryBytes() const
+    {
+        if (direct_)
+        {
+            return static_cast<size_t>(slotCount_) * sizeof(Node*);
+        }
+        size_t bytes = leafCount_ * sizeof(Leaf*);
+        for (size_t i = 0; i < leafCount_; ++i)
+        {
+            bytes += leaves_[i] ? sizeof(Leaf) : 0;
+        }
+        return bytes;
+    }
+
+private:
+    static constexpr uint64_t kLeafSize = 4096;
+    static constexpr uint64_t kDirectRatio = 8;
+
+    // 页由清零的内存直接充当，不经过构造
+    struct Leaf
+    {
+        Node*  slots[kLeafSize];
+        size_t count;
+    };
+
+    void release()
+    {
+        CacheMemory::deallocate(resource_, direct_, static_cast<size_t>(slotCount_) * sizeof(Node*));
+        direct_ = nullptr;
+        for (size_t i = 0; i < leafCount_; ++i)
+        {
+            CacheMemory::deallocate(resource_, leaves_[i], sizeof(Leaf), alignof(Leaf));
+        }
+        CacheMemory::deallocate(resource_, leaves_, leafCount_ * sizeof(Leaf*));
+        leaves_ = nullptr;
+        leafCount_ = 0;
+        slotCount_ = 0;
+        size_ = 0;
+    }
+
+private:
+    Node**   direct_ = nullptr;     // 直接数组模式
+    Leaf**   leaves_ = nullptr;     // 两级表模式的第一级
+    size_t   leafCount_ = 0;
+    uint64_t slotCount_ = 0;        // 为0表示未启用
+    size_t   size_ = 0;
+    std::pmr::memory_resource* resource_ = nullptr;    // 数组和页的来源，为空时用calloc
+};
+
+} // namespace XrmsCache
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace XrmsCache
+{
+
+/*
+ * CacheMaintainer 缓存的后台维护线程池
+ * 各缓存分片把自己的维护函数（水位淘汰、频次老化、写回等）注册为任务，
+ * 线程池每隔interval把所有任务执行一遍，分片也可以通过wakeup立即唤醒自己的任务。
+ * 同一任务不会被两个线程同时执行；removeTask会等正在执行的那一次结束后才返回，
+ * 因此缓存在析构前注销任务即可保证维护线程不再访问它。
+ */
+class CacheMaintainer
+{
+public:
+    explicit CacheMaintainer(int threadNum = 1,
+                             std::chrono::milliseconds interval = std::chrono::milliseconds(100))
+        : interval_(interval)
+        , nextPass_(std::chrono::steady_clock::now() + interval)
+    {
+        threadNum = std::max(threadNum, 1);
+        for (int i = 0; i < threadNum; ++i)
+        {
+            workers_.emplace_back([this]() { workerLoop(); });
+        }
+    }
+
+    ~CacheMaintainer()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wakeCond_.notify_all();
+        for (auto& worker : workers_)
+        {
+            worker.join();
+        }
+    }
+
+    CacheMaintainer(const CacheMaintainer&) = delete;
+    CacheMaintainer& operator=(const CacheMaintainer&) = delete;
+
+    // 注册维护任务，返回任务编号
+    size_t addTask(std::function<void()> task)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto entry = std::make_unique<Task>();
+        entry->id = ++lastId_;
+        entry->fn = std::move(task);
+        tasks_.push_back(std::move(entry));
+        return lastId_;
+    }
+
+    // 注销任务，若任务正在执行则等待其结束
+    void removeTask(size_t id)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto it = std::find_if(tasks_.begin(), tasks_.end(),
+                               [id](const std::unique_ptr<Task>& task) { return task->id == id; });
+        if (it == tasks_.end())
+        {
+            return;
+        }
+        Task* task = it->get();
+        doneCond_.wait(lock, [task]() { return !task->running; });
+        tasks_.erase(std::find_if(tasks_.begin(), tasks_.end(),
+                                  [task](const std::unique_ptr<Task>& t) { return t.get() == task; }));
+    }
+
+    // 尽快执行一次指定任务
+    void wakeup(size_t id)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto& task : tasks_)
+            {
+                if (task->id == id)
+                {
+                    task->pending = true;
+                    break;
+                }
+            }
+        }
+        wakeCond_.notify_one();
+    }
+
+private:
+    struct Task
+    {
+        size_t id = 0;
+        std::function<void()> fn;
+        bool pending = false;   // 等待执行
+        bool running = false;   // 正在被某个线程执行
+    };
+
+    void workerLoop()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_)
+        {
+            Task* task = nullptr;
+            for (auto& candidate : tasks_)
+            {
+                if (candidate->pending && !candidate->running)
+                {
+                    task = candidate.get();
+                    break;
+                }
+            }
+            if (task)
+            {
+                task->pending = false;
+                task->running = true;
+                lock.unlock();
+                task->fn();
+                lock.lock();
+                task->running = false;
+                doneCond_.notify_all();
+                continue;
+            }
+
+            // 定期把所有任务标记为待执行，多个线程中先到期的那个负责
+            if (wakeCond_.wait_until(lock, nextPass_) == std::cv_status::timeout
+                && std::chrono::steady_clock::now() >= nextPass_)
+            {
+                for (auto& candidate : tasks_)
+                {
+                    candidate->pending = true;
+                }
+                nextPass_ = std::chrono::steady_clock::now() + interval_;
+                wakeCond_.notify_all();
+            }
+        }
+    }
+
+private:
+    std::chrono::milliseconds interval_;
+    std::chrono::steady_clock::time_point nextPass_;   // 下一次定期执行的时间
+    std::mutex                mutex_;
+    std::condition_variable   wakeCond_;    // 有任务待执行或需要停止
+    std::condition_variable   doneCond_;    // 有任务执行结束
+    std::vector<std::unique_ptr<Task>> tasks_;
+    std::vector<std::thread>  workers_;
+    size_t                    lastId_ = 0;
+    bool                      stop_ = false;
+};
+
+} // namespace XrmsCache
@@ -0,0 +1,303 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory_resource>
+#include <new>
+#include <string>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace XrmsCache
+{
+
+/*
+ * CacheMemoryUsage 缓存占用内存的分类统计，单位字节，由各缓存的memoryUsage()给出
+ * 节点内存池、索引表按已申请的整块计，标准容器经CountingResource逐次计数；
+ * values是key/value在节点之外持有的堆内存，由权重函数（weigher）逐条目估计。
+ */
+struct CacheMemoryUsage
+{
+    size_t entries = 0;     // 主缓存中的条目数（ARC两部分各自计数）
+    size_t index = 0;       // key到节点的索引
+    size_t nodes = 0;       // 节点（含内联的key/value）
+    size_t ghost = 0;       // 幽灵节点及其索引、LRU-K的访问历史
+    size_t frequency = 0;   // 频次链表和频次映射
+    size_t values = 0;      // key/value在节点之外的堆内存
+
+    size_t total() const { return index + nodes + ghost + frequency + values; }
+
+    CacheMemoryUsage& operator+=(const CacheMemoryUsage& other)
+    {
+        entries += other.entries;
+        index += other.index;
+        nodes += other.nodes;
+        ghost += other.ghost;
+        frequency += other.frequency;
+        values += other.values;
+        return *this;
+    }
+};
+
+// 权重函数：返回一个条目的key/value在节点之外持有的堆内存字节数，为空时用CacheMemory::heapBytes
+template<typename Key, typename Value>
+using CacheWeigher = std::function<size_t(const Key&, const Value&)>;
+
+/*
+ * CacheMemory 缓存内部大块内存的统一来源
+ * 节点内存块、索引表、频率桶都经由这里申请：resource为空时使用malloc/calloc/free，
+ * 大块清零内存直接来自mmap的零页，不必逐字节写一遍；传入std::pmr::memory_resource*时全部转给它，
+ * 例如按租户划分的内存池、NUMA本地内存池或std::pmr::monotonic_buffer_resource。
+ *
+ * 开启后台释放时内存在另一个线程中归还，且可能晚于缓存析构：此时resource必须是线程安全的
+ * （如std::pmr::synchronized_pool_resource），并存活到waitBackgroundRelease()返回。
+ * 传入resource的缓存调用setBackgroundRelease(true, true)显式确认这两点，否则后台释放不会开启。
+ */
+namespace CacheMemory
+{
+
+inline void* allocate(std::pmr::memory_resource* resource, size_t bytes, size_t align = alignof(std::max_align_t))
+{
+    if (bytes == 0)
+    {
+        return nullptr;
+    }
+    if (resource)
+    {
+        return resource->allocate(bytes, align);
+    }
+    void* p = align <= alignof(std::max_align_t)
+        ? std::malloc(bytes)
+        : std::aligned_alloc(align, (bytes + align - 1) / align * align);
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+// 清零的内存：默认走calloc，大块时由内核提供零页
+inline void* allocateZeroed(std::pmr::memory_resource* resource, size_t bytes, size_t align = alignof(std::max_align_t))
+{
+    if (bytes == 0)
+    {
+        return nullptr;
+    }
+    if (!resource && align <= alignof(std::max_align_t))
+    {
+        void* p = std::calloc(bytes, 1);
+        if (!p)
+        {
+            throw std::bad_alloc();
+        }
+        return p;
+    }
+    void* p = allocate(resource, bytes, align);
+    std::memset(p, 0, bytes);
+    return p;
+}
+
+inline void deallocate(std::pmr::memory_resource* resource, void* p, size_t bytes, size_t align = alignof(std::max_align_t))
+{
+    if (!p)
+    {
+        return;
+    }
+    if (resource)
+    {
+        resource->deallocate(p, bytes, align);
+    }
+    else
+    {
+        std::free(p);
+    }
+}
+
+// 标准容器使用的polymorphic_allocator需要非空的resource
+inline std::pmr::memory_resource* orDefault(std::pmr::memory_resource* resource)
+{
+    return resource ? resource : std::pmr::get_default_resource();
+}
+
+// 对象在自身之外持有的堆内存，默认权重函数使用：一般类型为0，
+// std::string超出短字符串缓冲区（默认构造时的容量）后按容量计
+template<typename T>
+size_t heapBytes(const T&)
+{
+    return 0;
+}
+
+inline size_t heapBytes(const std::string& s)
+{
+    static const size_t inlineCapacity = std::string().capacity();
+    return s.capacity() > inlineCapacity ? s.capacity() + 1 : 0;
+}
+
+template<typename Key, typename Value>
+size_t weigh(const CacheWeigher<Key, Value>& weigher, const Key& key, const Value& value)
+{
+    return weigher ? weigher(key, value) : heapBytes(key) + heapBytes(value);
+}
+
+/*
+ * CountingResource 统计存活字节数和分配次数的memory_resource
+ * 分配转给upstream（为空时用malloc），计数为原子变量，可以在后台释放线程中归还。
+ * 缓存内部用它统计标准容器的占用；也可以作为缓存的resource传入，核对memoryUsage()的合计。
+ */
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+    explicit CountingResource(std::pmr::memory_resource* upstream = nullptr)
+        : upstream_(upstream)
+    {}
+
+    // 当前存活的字节数和分配次数
+    size_t bytes() const { return bytes_.load(std::memory_order_relaxed); }
+    size_t allocations() const { return allocations_.load(std::memory_order_relaxed); }
+
+private:
+    void* do_allocate(size_t bytes, size_t align) override
+    {
+        void* p = CacheMemory::allocate(upstream_, bytes, align);
+        bytes_.fetch_add(bytes, std::memory_order_relaxed);
+        allocations_.fetch_add(1, std::memory_order_relaxed);
+        return p;
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t align) override
+    {
+        CacheMemory::deallocate(upstream_, p, bytes, align);
+        bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+        allocations_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+
+private:
+    std::pmr::memory_resource*  upstream_;
+    std::atomic<size_t>         bytes_{0};
+    std::atomic<size_t>         allocations_{0};
+};
+
+/*
+ * HugePageResource 以2MB大页为单位提供大块内存的memory_resource
+ * 千万级条目时，随机查找索引和节点的开销主要在TLB未命中；不小于threshold的请求
+ * 用mmap取起点2MB对齐的区域并madvise(MADV_HUGEPAGE)，由透明大页(THP)承载，一个TLB项覆盖2MB而不是4KB。
+ * 区域只按4KB取整，末尾不足2MB的部分仍是普通页，不为凑整浪费内存。
+ * 更小的请求（内存池最初的小块、小索引）交给upstream。
+ *
+ * 内核未开启THP或madvise失败时区域仍然可用，只是退化为普通4KB页；非Linux平台全部交给upstream。
+ * 是否走mmap只由请求大小决定，释放时据此判断，不需要额外记录。
+ * mmap/munmap本身线程安全，可以配合后台释放使用。
+ */
+class HugePageResource : public std::pmr::memory_resource
+{
+public:
+    static constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+    explicit HugePageResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource(),
+                              size_t threshold = kHugePageSize)
+        : upstream_(upstream)
+        , threshold_(threshold)
+    {}
+
+    // 当前由mmap映射的字节数
+    size_t mappedBytes() const { return mappedBytes_.load(std::memory_order_relaxed); }
+
+private:
+    bool useHugePages(size_t bytes, size_t align) const
+    {
+#if defined(__linux__)
+        return bytes >= threshold_ && align <= kHugePageSize;
+#else
+        (void)bytes;
+        (void)align;
+        return false;
+#endif
+    }
+
+    static constexpr size_t kPageSize = 4096;
+
+    static size_t roundUp(size_t bytes) { return (bytes + kPageSize - 1) / kPageSize * kPageSize; }
+
+    void* do_allocate(size_t bytes, size_t align) override
+    {
+        if (!useHugePages(bytes, align))
+        {
+            return upstream_->allocate(bytes, align);
+        }
+#if defined(__linux__)
+        // 多映射一个大页的长度，再裁掉首尾多出的部分
+        size_t size = roundUp(bytes);
+        void* raw = mmap(nullptr, size + kHugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED)
+        {
+            throw std::bad_alloc();
+        }
+        uintptr_t begin = reinterpret_cast<uintptr_t>(raw);
+        uintptr_t aligned = (begin + kHugePageSize - 1) & ~(uintptr_t(kHugePageSize) - 1);
+        if (aligned > begin)
+        {
+            munmap(raw, aligned - begin);
+        }
+        size_t tail = begin + size + kHugePageSize - (aligned + size);
+        if (tail > 0)
+        {
+            munmap(reinterpret_cast<void*>(aligned + size), tail);
+        }
+#if defined(MADV_HUGEPAGE)
+        // 失败时（内核不支持THP或已关闭）保持普通页
+        madvise(reinterpret_cast<void*>(aligned), size, MADV_HUGEPAGE);
+#endif
+        mappedBytes_.fetch_add(size, std::memory_order_relaxed);
+        return reinterpret_cast<void*>(aligned);
+#else
+        return nullptr;
+#endif
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t align) override
+    {
+        if (!useHugePages(bytes, align))
+        {
+            upstream_->deallocate(p, bytes, align);
+            return;
+        }
+#if defined(__linux__)
+        size_t size = roundUp(bytes);
+        munmap(p, size);
+        mappedBytes_.fetch_sub(size, std::memory_order_relaxed);
+#endif
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+
+private:
+    std::pmr::memory_resource*  upstream_;
+    size_t                      threshold_;
+    std::atomic<size_t>         mappedBytes_{0};
+};
+
+// 进程内共享的大页内存来源，传给各缓存的resource参数即可
+// 有意不析构：进程退出时仍在运行的后台释放线程还会用它归还内存
+inline HugePageResource* hugePages()
+{
+    static HugePageResource* resource = new HugePageResource;
+    return resource;
+}
+
+} // namespace CacheMemory
+
+} // namespace XrmsCache
@@ -0,0 +1,521 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * 缓存运行指标：命中/未命中/插入/淘汰/幽灵命中/锁竞争计数、条目数、get/put延迟直方图，
+ * 以及按采样的重用距离估计的未命中率曲线（MRC），由CacheMetrics汇总成Prometheus文本格式。
+ * 缓存通过setStats挂上一个CacheStats后才统计，未挂载时每次操作只多一次空指针判断。
+ * 计数都是relaxed原子量，读取方（导出线程）不需要获取任何分片锁；
+ * 一次快照内的各个计数不是同一时刻的值，对监控用途足够。
+ */
+
+namespace XrmsCache
+{
+
+// 延迟直方图：桶的上界为 2^(kFirstShift+i) 纳秒，最后一个桶不设上界
+class LatencyHistogram
+{
+public:
+    static constexpr size_t kFirstShift = 6;    // 第一个桶的上界64ns
+    static constexpr size_t kBuckets = 20;      // 最后一个有界桶的上界约16.8ms
+
+    void record(uint64_t ns)
+    {
+        size_t bucket = 0;
+        while (bucket < kBuckets && ns > upperBoundNs(bucket))
+        {
+            ++bucket;
+        }
+        counts_[bucket].fetch_add(1, std::memory_order_relaxed);
+        sumNs_.fetch_add(ns, std::memory_order_relaxed);
+    }
+
+    static uint64_t upperBoundNs(size_t bucket)
+    {
+        return uint64_t(1) << (kFirstShift + bucket);
+    }
+
+    // 第bucket个桶的计数，bucket == kBuckets 为超出全部上界的部分
+    uint64_t bucketCount(size_t bucket) const
+    {
+        return counts_[bucket].load(std::memory_order_relaxed);
+    }
+
+    uint64_t sumNs() const
+    {
+        return sumNs_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> counts_[kBuckets + 1] = {};
+    std::atomic<uint64_t> sumNs_{0};
+};
+
+/*
+ * MissRatioEstimator 未命中率曲线估计
+ * 按key哈希采样 1/2^sampleShift 的key，对采样到的访问计算重用距离（上次访问以来访问过的不同采样key数），
+ * 乘以2^sampleShift还原为全量的距离；容量为c的LRU缓存中，距离小于c的访问命中，其余（含首次访问）未命中。
+ * 距离用树状数组在访问时间轴上统计，时间轴用满后整体压缩；最多跟踪maxTracked个采样key，
+ * 超出时丢弃最久未访问的，因此只对 maxTracked * 2^sampleShift 以内的容量有意义。
+ * 只有采样到的访问加锁，这把锁与分片锁无关。
+ */
+class MissRatioEstimator
+{
+public:
+    static constexpr size_t kDistanceBuckets = 48;   // 距离按2的幂分桶，第b桶为[2^(b-1), 2^b)，第0桶为距离0
+
+    explicit MissRatioEstimator(unsigned sampleShift = 6, size_t maxTracked = 1 << 16)
+        : sampleShift_(std::min(sampleShift, 30u))
+        , maxTracked_(std::max<size_t>(maxTracked, 1))
+        , slots_(maxTracked_ * 2)
+        , tree_(slots_ + 1, 0)
+        , slotKey_(slots_, 0)
+        , live_(slots_, 0)
+    {}
+
+    MissRatioEstimator(const MissRatioEstimator&) = delete;
+    MissRatioEstimator& operator=(const MissRatioEstimator&) = delete;
+
+    unsigned sampleShift() const { return sampleShift_; }
+
+    // 记录一次访问，hash为key的哈希值
+    void access(size_t hash)
+    {
+        // 分片按哈希取模选择，直接用低位采样会集中在某些分片，先打散
+        uint64_t mixed = static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+        if ((mixed >> (64 - 32)) & ((uint64_t(1) << sampleShift_) - 1))
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = lastSlot_.find(mixed);
+        if (it != lastSlot_.end())
+        {
+            size_t slot = it->second;
+            uint64_t distance = static_cast<uint64_t>(prefix(now_) - prefix(slot + 1)) << sampleShift_;
+            distances_[bucketOf(distance)].fetch_add(1, std::memory_order_relaxed);
+            release(slot);
+        }
+        else
+        {
+            cold_.fetch_add(1, std::memory_order_relaxed);
+            if (lastSlot_.size() >= maxTracked_)
+            {
+                dropOldest();
+            }
+        }
+        if (now_ == slots_)
+        {
+            compact();
+        }
+        size_t slot = now_++;
+        slotKey_[slot] = mixed;
+        live_[slot] = 1;
+        add(slot, 1);
+        lastSlot_[mixed] = slot;
+    }
+
+    // 采样到的访问次数
+    uint64_t samples() const
+    {
+        uint64_t total = cold_.load(std::memory_order_relaxed);
+        for (const auto& bucket : distances_)
+        {
+            total += bucket.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    // 容量为2^log2Size的LRU缓存的估计未命中率；没有样本时返回-1
+    double missRatio(size_t log2Size) const
+    {
+        uint64_t total = samples();
+        if (total == 0)
+        {
+            return -1.0;
+        }
+        uint64_t hits = 0;
+        for (size_t b = 0; b <= log2Size && b < kDistanceBuckets; ++b)
+        {
+            hits += distances_[b].load(std::memory_order_relaxed);
+        }
+        return 1.0 - static_cast<double>(hits) / total;
+    }
+
+private:
+    static size_t bucketOf(uint64_t distance)
+    {
+        size_t bucket = 0;
+        while (distance != 0 && bucket + 1 < kDistanceBuckets)
+        {
+            distance >>= 1;
+            ++bucket;
+        }
+        return bucket;
+    }
+
+    // 树状数组：时间槽[0, slot)内仍然有效（是某个key最近一次访问）的槽数
+    int64_t prefix(size_t slot) const
+    {
+        int64_t sum = 0;
+        for (size_t i = slot; i > 0; i -= i & (~i + 1))
+        {
+            sum += tree_[i];
+        }
+        return sum;
+    }
+
+    void add(size_t slot, int delta)
+    {
+        for (size_t i = slot + 1; i <= slots_; i += i & (~i + 1))
+        {
+            tree_[i] += delta;
+        }
+    }
+
+    void release(size_t slot)
+    {
+        live_[slot] = 0;
+        add(slot, -1);
+    }
+
+    void dropOldest()
+    {
+        while (!live_[oldest_])
+        {
+            ++oldest_;
+        }
+        lastSlot_.erase(slotKey_[oldest_]);
+        release(oldest_);
+    }
+
+    // 时间轴用满：有效的槽按原顺序移到最前面，重建树状数组
+    void compact()
+    {
+        size_t next = 0;
+        for (size_t slot = 0; slot < slots_; ++slot)
+        {
+            if (live_[slot])
+            {
+                slotKey_[next] = slotKey_[slot];
+                lastSlot_[slotKey_[next]] = next;
+                ++next;
+            }
+        }
+        std::fill(live_.begin(), live_.end(), 0);
+        std::fill(tree_.begin(), tree_.end(), 0);
+        for (size_t slot = 0; slot < next; ++slot)
+        {
+            live_[slot] = 1;
+            add(slot, 1);
+        }
+        now_ = next;
+        oldest_ = 0;
+    }
+
+    unsigned sampleShift_;
+    size_t maxTracked_;
+    size_t slots_;                          // 时间轴长度，为maxTracked_的2倍，压缩的代价可以摊薄
+    std::mutex mutex_;
+    std::unordered_map<uint64_t, size_t> lastSlot_;  // 采样key -> 最近一次访问的时间槽
+    std::vector<int64_t> tree_;
+    std::vector<uint64_t> slotKey_;         // 时间槽 -> 采样key
+    std::vector<uint8_t> live_;
+    size_t now_ = 0;                        // 下一个时间槽
+    size_t oldest_ = 0;                     // 不晚于最旧有效槽的位置
+    std::atomic<uint64_t> distances_[kDistanceBuckets] = {};
+    std::atomic<uint64_t> cold_{0};         // 首次访问（或已不再跟踪）的次数
+};
+
+// 一个缓存（或一个分片）的统计，由缓存在操作时更新，导出线程随时读取
+struct CacheStats
+{
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> inserts{0};
+    std::atomic<uint64_t> evictions{0};
+    std::atomic<uint64_t> ghostHits{0};
+    std::atomic<uint64_t> lockContended{0};
+    std::atomic<uint64_t> entries{0};
+    std::atomic<uint64_t> capacity{0};
+    LatencyHistogram getLatency;
+    LatencyHistogram putLatency;
+    std::shared_ptr<MissRatioEstimator> mrc;    // 为空表示不估计未命中率曲线，分片缓存的各分片共用一个
+
+    static void bump(std::atomic<uint64_t>& counter)
+    {
+        counter.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void setEntries(size_t count)
+    {
+        entries.store(count, std::memory_order_relaxed);
+    }
+
+    // get的访问流送给未命中率曲线估计
+    void access(size_t hash)
+    {
+        if (mrc)
+        {
+            mrc->access(hash);
+        }
+    }
+};
+
+// 计时一次操作：构造时记下开始时间，析构时记入直方图；histogram为空时什么都不做
+// 读一次时钟约50ns，和一次命中的耗时相当，因此每个线程只对每 2^kSampleShift 次操作计时一次，
+// 延迟直方图是抽样的分布，_count约为操作数的1/8；操作次数以hits/misses等计数为准
+class LatencyTimer
+{
+public:
+    static constexpr unsigned kSampleShift = 3;
+
+    explicit LatencyTimer(LatencyHistogram* histogram)
+        : histogram_(histogram && sampled() ? histogram : nullptr)
+    {
+        if (histogram_)
+        {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~LatencyTimer()
+    {
+        if (histogram_)
+        {
+            histogram_->record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start_).count()));
+        }
+    }
+
+    LatencyTimer(const LatencyTimer&) = delete;
+    LatencyTimer& operator=(const LatencyTimer&) = delete;
+
+private:
+    static bool sampled()
+    {
+        thread_local uint32_t counter = 0;
+        return (counter++ & ((1u << kSampleShift) - 1)) == 0;
+    }
+
+    LatencyHistogram* histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+/*
+ * CacheMetrics 指标登记表
+ * 每个缓存（分片）登记一个CacheStats，render()按Prometheus文本格式（0.0.4）输出全部指标，
+ * 标签为cache="名称"，分片缓存另带shard="分片号"。登记表自身有一把锁，只保护登记列表，
+ * 输出时不接触任何缓存的锁。CacheStats以shared_ptr共享，缓存先于登记表析构也不会悬空。
+ */
+class CacheMetrics
+{
+public:
+    // 登记一个缓存的统计；shard < 0 表示不分片
+    std::shared_ptr<CacheStats> addStats(const std::string& cache, int shard = -1, size_t capacity = 0)
+    {
+        auto stats = std::make_shared<CacheStats>();
+        stats->capacity.store(capacity, std::memory_order_relaxed);
+        std::string labels = "cache=\"" + escape(cache) + "\"";
+        if (shard >= 0)
+        {
+            labels += ",shard=\"" + std::to_string(shard) + "\"";
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.push_back(StatsEntry{std::move(labels), stats});
+        return stats;
+    }
+
+    // 登记一个缓存的未命中率曲线估计，输出容量从2^sampleShift到maxSize的各个2的幂
+    std::shared_ptr<MissRatioEstimator> addEstimator(const std::string& cache, size_t maxSize,
+                                                     unsigned sampleShift = 6, size_t maxTracked = 1 << 16)
+    {
+        auto estimator = std::make_shared<MissRatioEstimator>(sampleShift, maxTracked);
+        std::lock_guard<std::mutex> lock(mutex_);
+        estimators_.push_back(EstimatorEntry{"cache=\"" + escape(cache) + "\"", estimator, maxSize});
+        return estimator;
+    }
+
+    std::string render() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::string out;
+        out.reserve(4096 + stats_.size() * 2048);
+        counterFamily(out, "xrms_cache_hits_total", "Cache lookups that found the key.", &CacheStats::hits);
+        counterFamily(out, "xrms_cache_misses_total", "Cache lookups that did not find the key.", &CacheStats::misses);
+        counterFamily(out, "xrms_cache_inserts_total", "New keys written into the cache.", &CacheStats::inserts);
+        counterFamily(out, "xrms_cache_evictions_total", "Entries evicted to make room.", &CacheStats::evictions);
+        counterFamily(out, "xrms_cache_ghost_hits_total", "Lookups found in an ARC ghost list.", &CacheStats::ghostHits);
+        counterFamily(out, "xrms_cache_lock_contended_total", "Lock acquisitions that had to wait.",
+                      &CacheStats::lockContended);
+        gaugeFamily(out, "xrms_cache_entries", "Entries currently cached.", &CacheStats::entries);
+        gaugeFamily(out, "xrms_cache_capacity", "Configured capacity in entries.", &CacheStats::capacity);
+        histogramFamily(out, "xrms_cache_get_latency_seconds", "Latency of get, including lock wait.",
+                        &CacheStats::getLatency);
+        histogramFamily(out, "xrms_cache_put_latency_seconds", "Latency of put, including lock wait.",
+                        &CacheStats::putLatency);
+        mrcFamily(out);
+        return out;
+    }
+
+private:
+    struct StatsEntry
+    {
+        std::string labels;
+        std::shared_ptr<CacheStats> stats;
+    };
+
+    struct EstimatorEntry
+    {
+        std::string labels;
+        std::shared_ptr<MissRatioEstimator> estimator;
+        size_t maxSize;
+    };
+
+    static std::string escape(const std::string& value)
+    {
+        std::string out;
+        for (char c : value)
+        {
+            if (c == '\\' || c == '"')
+            {
+                out += '\\';
+                out += c;
+            }
+            else if (c == '\n')
+            {
+                out += "\\n";
+            }
+            else
+            {
+                out += c;
+            }
+        }
+        return out;
+    }
+
+    static void header(std::string& out, const char* name, const char* help, const char* type)
+    {
+        out += "# HELP ";
+        out += name;
+        out += ' ';
+        out += help;
+        out += "\n# TYPE ";
+        out += name;
+        out += ' ';
+        out += type;
+        out += '\n';
+    }
+
+    static void sample(std::string& out, const char* name, const char* suffix, const std::string& labels, double value)
+    {
+        char number[32];
+        std::snprintf(number, sizeof(number), "%.17g", value);
+        out += name;
+        out += suffix;
+        out += '{';
+        out += labels;
+        out += "} ";
+        out += number;
+        out += '\n';
+    }
+
+    static void sample(std::string& out, const char* name, const char* suffix, const std::string& labels, uint64_t value)
+    {
+        out += name;
+        out += suffix;
+        out += '{';
+        out += labels;
+        out += "} ";
+        out += std::to_string(value);
+        out += '\n';
+    }
+
+    void counterFamily(std::string& out, const char* name, const char* help,
+                       std::atomic<uint64_t> CacheStats::*field) const
+    {
+        header(out, name, help, "counter");
+        for (const StatsEntry& entry : stats_)
+        {
+            sample(out, name, "", entry.labels, ((*entry.stats).*field).load(std::memory_order_relaxed));
+        }
+    }
+
+    void gaugeFamily(std::string& out, const char* name, const char* help,
+                     std::atomic<uint64_t> CacheStats::*field) const
+    {
+        header(out, name, help, "gauge");
+        for (const StatsEntry& entry : stats_)
+        {
+            sample(out, name, "", entry.labels, ((*entry.stats).*field).load(std::memory_order_relaxed));
+        }
+    }
+
+    // 直方图的桶是累计的，_count取最后的+Inf桶，保证与各桶一致
+    void histogramFamily(std::string& out, const char* name, const char* help,
+                         LatencyHistogram CacheStats::*field) const
+    {
+        header(out, name, help, "histogram");
+        for (const StatsEntry& entry : stats_)
+        {
+            const LatencyHistogram& histogram = (*entry.stats).*field;
+            uint64_t cumulative = 0;
+            for (size_t b = 0; b <= LatencyHistogram::kBuckets; ++b)
+            {
+                cumulative += histogram.bucketCount(b);
+                std::string le = b < LatencyHistogram::kBuckets
+                    ? formatSeconds(LatencyHistogram::upperBoundNs(b)) : std::string("+Inf");
+                sample(out, name, "_bucket", entry.labels + ",le=\"" + le + "\"", cumulative);
+            }
+            sample(out, name, "_sum", entry.labels, histogram.sumNs() / 1e9);
+            sample(out, name, "_count", entry.labels, cumulative);
+        }
+    }
+
+    void mrcFamily(std::string& out) const
+    {
+        header(out, "xrms_cache_mrc_miss_ratio", "Estimated LRU miss ratio at the given capacity.", "gauge");
+        for (const EstimatorEntry& entry : estimators_)
+        {
+            for (size_t k = entry.estimator->sampleShift(); k < MissRatioEstimator::kDistanceBuckets; ++k)
+            {
+                size_t size = size_t(1) << k;
+                double ratio = entry.estimator->missRatio(k);
+                if (ratio >= 0)
+                {
+                    sample(out, "xrms_cache_mrc_miss_ratio", "",
+                           entry.labels + ",size=\"" + std::to_string(size) + "\"", ratio);
+                }
+                if (size >= entry.maxSize)
+                {
+                    break;
+                }
+            }
+        }
+    }
+
+    static std::string formatSeconds(uint64_t ns)
+    {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.9g", ns / 1e9);
+        return text;
+    }
+
+    mutable std::mutex mutex_;
+    std::vector<StatsEntry> stats_;
+    std::vector<EstimatorEntry> estimators_;
+};
+
+}   // namespace XrmsCache
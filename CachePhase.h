@@ -0,0 +1,266 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/*
+ * 缓存操作的分阶段周期统计
+ * 编译时定义XRMS_CACHE_PHASE_TIMING后，各缓存在索引查找、链表/频次调整、选出淘汰对象、
+ * 索引删除、索引插入、节点分配和value拷贝处用时间戳计数器（x86上为rdtsc）计时，
+ * 按线程累加，由CachePhaseTiming::dump输出各阶段的次数、周期数和占比。
+ * 未定义时XRMS_CACHE_PHASE(phase, expr)就是(expr)本身，不产生任何额外代码。
+ * rdtsc不是串行化指令，每次计时本身约有几十个周期的开销，适合比较各阶段的相对比例和前后变化，
+ * 不适合看单个很短阶段的绝对值。
+ */
+
+namespace XrmsCache
+{
+
+// 缓存操作内部的阶段
+enum class CachePhase
+{
+    Lookup,         // 索引查找
+    Promote,        // 命中或插入后在链表、频次结构中调整位置
+    Victim,         // 选出淘汰对象并从链表、频次结构中摘下
+    IndexErase,     // 从索引中删除
+    IndexInsert,    // 插入索引
+    Alloc,          // 节点的创建和归还
+    ValueCopy,      // value的拷贝
+    Count
+};
+
+namespace CachePhaseTiming
+{
+
+#if defined(XRMS_CACHE_PHASE_TIMING)
+constexpr bool kEnabled = true;
+#else
+constexpr bool kEnabled = false;
+#endif
+
+constexpr size_t kPhaseCount = static_cast<size_t>(CachePhase::Count);
+
+inline const char* phaseName(size_t phase)
+{
+    static const char* const names[kPhaseCount] = {
+        "lookup", "promote", "victim", "index-erase", "index-insert", "alloc", "value-copy"
+    };
+    return phase < kPhaseCount ? names[phase] : "?";
+}
+
+// 读时间戳计数器；x86以外的平台退化为steady_clock的纳秒数
+inline uint64_t ticks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// 各阶段的累计周期数和次数
+struct PhaseTotals
+{
+    uint64_t cycles[kPhaseCount] = {};
+    uint64_t count[kPhaseCount] = {};
+};
+
+// 每个线程一份的累加表：只有所属线程写，汇总时其他线程可以并发读
+struct ThreadPhaseTable
+{
+    std::atomic<uint64_t> cycles[kPhaseCount];
+    std::atomic<uint64_t> count[kPhaseCount];
+
+    ThreadPhaseTable()
+    {
+        clear();
+    }
+
+    void add(size_t phase, uint64_t elapsed)
+    {
+        // 单一写者，读出再写回即可，不需要原子加
+        cycles[phase].store(cycles[phase].load(std::memory_order_relaxed) + elapsed, std::memory_order_relaxed);
+        count[phase].store(count[phase].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void addTo(PhaseTotals& totals) const
+    {
+        for (size_t i = 0; i < kPhaseCount; ++i)
+        {
+            totals.cycles[i] += cycles[i].load(std::memory_order_relaxed);
+            totals.count[i] += count[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    void clear()
+    {
+        for (size_t i = 0; i < kPhaseCount; ++i)
+        {
+            cycles[i].store(0, std::memory_order_relaxed);
+            count[i].store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+// 登记所有线程的累加表；线程退出时它的数据并入retired_，汇总时不会丢失
+class PhaseRegistry
+{
+public:
+    static PhaseRegistry& instance()
+    {
+        static PhaseRegistry registry;
+        return registry;
+    }
+
+    void attach(ThreadPhaseTable* table)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        live_.push_back(table);
+    }
+
+    void detach(ThreadPhaseTable* table)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        table->addTo(retired_);
+        live_.erase(std::remove(live_.begin(), live_.end(), table), live_.end());
+    }
+
+    PhaseTotals snapshot()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        PhaseTotals totals = retired_;
+        for (ThreadPhaseTable* table : live_)
+        {
+            table->addTo(totals);
+        }
+        return totals;
+    }
+
+    // 清零；与正在计时的线程并发调用时，那几次计时可能不被清掉
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        retired_ = PhaseTotals();
+        for (ThreadPhaseTable* table : live_)
+        {
+            table->clear();
+        }
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<ThreadPhaseTable*> live_;   // 仍在运行的线程的累加表
+    PhaseTotals retired_;                   // 已退出线程的累计
+};
+
+// 线程第一次计时时登记自己的累加表，线程退出时注销
+struct ThreadPhaseSlot
+{
+    ThreadPhaseTable table;
+
+    ThreadPhaseSlot()
+    {
+        PhaseRegistry::instance().attach(&table);
+    }
+
+    ~ThreadPhaseSlot()
+    {
+        PhaseRegistry::instance().detach(&table);
+    }
+};
+
+inline void record(CachePhase phase, uint64_t elapsed)
+{
+    thread_local ThreadPhaseSlot slot;
+    slot.table.add(static_cast<size_t>(phase), elapsed);
+}
+
+// 作用域计时：构造时读一次计数器，析构时把差值记入当前线程
+class PhaseScope
+{
+public:
+    explicit PhaseScope(CachePhase phase)
+        : phase_(phase)
+        , start_(ticks())
+    {}
+
+    ~PhaseScope()
+    {
+        record(phase_, ticks() - start_);
+    }
+
+    PhaseScope(const PhaseScope&) = delete;
+    PhaseScope& operator=(const PhaseScope&) = delete;
+
+private:
+    CachePhase phase_;
+    uint64_t start_;
+};
+
+inline PhaseTotals snapshot()
+{
+    return PhaseRegistry::instance().snapshot();
+}
+
+inline void reset()
+{
+    PhaseRegistry::instance().reset();
+}
+
+// 输出各阶段的次数、总周期、平均周期和占全部计时周期的比例
+inline void dump(std::ostream& out, const PhaseTotals& totals)
+{
+    if (!kEnabled)
+    {
+        out << "阶段计时未开启（编译时定义XRMS_CACHE_PHASE_TIMING）" << std::endl;
+        return;
+    }
+    uint64_t all = 0;
+    for (size_t i = 0; i < kPhaseCount; ++i)
+    {
+        all += totals.cycles[i];
+    }
+    out << std::left << std::setw(14) << "phase" << std::right << std::setw(12) << "count"
+        << std::setw(16) << "cycles" << std::setw(12) << "cyc/op" << std::setw(10) << "share" << std::endl;
+    for (size_t i = 0; i < kPhaseCount; ++i)
+    {
+        double perOp = totals.count[i] == 0 ? 0.0 : static_cast<double>(totals.cycles[i]) / totals.count[i];
+        double share = all == 0 ? 0.0 : 100.0 * totals.cycles[i] / all;
+        out << std::left << std::setw(14) << phaseName(i) << std::right << std::setw(12) << totals.count[i]
+            << std::setw(16) << totals.cycles[i] << std::fixed << std::setprecision(1)
+            << std::setw(12) << perOp << std::setw(9) << share << "%" << std::endl;
+    }
+}
+
+inline void dump(std::ostream& out)
+{
+    dump(out, snapshot());
+}
+
+}   // namespace CachePhaseTiming
+
+}   // namespace XrmsCache
+
+// 计时一个表达式并返回它的值：XRMS_CACHE_PHASE(Lookup, nodeMap_.find(key))
+// 未开启时展开为表达式本身
+#if defined(XRMS_CACHE_PHASE_TIMING)
+#define XRMS_CACHE_PHASE(phase, ...)                                                            \
+    ([&]() -> decltype(auto) {                                                                  \
+        ::XrmsCache::CachePhaseTiming::PhaseScope xrmsPhaseScope(::XrmsCache::CachePhase::phase); \
+        return __VA_ARGS__;                                                                     \
+    }())
+#else
+#define XRMS_CACHE_PHASE(phase, ...) (__VA_ARGS__)
+#endif
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+/*
+ * USDT静态探针（provider为xrms_cache），供bpftrace/perf在线追踪，不需要重新编译
+ * 有<sys/sdt.h>（systemtap-sdt-dev）时，每个探针在代码中只是一条nop，参数只是现成的指针和整数，
+ * 未挂载时几乎没有开销；没有该头文件或定义了XRMS_CACHE_NO_PROBES时，探针宏为空。
+ *
+ * 探针及参数（cache为缓存或分片对象的地址，分片缓存的各分片各自触发，用它区分分片）：
+ *   hit(cache, keyData, keySize)           命中
+ *   miss(cache, keyData, keySize)          未命中
+ *   insert(cache, keyData, keySize)        插入新key
+ *   evict(cache, keyData, keySize, reason) 淘汰，reason见CacheProbe::EvictReason
+ *   ghost_hit(cache, keyData, keySize, part)  ARC幽灵命中，part为0(LRU部分)或1(LFU部分)
+ *   aging(cache, entries, average)         LFU频次老化，遍历entries个节点
+ *   lock_contended(cache)                  加锁时锁已被占用
+ * keyData/keySize：字符串key为字符内容和长度，其余类型为key对象本身的地址和大小，
+ * 例如 bpftrace -e 'usdt:./main:xrms_cache:evict { @[arg3] = count(); }'
+ */
+
+#if !defined(XRMS_CACHE_NO_PROBES) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define XRMS_CACHE_HAVE_PROBES 1
+#endif
+#endif
+
+#if defined(XRMS_CACHE_HAVE_PROBES)
+#define XRMS_CACHE_PROBE1(name, a) DTRACE_PROBE1(xrms_cache, name, a)
+#define XRMS_CACHE_PROBE3(name, a, b, c) DTRACE_PROBE3(xrms_cache, name, a, b, c)
+#define XRMS_CACHE_PROBE4(name, a, b, c, d) DTRACE_PROBE4(xrms_cache, name, a, b, c, d)
+#else
+// 探针不可用时仍对参数求值（都是无副作用的取地址和取长度，会被优化掉），避免只传给探针的参数出现未使用告警
+#define XRMS_CACHE_PROBE1(name, a) ((void)(a))
+#define XRMS_CACHE_PROBE3(name, a, b, c) ((void)(a), (void)(b), (void)(c))
+#define XRMS_CACHE_PROBE4(name, a, b, c, d) ((void)(a), (void)(b), (void)(c), (void)(d))
+#endif
+
+// 带key的探针：cache为缓存对象地址，key按keyData/keySize展开
+#define XRMS_CACHE_PROBE_KEY(name, cache, key) \
+    XRMS_CACHE_PROBE3(name, static_cast<const void*>(cache), \
+                      ::XrmsCache::CacheProbe::keyData(key), ::XrmsCache::CacheProbe::keySize(key))
+#define XRMS_CACHE_PROBE_EVICT(cache, key, reason) \
+    XRMS_CACHE_PROBE4(evict, static_cast<const void*>(cache), \
+                      ::XrmsCache::CacheProbe::keyData(key), ::XrmsCache::CacheProbe::keySize(key), \
+                      static_cast<int>(reason))
+
+namespace XrmsCache
+{
+
+namespace CacheProbe
+{
+
+constexpr bool kEnabled =
+#if defined(XRMS_CACHE_HAVE_PROBES)
+    true;
+#else
+    false;
+#endif
+
+// evict探针的reason参数
+enum class EvictReason
+{
+    Capacity = 1,       // 写入时缓存已满
+    Background = 2,     // 后台维护线程按水位淘汰
+    Adapt = 3,          // ARC调整两部分容量时腾出位置
+};
+
+template<typename Key>
+inline const void* keyData(const Key& key)
+{
+    if constexpr (std::is_same<Key, std::string>::value || std::is_same<Key, std::string_view>::value)
+    {
+        return key.data();
+    }
+    else
+    {
+        return &key;
+    }
+}
+
+template<typename Key>
+inline size_t keySize(const Key& key)
+{
+    if constexpr (std::is_same<Key, std::string>::value || std::is_same<Key, std::string_view>::value)
+    {
+        return key.size();
+    }
+    else
+    {
+        return sizeof(Key);
+    }
+}
+
+// 加锁：探针可用或传入了计数器时先try_lock，失败则触发lock_contended、计数，再阻塞等待；
+// 否则就是普通的加锁
+inline std::unique_lock<std::mutex> lock(std::mutex& mutex, const void* cache,
+                                         std::atomic<uint64_t>* contended = nullptr)
+{
+    if (!kEnabled && !contended)
+    {
+        return std::unique_lock<std::mutex>(mutex);
+    }
+    std::unique_lock<std::mutex> guard(mutex, std::try_to_lock);
+    if (!guard.owns_lock())
+    {
+        XRMS_CACHE_PROBE1(lock_contended, cache);
+        if (contended)
+        {
+            contended->fetch_add(1, std::memory_order_relaxed);
+        }
+        guard.lock();
+    }
+    (void)cache;
+    return guard;
+}
+
+}   // namespace CacheProbe
+
+}   // namespace XrmsCache
@@ -0,0 +1,408 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "CacheHash.h"
+#include "CacheMemory.h"
+#include "CacheProbe.h"
+#include "ICachePolicy.h"
+#include "LruCache.h"
+
+// 可平凡拷贝的key/value使用的紧凑LRU
+namespace XrmsCache
+{
+
+/*
+ * FlatLruCache 面向整数、定长结构体等可平凡拷贝类型的LRU
+ * 不再为每个条目建节点：key、value、前后链接、索引位置各自存放在按条目下标访问的连续数组中（SoA），
+ * 条目的写入和移动都是按字节拷贝，没有逐条目的构造和析构。
+ * 索引是开放寻址表，每个位置1字节控制字节（空/已删除/哈希值低7位）加4字节条目下标，
+ * 查找时一次比较16个控制字节（SSE2），只有低7位相同的位置才去比较key。
+ *
+ * 以<int,int>为例，每个条目约27字节，LruNode加索引约100字节。
+ * 容量在构造时确定，不支持写回、后台维护等LruCache的扩展功能；需要这些功能时用LruCache。
+ * 数组和索引表从resource分配，为空时使用malloc；条目很多时可传CacheMemory::hugePages()用大页承载。
+ */
+template<typename Key, typename Value, typename Hasher = CacheHash<Key>>
+class FlatLruCache : public ICachePolicy<Key, Value>
+{
+    static_assert(std::is_trivially_copyable<Key>::value, "FlatLruCache requires a trivially copyable Key");
+    static_assert(std::is_trivially_copyable<Value>::value, "FlatLruCache requires a trivially copyable Value");
+
+public:
+    explicit FlatLruCache(int capacity, std::pmr::memory_resource* resource = nullptr)
+        : capacity_(static_cast<uint32_t>(capacity > 0 ? capacity : 0))
+        , resource_(resource)
+    {
+        if (capacity_ == 0)
+        {
+            return;
+        }
+        keys_ = allocate<Key>(capacity_);
+        values_ = allocate<Value>(capacity_);
+        prev_ = allocate<uint32_t>(capacity_);
+        next_ = allocate<uint32_t>(capacity_);
+        pos_ = allocate<uint32_t>(capacity_);
+
+        // 负载不超过7/8，且至少一组
+        size_t positions = kGroupSize;
+        while (positions * 7 / 8 < capacity_)
+        {
+            positions <<= 1;
+        }
+        groupMask_ = positions / kGroupSize - 1;
+        ctrl_ = allocate<uint8_t>(positions);
+        slots_ = allocate<uint32_t>(positions);
+        std::memset(ctrl_, kEmpty, positions);
+    }
+
+    ~FlatLruCache() override
+    {
+        size_t positions = capacity_ == 0 ? 0 : (groupMask_ + 1) * kGroupSize;
+        deallocate(keys_, capacity_);
+        deallocate(values_, capacity_);
+        deallocate(prev_, capacity_);
+        deallocate(next_, capacity_);
+        deallocate(pos_, capacity_);
+        deallocate(ctrl_, positions);
+        deallocate(slots_, positions);
+    }
+
+    FlatLruCache(const FlatLruCache&) = delete;
+    FlatLruCache& operator=(const FlatLruCache&) = delete;
+
+    static size_t hashOf(const Key& key)
+    {
+        return Hasher()(key);
+    }
+
+    void put(Key key, Value value) override
+    {
+        if (capacity_ == 0)
+        {
+            return;
+        }
+        size_t hash = hashOf(key);
+        std::unique_lock<std::mutex> lock = CacheProbe::lock(mutex_, this);
+        uint32_t index = find(key, hash);
+        if (index != NIL)
+        {
+            std::memcpy(&values_[index], &value, sizeof(Value));
+            moveToMostRecent(index);
+            return;
+        }
+
+        XRMS_CACHE_PROBE_KEY(insert, this, key);
+        if (size_ == capacity_)
+        {
+            // 直接复用最久未使用条目的下标
+            index = tail_;
+            XRMS_CACHE_PROBE_EVICT(this, keys_[index], CacheProbe::EvictReason::Capacity);
+            unlinkRecent(index);
+            eraseIndex(pos_[index]);
+            --size_;
+        }
+        else if (freeHead_ != NIL)
+        {
+            index = freeHead_;
+            freeHead_ = next_[index];
+        }
+        else
+        {
+            index = used_++;
+        }
+        std::memcpy(&keys_[index], &key, sizeof(Key));
+        std::memcpy(&values_[index], &value, sizeof(Value));
+        insertIndex(index, hash);
+        linkMostRecent(index);
+        ++size_;
+    }
+
+    bool get(Key key, Value& value) override
+    {
+        if (capacity_ == 0)
+        {
+            return false;
+        }
+        size_t hash = hashOf(key);
+        std::unique_lock<std::mutex> lock = CacheProbe::lock(mutex_, this);
+        uint32_t index = find(key, hash);
+        if (index == NIL)
+        {
+            XRMS_CACHE_PROBE_KEY(miss, this, key);
+            return false;
+        }
+        XRMS_CACHE_PROBE_KEY(hit, this, key);
+        std::memcpy(&value, &values_[index], sizeof(Value));
+        moveToMostRecent(index);
+        return true;
+    }
+
+    Value get(Key key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 删除指定元素
+    void remove(Key key)
+    {
+        if (capacity_ == 0)
+        {
+            return;
+        }
+        size_t hash = hashOf(key);
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint32_t index = find(key, hash);
+        if (index == NIL)
+        {
+            return;
+        }
+        unlinkRecent(index);
+        eraseIndex(pos_[index]);
+        next_[index] = freeHead_;
+        freeHead_ = index;
+        --size_;
+    }
+
+    // 清空缓存，数组保留
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (capacity_ == 0)
+        {
+            return;
+        }
+        std::memset(ctrl_, kEmpty, (groupMask_ + 1) * kGroupSize);
+        head_ = tail_ = freeHead_ = NIL;
+        size_ = used_ = deleted_ = 0;
+    }
+
+    size_t size()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return size_;
+    }
+
+    // 条目数组和索引占用的字节数
+    size_t memoryBytes() const
+    {
+        size_t positions = capacity_ == 0 ? 0 : (groupMask_ + 1) * kGroupSize;
+        return capacity_ * (sizeof(Key) + sizeof(Value) + 3 * sizeof(uint32_t))
+             + positions * (sizeof(uint8_t) + sizeof(uint32_t));
+    }
+
+private:
+    static constexpr uint32_t NIL = UINT32_MAX;
+    static constexpr size_t   kGroupSize = 16;
+    // 控制字节：最高位为1表示空或已删除，否则低7位是哈希值的低7位
+    static constexpr uint8_t  kEmpty = 0x80;
+    static constexpr uint8_t  kDeleted = 0xFE;
+
+    template<typename T>
+    T* allocate(size_t count)
+    {
+        return static_cast<T*>(CacheMemory::allocate(resource_, count * sizeof(T), alignof(T)));
+    }
+
+    template<typename T>
+    void deallocate(T* p, size_t count)
+    {
+        CacheMemory::deallocate(resource_, p, count * sizeof(T), alignof(T));
+    }
+
+    static uint8_t tagOf(size_t hash) { return static_cast<uint8_t>(hash & 0x7F); }
+    size_t groupOf(size_t hash) const { return (hash >> 7) & groupMask_; }
+
+    // 组内控制字节等于tag的位置，第i位对应组内第i个位置
+    uint32_t matchMask(size_t group, uint8_t tag) const
+    {
+        const uint8_t* ctrl = ctrl_ + group * kGroupSize;
+#if defined(__SSE2__)
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(static_cast<char>(tag)))));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < kGroupSize; ++i)
+        {
+            mask |= static_cast<uint32_t>(ctrl[i] == tag) << i;
+        }
+        return mask;
+#endif
+    }
+
+    // 组内空或已删除的位置（最高位为1）
+    uint32_t freeMask(size_t group) const
+    {
+        const uint8_t* ctrl = ctrl_ + group * kGroupSize;
+#if defined(__SSE2__)
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl))));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < kGroupSize; ++i)
+        {
+            mask |= static_cast<uint32_t>(ctrl[i] >> 7) << i;
+        }
+        return mask;
+#endif
+    }
+
+    // 查找按组线性探测，遇到含空位置的组即可停止
+    uint32_t find(const Key& key, size_t hash) const
+    {
+        uint8_t tag = tagOf(hash);
+        for (size_t group = groupOf(hash);; group = (group + 1) & groupMask_)
+        {
+            for (uint32_t mask = matchMask(group, tag); mask != 0; mask &= mask - 1)
+            {
+                uint32_t index = slots_[group * kGroupSize + __builtin_ctz(mask)];
+                if (keys_[index] == key)
+                {
+                    return index;
+                }
+            }
+            if (matchMask(group, kEmpty) != 0)
+            {
+                return NIL;
+            }
+        }
+    }
+
+    // 调用方已确认key不存在
+    void insertIndex(uint32_t index, size_t hash)
+    {
+        // 条目最多占7/8，删除标记不超过1/16，总有一组含空位置，查找一定能停下
+        if (deleted_ > (groupMask_ + 1) * kGroupSize / 16)
+        {
+            rebuildIndex();
+        }
+        size_t group = groupOf(hash);
+        uint32_t mask;
+        while ((mask = freeMask(group)) == 0)
+        {
+            group = (group + 1) & groupMask_;
+        }
+        size_t position = group * kGroupSize + __builtin_ctz(mask);
+        deleted_ -= ctrl_[position] == kDeleted;
+        ctrl_[position] = tagOf(hash);
+        slots_[position] = index;
+        pos_[index] = static_cast<uint32_t>(position);
+    }
+
+    // 所在组还有空位置时，没有查找会越过这一组，可以直接标空；否则留下删除标记
+    void eraseIndex(size_t position)
+    {
+        if (matchMask(position / kGroupSize, kEmpty) != 0)
+        {
+            ctrl_[position] = kEmpty;
+        }
+        else
+        {
+            ctrl_[position] = kDeleted;
+            ++deleted_;
+        }
+    }
+
+    // 删除标记过多时原地重建索引：条目数组不动，只重新计算各条目的位置
+    void rebuildIndex()
+    {
+        std::memset(ctrl_, kEmpty, (groupMask_ + 1) * kGroupSize);
+        deleted_ = 0;
+        for (uint32_t index = head_; index != NIL; index = next_[index])
+        {
+            size_t hash = hashOf(keys_[index]);
+            size_t group = groupOf(hash);
+            uint32_t mask;
+            while ((mask = freeMask(group)) == 0)
+            {
+                group = (group + 1) & groupMask_;
+            }
+            size_t position = group * kGroupSize + __builtin_ctz(mask);
+            ctrl_[position] = tagOf(hash);
+            slots_[position] = index;
+            pos_[index] = static_cast<uint32_t>(position);
+        }
+    }
+
+    void linkMostRecent(uint32_t index)
+    {
+        prev_[index] = NIL;
+        next_[index] = head_;
+        if (head_ != NIL)
+        {
+            prev_[head_] = index;
+        }
+        else
+        {
+            tail_ = index;
+        }
+        head_ = index;
+    }
+
+    void unlinkRecent(uint32_t index)
+    {
+        uint32_t prev = prev_[index];
+        uint32_t next = next_[index];
+        if (prev != NIL)
+        {
+            next_[prev] = next;
+        }
+        else
+        {
+            head_ = next;
+        }
+        if (next != NIL)
+        {
+            prev_[next] = prev;
+        }
+        else
+        {
+            tail_ = prev;
+        }
+    }
+
+    void moveToMostRecent(uint32_t index)
+    {
+        if (index != head_)
+        {
+            unlinkRecent(index);
+            linkMostRecent(index);
+        }
+    }
+
+private:
+    uint32_t    capacity_;
+    uint32_t    size_ = 0;
+    uint32_t    used_ = 0;          // 从未使用过的下标从这里开始
+    uint32_t    freeHead_ = NIL;    // remove释放的下标，经next_串成链表
+    uint32_t    head_ = NIL;        // 最近使用
+    uint32_t    tail_ = NIL;        // 最久未使用
+    size_t      deleted_ = 0;       // 索引中的删除标记数
+    size_t      groupMask_ = 0;
+    std::mutex  mutex_;
+    std::pmr::memory_resource* resource_;
+
+    Key*        keys_ = nullptr;
+    Value*      values_ = nullptr;
+    uint32_t*   prev_ = nullptr;
+    uint32_t*   next_ = nullptr;
+    uint32_t*   pos_ = nullptr;     // 条目在索引中的位置，淘汰时不必重新查找
+    uint8_t*    ctrl_ = nullptr;    // 索引控制字节
+    uint32_t*   slots_ = nullptr;   // 索引位置对应的条目下标
+};
+
+// key和value都可平凡拷贝时选FlatLruCache，否则选LruCache
+template<typename Key, typename Value, typename Hasher = CacheHash<Key>>
+using LruCacheFor = std::conditional_t<std::is_trivially_copyable<Key>::value && std::is_trivially_copyable<Value>::value,
+                                       FlatLruCache<Key, Value, Hasher>, LruCache<Key, Value, Hasher>>;
+
+} // namespace XrmsCache
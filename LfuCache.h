@@ -1,12 +1,26 @@
 #pragma once
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <iterator>
 #include <memory>
+#include <memory_resource>
 #include <mutex>
+#include <string>
 #include <thread>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
+#include "CacheArena.h"
+#include "CacheBatch.h"
+#include "CacheHash.h"
+#include "CacheMaintainer.h"
+#include "CacheMemory.h"
+#include "CacheMetrics.h"
+#include "CachePhase.h"
+#include "CacheProbe.h"
 #include "ICachePolicy.h"
 /*在LFU算法之上，引入访问次数平均值概念，
  *当平均值大于最大平均值限制时将所有结点的访问次数减去最大平均值限制的一半或者一个固定值。
@@ -15,7 +29,7 @@
 namespace XrmsCache
 {
 // 最近最少使用算法
-template<typename Key, typename Value> class LfuCache;
+template<typename Key, typename Value, typename Hasher = CacheHash<Key>> class LfuCache;
 
 // 用于记录节点访问次数的链表
 /*
@@ -32,8 +46,8 @@ private:
         int freq; // 访问频次
         Key key;
         Value value;
-        std::shared_ptr<Node> prev; // 上一节点
-        std::shared_ptr<Node> next;// 下一节点
+        Node* prev; // 上一节点
+        Node* next; // 下一节点（节点由LfuCache的内存池统一管理）
 
         // 无参构造
         Node()
@@ -43,21 +57,33 @@ private:
         : freq(1), key(key), value(value), prev(nullptr), next(nullptr) {}
     };
 
-    using NodePtr = std::shared_ptr<Node>;
+    using NodePtr = Node*;
     int freq_; // 访问频率
     NodePtr head_; // 哨兵头节点
     NodePtr tail_; // 哨兵尾节点
+    std::pmr::memory_resource* resource_;  // 哨兵节点的内存来源，与所属LfuCache相同
 
 public:
-    explicit FreqList(int n)
+    explicit FreqList(int n, std::pmr::memory_resource* resource = nullptr)
         : freq_(n)
+        , resource_(resource)
     {
-        head_ = std::make_shared<Node>();
-        tail_ = std::make_shared<Node>();
+        head_ = newSentinel();
+        tail_ = newSentinel();
         head_->next = tail_;
         tail_->prev = head_;
     }
 
+    // 只释放哨兵，链表中的有效节点归LfuCache的内存池管理
+    ~FreqList()
+    {
+        deleteSentinel(head_);
+        deleteSentinel(tail_);
+    }
+
+    FreqList(const FreqList&) = delete;
+    FreqList& operator=(const FreqList&) = delete;
+
     // 判空
     bool isEmpty() const
     {
@@ -79,6 +105,20 @@ public:
         tail_->prev = node;
     }
 
+    // 头插法：插到最早被淘汰的位置（仅倒序批量加载使用）
+    void addNodeToFront(NodePtr node)
+    {
+        if (!node || !head_ || !tail_)
+        {
+            return;
+        }
+
+        node->prev = head_;
+        node->next = head_->next;
+        head_->next->prev = node;
+        head_->next = node;
+    }
+
 // 删除节点
 void removeNode(NodePtr node)
 {
@@ -101,58 +141,123 @@ void removeNode(NodePtr node)
     // 取链表中的第一个有效节点
     NodePtr getFirstNode() const {return head_->next;}
 
+private:
+    NodePtr newSentinel()
+    {
+        return ::new (CacheMemory::allocate(resource_, sizeof(Node), alignof(Node))) Node();
+    }
+
+    void deleteSentinel(NodePtr node)
+    {
+        node->~Node();
+        CacheMemory::deallocate(resource_, node, sizeof(Node), alignof(Node));
+    }
+
+public:
+
     // 
-    friend class LfuCache<Key, Value>;
+    template<typename K, typename V, typename H> friend class LfuCache;
     //friend class KArcCache<Key, Value>;
 };
 
-// 实现了基本的LFU缓存策略
-template <typename Key, typename Value>
+// 实现了基本的LFU缓存策略，Hasher为key的哈希函数（默认CacheHash）
+template<typename Key, typename Value, typename Hasher>
 class LfuCache : public ICachePolicy<Key, Value>
 {
 public:
     using Node = typename FreqList<Key, Value>::Node;
-    using NodePtr = std::shared_ptr<Node>;
-    using NodeMap = std::unordered_map<Key, NodePtr>;
+    using NodePtr = Node*;  // 节点内存归nodeArena_所有
+    using NodeMap = std::unordered_map<Key, NodePtr, Hasher, std::equal_to<Key>,
+                                       std::pmr::polymorphic_allocator<std::pair<const Key, NodePtr>>>;
+    using FreqListMap = std::unordered_map<int, FreqList<Key, Value>*, std::hash<int>, std::equal_to<int>,
+                                           std::pmr::polymorphic_allocator<std::pair<const int, FreqList<Key, Value>*>>>;
+    using BatchOp = CacheBatchOp<Key, Value>;
 
-    // 最大平均值=10
-    LfuCache(int capacity, int maxAverageNum = 10)
+    // 最大平均值=10；resource为节点、索引和频次链表的内存来源，为空时用malloc（见CacheMemory）
+    LfuCache(int capacity, int maxAverageNum = 10, std::pmr::memory_resource* resource = nullptr)
     : capacity_(capacity), minFreq_(INT8_MAX), maxAverageNum_(maxAverageNum),
-      curAverageNum_(0), curTotalNum_(0)
-    {}
+      curAverageNum_(0), curTotalNum_(0),
+      indexMemory_(std::make_shared<CacheMemory::CountingResource>(resource)),
+      frequencyMemory_(std::make_shared<CacheMemory::CountingResource>(resource)),
+      nodeMap_(typename NodeMap::allocator_type(indexMemory_.get())),
+      freqToFreqList_(typename FreqListMap::allocator_type(frequencyMemory_.get())),
+      nodeArena_(std::clamp(capacity, 1, 65536), resource),
+      customResource_(resource != nullptr)
+    {
+        // 容量固定，索引一次分配到位，填充过程中不会触发整表重新散列
+        if (capacity_ > 0)
+        {
+            nodeMap_.reserve(capacity_);
+        }
+    }
 
-    ~LfuCache() override = default;
+    ~LfuCache() override
+    {
+        setMaintainer(nullptr, 0, 0);
+        releaseNodes();
+    }
 
     void put(Key key, Value value) override
     {
         if (capacity_ == 0)
         return;
 
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = nodeMap_.find(key);
-        if (it != nodeMap_.end())
+        bool needMaintenance = false;
+        CacheStats* stats = stats_.get();
+        LatencyTimer timer(stats ? &stats->putLatency : nullptr);
         {
-            // 找到后重置其value值
-            it->second->value = value;
-            // 找到后直接调整即可，无需去get中再找一遍
-            getInternal(it->second, value);
-            return;
+            std::unique_lock<std::mutex> lock = CacheProbe::lock(mutex_, this, stats ? &stats->lockContended : nullptr);
+            auto it = XRMS_CACHE_PHASE(Lookup, nodeMap_.find(key));
+            if (it != nodeMap_.end())
+            {
+                // 找到后重置其value值
+                XRMS_CACHE_PHASE(ValueCopy, it->second->value = value);
+                // 找到后直接调整即可，无需去get中再找一遍
+                getInternal(it->second, value);
+                return;
+            }
+
+            putInternal(key, value);
+            needMaintenance = requestMaintenance();
+            if (stats)
+            {
+                CacheStats::bump(stats->inserts);
+                stats->setEntries(nodeMap_.size());
+            }
+        }
+        if (needMaintenance)
+        {
+            maintainer_->wakeup(maintainerTask_);
         }
-        
-        putInternal(key, value);
     }
 
     // value值为传出参数
     bool get(Key key, Value &value) override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = nodeMap_.find(key);
+        CacheStats* stats = stats_.get();
+        LatencyTimer timer(stats ? &stats->getLatency : nullptr);
+        if (stats && stats->mrc)
+        {
+            stats->access(Hasher()(key));
+        }
+        std::unique_lock<std::mutex> lock = CacheProbe::lock(mutex_, this, stats ? &stats->lockContended : nullptr);
+        auto it = XRMS_CACHE_PHASE(Lookup, nodeMap_.find(key));
         if (it != nodeMap_.end())
         {
+            XRMS_CACHE_PROBE_KEY(hit, this, key);
+            if (stats)
+            {
+                CacheStats::bump(stats->hits);
+            }
             getInternal(it->second, value);
             return true;
         }
 
+        XRMS_CACHE_PROBE_KEY(miss, this, key);
+        if (stats)
+        {
+            CacheStats::bump(stats->misses);
+        }
         return false;
     }
 
@@ -163,18 +268,137 @@ public:
         return value;
     }
 
-    // 清空缓存，回收资源
+    // 当前条目数
+    size_t size()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return nodeMap_.size();
+    }
+
+    // 删除指定元素
+    void remove(Key key)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = nodeMap_.find(key);
+        if (it != nodeMap_.end())
+        {
+            removeInternal(it);
+            if (stats_)
+            {
+                stats_->setEntries(nodeMap_.size());
+            }
+        }
+    }
+
+    // 在一次加锁内按顺序执行一批操作，分片缓存按分片分组后调用
+    void applyBatch(BatchOp* const* ops, size_t count);
+
+    // 清空缓存，回收资源：节点内存整块归还，只有Key/Value需要析构时才逐个调用析构函数
     void purge()
     {
-        nodeMap_.clear();
-        freqToFreqList_.clear();
+        std::lock_guard<std::mutex> lock(mutex_);
+        releaseNodes();
+        if (stats_)
+        {
+            stats_->setEntries(0);
+        }
+    }
+
+    // 开启后，清空和析构时把节点的析构与内存释放交给后台分离线程，调用方立即返回
+    // 释放线程可能在缓存析构之后才结束，需要确认内存已归还时调用waitBackgroundRelease()
+    // 传入了resource时它必须线程安全并存活到waitBackgroundRelease()返回，调用方以resourceThreadSafe=true确认，
+    // 否则不开启并返回false
+    bool setBackgroundRelease(bool enable, bool resourceThreadSafe = false)
+    {
+        if (enable && customResource_ && !resourceThreadSafe)
+        {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        backgroundRelease_ = enable;
+        return true;
+    }
+
+    // 内存占用：索引和频次链表按计数的resource统计，节点内存池按已申请的内存计，
+    // values遍历全部条目由权重函数累加
+    CacheMemoryUsage memoryUsage()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        CacheMemoryUsage usage;
+        usage.entries = nodeMap_.size();
+        usage.index = indexMemory_->bytes();
+        usage.nodes = nodeArena_.memoryBytes();
+        usage.frequency = frequencyMemory_->bytes();
+        for (const auto& pair : nodeMap_)
+        {
+            usage.values += CacheMemory::weigh(weigher_, pair.second->key, pair.second->value);
+        }
+        return usage;
+    }
+
+    // 设置memoryUsage()统计values使用的权重函数
+    void setWeigher(CacheWeigher<Key, Value> weigher)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        weigher_ = std::move(weigher);
+    }
+
+    // 挂上运行指标（见CacheMetrics.h），为空则停止统计；需在并发访问开始之前设置
+    void setStats(std::shared_ptr<CacheStats> stats)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_ = std::move(stats);
+        if (stats_)
+        {
+            stats_->capacity.store(static_cast<size_t>(std::max(capacity_, 0)), std::memory_order_relaxed);
+            stats_->setEntries(nodeMap_.size());
+        }
+    }
+
+    // 交给后台维护线程：条目数超过高水位时由维护线程淘汰到低水位，频次老化也移到维护线程执行，
+    // 前台put只在达到容量（硬上限）时才同步淘汰。传nullptr取消；应在缓存开始使用前设置，
+    // 维护线程池的生命周期必须长于缓存
+    void setMaintainer(CacheMaintainer* maintainer, size_t lowWatermark, size_t highWatermark);
+
+    // 后台维护：分批淘汰到低水位，必要时做一次频次老化
+    void maintain();
+
+    // 批量加载：整个过程只加一次锁，结果与按输入顺序逐条put相同
+    // range中的元素为(key, value)对，按输入顺序决定新旧，重复出现的key累加访问频次；
+    // LFU的淘汰取决于整段输入的频次，不能像LRU那样只倒序保留最后capacity_个key
+    template<typename Range>
+    void bulkLoad(const Range& range)
+    {
+        bulkLoad(std::begin(range), std::end(range), [](const Key&) { return true; });
+    }
+
+    // 只加载满足pred(key)的元素
+    template<typename Iter, typename Pred>
+    void bulkLoad(Iter first, Iter last, Pred pred)
+    {
+        bulkLoadEntries(first, last, [&pred](const auto& kv) { return pred(kv.first) ? &kv : nullptr; });
+    }
+
+    // 分片缓存预先分好桶的输入：每项为指向(key, value)的指针
+    template<typename Entries>
+    void bulkLoadPartitioned(const Entries& entries)
+    {
+        bulkLoadEntries(std::begin(entries), std::end(entries), [](const auto& entry) { return entry; });
     }
 
 private:
+    // access(*it)返回指向(key, value)的指针，为空表示跳过该项
+    template<typename Iter, typename Access>
+    void bulkLoadEntries(Iter first, Iter last, Access access);
+    void releaseNodes();        // 释放全部节点和频次链表
+    static void destroyFreqLists(FreqListMap& freqLists, std::pmr::memory_resource* resource);   // 析构存活节点并释放频次链表
+    FreqList<Key, Value>* newFreqList(int freq);
+
     void putInternal(Key key, Value value);     // 添加缓存
     void getInternal(NodePtr node, Value& value);     // 获取缓存
 
-    void kickOut();     //移除缓存中的过期数据
+    void kickOut(CacheProbe::EvictReason reason);     //移除缓存中的过期数据，reason只用于evict探针
+    void removeInternal(typename NodeMap::iterator it);    // 删除指定节点
 
     void removeFromFreqList(NodePtr node);  // 从频率列表中移除节点
     void addToFreqList(NodePtr node);   // 添加到频率列表
@@ -183,29 +407,107 @@ private:
     void decreaseFreqNum(int num);      // 减少平均访问等频率
     void handleOverMaxAverageNum();     // 处理当前平均访问频率超过上限的情况
     void updateMinFreq();
+    bool requestMaintenance();  // 需要唤醒维护线程时返回true
 
 private:
+    static constexpr size_t kMaintainBatch = 256;  // 后台维护每次加锁最多淘汰的节点数
+
     int     capacity_;      // 缓存容量
     int     minFreq_;       // 最小访问频次 ）(用于找到最小访问频次的节点)
     int     maxAverageNum_; // 最大平均访问频次
     int     curAverageNum_; // 当前平均访问频次
     int     curTotalNum_;   // 当前访问所有缓存次数总数
     std::mutex  mutex_;     // 互斥锁
+    // 索引和频次链表经计数的resource分配，memoryUsage()据此统计；后台释放线程也持有一份
+    std::shared_ptr<CacheMemory::CountingResource> indexMemory_;
+    std::shared_ptr<CacheMemory::CountingResource> frequencyMemory_;
     NodeMap     nodeMap_;   // key到缓存节点的映射
-    std::unordered_map<int, FreqList<Key, Value>*> freqToFreqList_; // 访问频次到该频次链表的映射
+    FreqListMap freqToFreqList_; // 访问频次到该频次链表的映射
+    NodeArena<Node> nodeArena_;  // 节点内存池
+    bool        customResource_;    // 是否传入了resource，决定开启后台释放时是否需要调用方确认
+    CacheWeigher<Key, Value> weigher_;      // 统计values的权重函数，为空时用默认估计
+    std::shared_ptr<CacheStats> stats_;     // 运行指标，为空表示不统计
+    bool        backgroundRelease_ = false; // 是否在后台线程中释放节点
+
+    CacheMaintainer* maintainer_ = nullptr; // 后台维护线程池，为空表示淘汰和老化都在前台进行
+    size_t      maintainerTask_ = 0;        // 在维护线程池中的任务编号
+    size_t      lowWatermark_ = 0;          // 后台淘汰的目标条目数
+    size_t      highWatermark_ = 0;         // 超过该条目数时唤醒后台淘汰
+    bool        maintenanceRequested_ = false;  // 已唤醒维护线程，尚未处理
+    bool        agingRequested_ = false;    // 平均频次超限，等待维护线程老化
 };
 
-template<typename Key, typename Value>
-void LfuCache<Key, Value>::getInternal(NodePtr node, Value& value)
+template<typename Key, typename Value, typename Hasher>
+void LfuCache<Key, Value, Hasher>::setMaintainer(CacheMaintainer* maintainer, size_t lowWatermark, size_t highWatermark)
+{
+    if (maintainer_)
+    {
+        maintainer_->removeTask(maintainerTask_);
+        maintainer_ = nullptr;
+    }
+    if (!maintainer)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        highWatermark_ = std::min(highWatermark, static_cast<size_t>(std::max(capacity_, 0)));
+        lowWatermark_ = std::min(lowWatermark, highWatermark_);
+        maintenanceRequested_ = false;
+    }
+    maintainerTask_ = maintainer->addTask([this]() { maintain(); });
+    maintainer_ = maintainer;
+}
+
+template<typename Key, typename Value, typename Hasher>
+void LfuCache<Key, Value, Hasher>::maintain()
+{
+    bool evicting = false;
+    while (true)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t size = nodeMap_.size();
+        if (size <= lowWatermark_ || (!evicting && size <= highWatermark_))
+        {
+            maintenanceRequested_ = false;
+            if (agingRequested_)
+            {
+                agingRequested_ = false;
+                if (curAverageNum_ > maxAverageNum_)
+                    handleOverMaxAverageNum();
+            }
+            break;
+        }
+        evicting = true;
+        for (size_t i = 0; i < kMaintainBatch && nodeMap_.size() > lowWatermark_; ++i)
+        {
+            // 连续淘汰会清空最小频次链表，前台的kickOut之后总会插入频次1的新节点，这里需要自己更新
+            if (freqToFreqList_[minFreq_]->isEmpty())
+                updateMinFreq();
+            kickOut(CacheProbe::EvictReason::Background);
+        }
+    }
+}
+
+template<typename Key, typename Value, typename Hasher>
+bool LfuCache<Key, Value, Hasher>::requestMaintenance()
+{
+    if (!maintainer_ || maintenanceRequested_ || (nodeMap_.size() <= highWatermark_ && !agingRequested_))
+        return false;
+    maintenanceRequested_ = true;
+    return true;
+}
+
+template<typename Key, typename Value, typename Hasher>
+void LfuCache<Key, Value, Hasher>::getInternal(NodePtr node, Value& value)
 {
     // 找到之后需要将其从低访问频次的链表中删除，并且添加到+1的访问频次链表中
     // 访问频次+1 并将value值返回
-    value = node->value;
+    XRMS_CACHE_PHASE(ValueCopy, value = node->value);
     
     // 从原有访问频次链表中删除节点
-    removeFromFreqList(node);
+    XRMS_CACHE_PHASE(Promote, removeFromFreqList(node));
     node->freq++; // 节点访问频次+1
-    addToFreqList(node);
+    XRMS_CACHE_PHASE(Promote, addToFreqList(node));
     /* 如果当前node的访问频次等于minFreq+1, 并且其前驱链表为空，
      * 则说明freqToFreqList_[node->freq - 1]链表中node是其仅有的节点，
      * 此时需要更新最小访问频次
@@ -214,42 +516,222 @@ void LfuCache<Key, Value>::getInternal(NodePtr node, Value& value)
         minFreq_++;
 
     // 总访问频次和当前平均访问频次都随之增加
+    addFreqNum();
 }
 
-template<typename Key, typename Value>
-void LfuCache<Key, Value>::putInternal(Key key, Value value)
+template<typename Key, typename Value, typename Hasher>
+void LfuCache<Key, Value, Hasher>::putInternal(Key key, Value value)
 {
     // 不在缓存中，需要先判断缓存是否已满
-    if (nodeMap_.size() == capacity_)
+    if (nodeMap_.size() == static_cast<size_t>(capacity_))
     {
         // 缓存已满，将最不常访问的节点删除，更新当前平均访问频次和总访问频次
-        kickOut();
+        kickOut(CacheProbe::EvictReason::Capacity);
     }
 
+    XRMS_CACHE_PROBE_KEY(insert, this, key);
     // 创建新节点，将新节点添加进入，并更新最小访问频次
-    NodePtr node = std::make_shared<Node>(key, value);
-    nodeMap_[key] = node;
-    addToFreqList(node);
+    NodePtr node = XRMS_CACHE_PHASE(Alloc, nodeArena_.create(key, value));
+    XRMS_CACHE_PHASE(IndexInsert, nodeMap_[key] = node);
+    XRMS_CACHE_PHASE(Promote, addToFreqList(node));
     addFreqNum();
     minFreq_ = std::min(minFreq_, 1);
 }
 
+template<typename Key, typename Value, typename Hasher>
+template<typename Iter, typename Access>
+void LfuCache<Key, Value, Hasher>::bulkLoadEntries(Iter first, Iter last, Access access)
+{
+    if (capacity_ <= 0)
+        return;
+
+    using Category = typename std::iterator_traits<Iter>::iterator_category;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if constexpr (std::is_base_of<std::random_access_iterator_tag, Category>::value)
+    {
+        // 输入长度已知时，一次性为新节点申请一整块连续内存
+        size_t count = static_cast<size_t>(std::distance(first, last));
+        nodeArena_.reserve(std::min(count, static_cast<size_t>(capacity_) - nodeMap_.size()));
+    }
+
+    // 与put相同的逐条处理：已有key更新值并累加频次，新key在缓存满时先淘汰最不常访问的节点
+    for (; first != last; ++first)
+    {
+        const auto* entry = access(*first);
+        if (!entry)
+            continue;
+
+        const auto& kv = *entry;
+        auto it = nodeMap_.find(kv.first);
+        if (it != nodeMap_.end())
+        {
+            Value ignored;
+            it->second->value = kv.second;
+            getInternal(it->second, ignored);
+            continue;
+        }
+        putInternal(kv.first, kv.second);
+    }
+}
+
+template<typename Key, typename Value, typename Hasher>
+void LfuCache<Key, Value, Hasher>::applyBatch(BatchOp* const* ops, size_t count)
+{
+    if (count == 0)
+        return;
+
+    bool needMaintenance = false;
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < count; ++i)
+    {
+        BatchOp* op = ops[i];
+        auto it = nodeMap_.find(op->key);
+        op->found = it != nodeMap_.end();
+        switch (op->type)
+        {
+        case BatchOp::Type::Put:
+            if (capacity_ <= 0)
+                break;
+            if (op->found)
+            {
+                Value ignored;
+                it->second->value = op->value;
+                getInternal(it->second, ignored);
+            }
+            else
+            {
+                putInternal(op->key, op->value);
+                needMaintenance = requestMaintenance() || needMaintenance;
+            }
+            break;
+        case BatchOp::Type::Get:
+            if (op->found)
+                getInternal(it->second, op->value);
+            break;
+        case BatchOp::Type::Remove:
+            if (op->found)
+            {
+                op->value = std::move(it->second->value);
+                removeInternal(it);
+            }
+            break;
+        case BatchOp::Type::Update:
+            if (op->found)
+            {
+                op->value = it->second->value;
+                op->found = op->update(op->value, op->updateArg);
+                if (op->found)
+                {
+                    Value ignored;
+                    it->second->value = op->value;
+                    getInternal(it->second, ignored);
+                }
+            }
+            break;
+        }
+    }
+    lock.unlock();
+    if (needMaintenance)
+        maintainer_->wakeup(maintainerTask_);
+}
+
+// 删除节点：若它是最小频次链表中的最后一个节点，需要重新计算最小频次，保证kickOut取到有效节点
+template<typename Key, typename Value, typename Hasher>
+void LfuCache<Key, Value, Hasher>::removeInternal(typename NodeMap::iterator it)
+{
+    NodePtr node = it->second;
+    int freq = node->freq;
+    removeFromFreqList(node);
+    nodeMap_.erase(it);
+    decreaseFreqNum(freq);
+    nodeArena_.destroy(node);
+    if (freq == minFreq_ && freqToFreqList_[freq]->isEmpty())
+        updateMinFreq();
+}
+
 // 删除最不常访问节点并更新当前平均访问频次和总访问频次
-template<typename Key, typename Value>
-void LfuCache<Key, Value>::kickOut()
+template<typename Key, typename Value, typename Hasher>
+void LfuCache<Key, Value, Hasher>::kickOut(CacheProbe::EvictReason reason)
 {
     // 根据访问频次拿到第一个节点，即最不常访问的节点
-    NodePtr node = freqToFreqList_[minFreq_]->getFirstNode();
+    NodePtr node = XRMS_CACHE_PHASE(Victim, freqToFreqList_[minFreq_]->getFirstNode());
+    XRMS_CACHE_PROBE_EVICT(this, node->key, reason);
     // 先从访问频次列表中删除
-    removeFromFreqList(node);
+    XRMS_CACHE_PHASE(Victim, removeFromFreqList(node));
     // 再从map中删除
-    nodeMap_.erase(node->key);
+    XRMS_CACHE_PHASE(IndexErase, nodeMap_.erase(node->key));
     // 减少平均访问等频率
-    decreaseFreqNum(node->key);
+    decreaseFreqNum(node->freq);
+    // 节点槽位放回内存池
+    XRMS_CACHE_PHASE(Alloc, nodeArena_.destroy(node));
+    if (stats_)
+    {
+        CacheStats::bump(stats_->evictions);
+        stats_->setEntries(nodeMap_.size());
+    }
 }
 
-template<typename Key, typename Value>
-void LfuCache<Key, Value>::removeFromFreqList(NodePtr node)
+// 释放全部节点：节点内存整块归还内存池，频次链表逐个delete（数量与不同频次数相当，很少）
+template<typename Key, typename Value, typename Hasher>
+void LfuCache<Key, Value, Hasher>::releaseNodes()
+{
+    if (backgroundRelease_)
+    {
+        // 频次链表与旧哈希表一并交给后台线程析构
+        nodeArena_.releaseInBackground(
+            [oldLists = std::move(freqToFreqList_), oldMap = std::move(nodeMap_),
+             indexMemory = indexMemory_, frequencyMemory = frequencyMemory_]() mutable {
+                // 在函数体内析构两张表，保证归还内存时计数的resource仍然存活
+                FreqListMap lists(std::move(oldLists));
+                destroyFreqLists(lists, frequencyMemory.get());
+                NodeMap released(std::move(oldMap));
+            });
+        freqToFreqList_ = FreqListMap(freqToFreqList_.get_allocator());
+        nodeMap_ = NodeMap(nodeMap_.get_allocator());
+    }
+    else
+    {
+        destroyFreqLists(freqToFreqList_, frequencyMemory_.get());
+        nodeArena_.release();
+        nodeMap_.clear();
+    }
+    minFreq_ = INT8_MAX;
+    curAverageNum_ = 0;
+    curTotalNum_ = 0;
+}
+
+template<typename Key, typename Value, typename Hasher>
+void LfuCache<Key, Value, Hasher>::destroyFreqLists(FreqListMap& freqLists, std::pmr::memory_resource* resource)
+{
+    for (auto& pair : freqLists)
+    {
+        FreqList<Key, Value>* list = pair.second;
+        if constexpr (!std::is_trivially_destructible<Key>::value
+                      || !std::is_trivially_destructible<Value>::value)
+        {
+            for (NodePtr node = list->head_->next; node != list->tail_; )
+            {
+                NodePtr next = node->next;
+                node->~Node();
+                node = next;
+            }
+        }
+        list->~FreqList<Key, Value>();
+        CacheMemory::deallocate(resource, list, sizeof(FreqList<Key, Value>), alignof(FreqList<Key, Value>));
+    }
+    freqLists.clear();
+}
+
+// 频次链表及其哨兵经frequencyMemory_分配，上游与节点是同一个内存来源
+template<typename Key, typename Value, typename Hasher>
+FreqList<Key, Value>* LfuCache<Key, Value, Hasher>::newFreqList(int freq)
+{
+    void* memory = CacheMemory::allocate(frequencyMemory_.get(), sizeof(FreqList<Key, Value>), alignof(FreqList<Key, Value>));
+    return ::new (memory) FreqList<Key, Value>(freq, frequencyMemory_.get());
+}
+
+template<typename Key, typename Value, typename Hasher>
+void LfuCache<Key, Value, Hasher>::removeFromFreqList(NodePtr node)
 {
     // 检查节点是否为空
     if (!node)
@@ -262,8 +744,8 @@ void LfuCache<Key, Value>::removeFromFreqList(NodePtr node)
 }
 
 // 将节点加入相应的频次链表
-template<typename Key, typename Value>
-void LfuCache<Key, Value>::addToFreqList(NodePtr node)
+template<typename Key, typename Value, typename Hasher>
+void LfuCache<Key, Value, Hasher>::addToFreqList(NodePtr node)
 {
     // 检查节点是否为空
     if (!node)
@@ -274,15 +756,15 @@ void LfuCache<Key, Value>::addToFreqList(NodePtr node)
     if (freqToFreqList_.find(node->freq) == freqToFreqList_.end())
     {
         // 不存在，自行创建
-        freqToFreqList_[node->freq] = new FreqList<Key, Value>(node->freq);
+        freqToFreqList_[node->freq] = newFreqList(node->freq);
     }
     freqToFreqList_[freq]->addNode(node);
 }
 
 
 // 增加平均访问频次
-template<typename Key, typename Value>
-void LfuCache<Key, Value>::addFreqNum()
+template<typename Key, typename Value, typename Hasher>
+void LfuCache<Key, Value, Hasher>::addFreqNum()
 {
     curTotalNum_++;
     if (nodeMap_.empty())  // 若缓存中无节点 则把当前平均访问频次置为0
@@ -292,14 +774,17 @@ void LfuCache<Key, Value>::addFreqNum()
     
     if (curAverageNum_ > maxAverageNum_) // 更新后的平均访问频次超过限制
     {
-        // 对访问频次列表进行刷新
-        handleOverMaxAverageNum();
+        // 有维护线程时老化交给它做，前台不承担遍历全部节点的开销
+        if (maintainer_)
+            agingRequested_ = true;
+        else
+            handleOverMaxAverageNum();   // 对访问频次列表进行刷新
     }
 }
 
 // 减少平均访问频次和总访问频次(节点被淘汰时更新频次)
-template<typename Key, typename Value>
-void LfuCache<Key, Value>::decreaseFreqNum(int num)
+template<typename Key, typename Value, typename Hasher>
+void LfuCache<Key, Value, Hasher>::decreaseFreqNum(int num)
 {
     // 减少平均访问频次和总访问频次
     curTotalNum_ -= num;
@@ -310,13 +795,15 @@ void LfuCache<Key, Value>::decreaseFreqNum(int num)
 }
 
 // 超过最大平均访问频次时进行处理
-template<typename Key, typename Value>
-void LfuCache<Key, Value>::handleOverMaxAverageNum()
+template<typename Key, typename Value, typename Hasher>
+void LfuCache<Key, Value, Hasher>::handleOverMaxAverageNum()
 {
     if (nodeMap_.empty())
         return;
 
+    XRMS_CACHE_PROBE3(aging, static_cast<const void*>(this), nodeMap_.size(), curAverageNum_);
     // 当前平均访问频次已经超过了最大平均访问频次，所有节点的访问频次-(maxAverageNum_ / 2)
+    curTotalNum_ = 0;
     for (auto it = nodeMap_.begin(); it != nodeMap_.end(); ++it)
     {
         // 检查节点是否为空
@@ -334,15 +821,18 @@ void LfuCache<Key, Value>::handleOverMaxAverageNum()
 
         // 添加到新的频率列表
         addToFreqList(node);
+        curTotalNum_ += node->freq;
     }
+    // 总访问频次按老化后的频次重新统计，否则平均值一直超限，之后每次访问都会再老化一遍
+    curAverageNum_ = curTotalNum_ / static_cast<int>(nodeMap_.size());
 
     // 更新最小频率
     updateMinFreq();
 }
 
 // 更新最小访问频次
-template<typename Key, typename Value>
-void LfuCache<Key, Value>::updateMinFreq()
+template<typename Key, typename Value, typename Hasher>
+void LfuCache<Key, Value, Hasher>::updateMinFreq()
 {
     minFreq_ = INT8_MAX;
     // 遍历访问频次列表
@@ -361,21 +851,22 @@ void LfuCache<Key, Value>::updateMinFreq()
 // 缓存数据分散到N个LfuCache上，查询时也按照相同的哈希算法，先获取数据可能存在的分片，
 // 然后再去对应的分片上查询数据。这样可以增加lfu的读写操作的并行度，减少同步等待的耗时。
 // HashLfuCache 的实现类似HashLruCache
-template<typename Key, typename Value>
+template<typename Key, typename Value, typename Hasher = CacheHash<Key>>
 class HashLfuCache
 {
 public:
-    HashLfuCache(size_t capacity, int sliceNum, int maxAverageNum = 10)
+    // resource为所有分片的内存来源，为空时用malloc
+    HashLfuCache(size_t capacity, int sliceNum, int maxAverageNum = 10, std::pmr::memory_resource* resource = nullptr)
     // 若传入值为0，则初始化为当前系统的硬件并发线程数，通过hardware_concurrecy获取
-        : sliceNum_(sliceNum > 0 ? sliceNum : std::thread::hardware_concurrency())
-        , capacity_(capacity)
+        : capacity_(capacity)
+        , sliceNum_(sliceNum > 0 ? sliceNum : std::thread::hardware_concurrency())
     {
         // 每个切片的大小为容量除以切片数
         size_t sliceSize = std::ceil(capacity_ / static_cast<double>(sliceNum_)); 
         for (int i = 0; i < sliceNum_; ++i)
         {
             // 加强版pushback 也就是在把obj加入vec之前才new这个obj
-            lfuSliceCaches_.emplace_back(new LfuCache<Key, Value>(sliceSize, maxAverageNum));
+            lfuSliceCaches_.emplace_back(new LfuCache<Key, Value, Hasher>(sliceSize, maxAverageNum, resource));
         }
     }
 
@@ -386,6 +877,52 @@ public:
         return lfuSliceCaches_[sliceIndex]->put(key, value);
     }
 
+    bool get(Key key, Value& value)
+    {
+        // 根据key找出对应的lfu分片
+        size_t sliceIndex = Hash(key) % sliceNum_;
+        return lfuSliceCaches_[sliceIndex]->get(key, value);
+    }
+
+    // 删除指定元素
+    void remove(Key key)
+    {
+        size_t sliceIndex = Hash(key) % sliceNum_;
+        lfuSliceCaches_[sliceIndex]->remove(key);
+    }
+
+    // 批量执行：按分片分组后每个分片只加一次锁，同一分片内保持操作的原始顺序
+    void applyBatch(std::vector<typename LfuCache<Key, Value, Hasher>::BatchOp>& ops)
+    {
+        using BatchOp = typename LfuCache<Key, Value, Hasher>::BatchOp;
+        if (ops.empty())
+            return;
+
+        // 计数排序：先统计每个分片的操作数，再把操作指针稳定地放到各分片的区间里
+        std::vector<uint32_t> sliceOf(ops.size());
+        std::vector<size_t> offsets(sliceNum_ + 1, 0);
+        for (size_t i = 0; i < ops.size(); ++i)
+        {
+            sliceOf[i] = static_cast<uint32_t>(Hash(ops[i].key) % sliceNum_);
+            ++offsets[sliceOf[i] + 1];
+        }
+        for (int i = 0; i < sliceNum_; ++i)
+        {
+            offsets[i + 1] += offsets[i];
+        }
+        std::vector<BatchOp*> grouped(ops.size());
+        std::vector<size_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < ops.size(); ++i)
+        {
+            grouped[cursor[sliceOf[i]]++] = &ops[i];
+        }
+
+        for (int i = 0; i < sliceNum_; ++i)
+        {
+            lfuSliceCaches_[i]->applyBatch(grouped.data() + offsets[i], offsets[i + 1] - offsets[i]);
+        }
+    }
+
     Value get(Key key)
     {
         Value value;
@@ -402,17 +939,92 @@ public:
         }
     }
 
+    // 所有分片交给同一个维护线程池，水位按分片容量的比例计算；传nullptr取消
+    void setMaintainer(CacheMaintainer* maintainer, double lowRatio = 0.9, double highRatio = 0.95)
+    {
+        size_t sliceSize = std::ceil(capacity_ / static_cast<double>(sliceNum_));
+        for (auto& slice : lfuSliceCaches_)
+        {
+            slice->setMaintainer(maintainer, static_cast<size_t>(sliceSize * lowRatio),
+                                 static_cast<size_t>(sliceSize * highRatio));
+        }
+    }
+
+    // 清空和析构时是否在后台线程中释放节点，resourceThreadSafe的含义同LfuCache；任一分片拒绝时返回false
+    bool setBackgroundRelease(bool enable, bool resourceThreadSafe = false)
+    {
+        bool accepted = true;
+        for (auto& lfuSliceCache : lfuSliceCaches_)
+        {
+            accepted = lfuSliceCache->setBackgroundRelease(enable, resourceThreadSafe) && accepted;
+        }
+        return accepted;
+    }
+
+    // 各分片内存占用之和，逐个分片加锁统计
+    CacheMemoryUsage memoryUsage()
+    {
+        CacheMemoryUsage usage;
+        for (auto& lfuSliceCache : lfuSliceCaches_)
+        {
+            usage += lfuSliceCache->memoryUsage();
+        }
+        return usage;
+    }
+
+    void setWeigher(CacheWeigher<Key, Value> weigher)
+    {
+        for (auto& lfuSliceCache : lfuSliceCaches_)
+        {
+            lfuSliceCache->setWeigher(weigher);
+        }
+    }
+
+    // 每个分片在metrics中登记一组指标（标签cache=name, shard=分片号），
+    // estimateMrc为true时各分片共用一个未命中率曲线估计；需在并发访问开始之前调用
+    void setMetrics(CacheMetrics& metrics, const std::string& name, bool estimateMrc = true)
+    {
+        std::shared_ptr<MissRatioEstimator> mrc;
+        if (estimateMrc)
+        {
+            mrc = metrics.addEstimator(name, capacity_ * 4);
+        }
+        for (int i = 0; i < sliceNum_; ++i)
+        {
+            std::shared_ptr<CacheStats> stats = metrics.addStats(name, i);
+            stats->mrc = mrc;
+            lfuSliceCaches_[i]->setStats(std::move(stats));
+        }
+    }
+
+    // 并行批量加载：先单线程扫描一遍输入，按分片分桶记下每项的地址，
+    // 再由不超过硬件线程数的线程各自认领分片建链
+    // 分片内的索引是std::unordered_map，查找时仍会再算一次哈希
+    // range须是元素可取地址的容器，加载期间不能修改
+    template<typename Range>
+    void bulkLoad(const Range& range)
+    {
+        using Entry = typename std::remove_reference<decltype(*std::begin(range))>::type;
+        std::vector<std::vector<const Entry*>> buckets(sliceNum_);
+        for (const auto& kv : range)
+        {
+            buckets[Hash(kv.first) % sliceNum_].push_back(&kv);
+        }
+        forEachSliceParallel(sliceNum_, [this, &buckets](size_t i) {
+            lfuSliceCaches_[i]->bulkLoadPartitioned(buckets[i]);
+        });
+    }
+
 private:
     // 由key计算出哈希值
-    size_t Hash(Key key)
+    size_t Hash(const Key& key)
     {
-        std::hash<Key> hashFunc;
-        return hashFunc(key);
+        return Hasher()(key);
     }
 
 private:
     size_t capacity_;   // 缓存的总容量
     int sliceNum_;      // 缓存分片数量
-    std::vector<std::unique_ptr<LfuCache<Key, Value>>> lfuSliceCaches_; // 缓存分片容器
+    std::vector<std::unique_ptr<LfuCache<Key, Value, Hasher>>> lfuSliceCaches_; // 缓存分片容器
 };
 }
\ No newline at end of file
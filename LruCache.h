@@ -1,70 +1,152 @@
 #pragma once
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
 #include <cstring>
+#include <iterator>
 #include <list>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
 #include <unordered_map>
+#include <vector>
 
+#include "BackingStore.h"
+#include "CacheArena.h"
+#include "CacheBatch.h"
+#include "CacheHash.h"
+#include "CacheIndex.h"
+#include "CacheMaintainer.h"
+#include "CacheMetrics.h"
+#include "CachePhase.h"
+#include "CacheProbe.h"
 #include "ICachePolicy.h"
 
 // LRU-最近最少使用算法
 namespace XrmsCache
 {
     // 前向声明，为了在类定义之前引用这个类
-template<typename Key, typename Value> class LruCache;
+template<typename Key, typename Value, typename Hasher = CacheHash<Key>> class LruCache;
 
+// 节点的冷数据：只在命中、写入和写回时访问
 template<typename Key, typename Value>
-class LruNode
+struct LruPayload
 {
-private:
     Key key_;
     Value value_;
-    size_t accessCount_;  // 访问次数
-    std::shared_ptr<LruNode<Key, Value>> prev_; // prev指针
-    std::shared_ptr<LruNode<Key, Value>> next_; // next指针
 
-public:
-    // 默认构造函数
-    LruNode(Key key, Value value)
+    LruPayload(const Key& key, const Value& value)
         : key_(key)
         , value_(value)
-        , accessCount_(1)
-        , prev_(nullptr)
+    {}
+};
+
+// 节点的热数据：链表调整、索引删除和淘汰只访问这部分，与LruPayload在内存池中按同一槽位分开存放
+template<typename Key, typename Value>
+class LruNode
+{
+private:
+    LruNode<Key, Value>* prev_; // prev指针
+    LruNode<Key, Value>* next_; // next指针（节点由缓存的内存池统一管理，不再用智能指针，避免prev/next循环引用）
+    size_t hash_;         // key的完整哈希值，分片路由和分片内索引共用，淘汰时不再重新计算
+    size_t slot_;         // 在索引中的槽位，由NodeIndex维护
+    LruPayload<Key, Value>* payload_;   // 同一槽位的key和value，哨兵节点为空
+    bool dirty_;          // 写回模式下，值已修改但还没写入后端存储
+
+public:
+    explicit LruNode(LruPayload<Key, Value>* payload, size_t hash = 0)
+        : prev_(nullptr)
         , next_(nullptr)
+        , hash_(hash)
+        , slot_(0)
+        , payload_(payload)
+        , dirty_(false)
     {}
 
     // 提供必要的访问器
-    Key getKey() const {return key_; }
-    Value getValue() const {return value_; }
-    void setValue(const Value& value) {value_ = value; }
-    size_t getAccessCount() const{ return accessCount_; }
-    void incrementAccessCount() { ++accessCount_; }
+    Key getKey() const {return payload_->key_; }
+    Value getValue() const {return payload_->value_; }
+    void setValue(const Value& value) {payload_->value_ = value; }
 
-    friend class LruCache<Key, Value>;
+    template<typename K, typename V, typename H> friend class LruCache;
+    friend class NodeIndex<LruNode<Key, Value>>;
 };
 
 // 让LruCache继承自ICachePolicy接口  重写里面两个get和一个put方法
-template<typename Key, typename Value>
+// Hasher为key的哈希函数，默认CacheHash：整数做乘法混合，字符串用wyhash风格的实现
+template<typename Key, typename Value, typename Hasher>
 class LruCache : public ICachePolicy<Key, Value>
 {
 public:
     // 定义类型别名
     using LruNodeType = LruNode<Key, Value>;
-    using NodePtr = std::shared_ptr<LruNodeType>;  // 使用智能指针
-    using NodeMap = std::unordered_map<Key, NodePtr>;
+    using PayloadType = LruPayload<Key, Value>;
+    using NodePtr = LruNodeType*;  // 节点内存归nodeArena_所有
+    using NodeMap = NodeIndex<LruNodeType>;   // 节点自带哈希值和槽位
+    using BatchOp = CacheBatchOp<Key, Value>;
+    using Store = BackingStore<Key, Value>;
+
+    // 根据容量参数构造；resource为节点和索引的内存来源，为空时用malloc（见CacheMemory）
+    LruCache(int capacity, std::pmr::memory_resource* resource = nullptr)
+        : capacity_(capacity)
+        , nodeMap_(0, resource)
+        , denseIndex_(resource)
+        , nodeArena_(std::clamp(capacity, 1, 65536), resource)
+        , resource_(resource)
+    {
+        initializeList();
+        // 容量固定，索引一次分配到位，填充过程中不会触发整表重新散列
+        if (capacity_ > 0)
+        {
+            nodeMap_.reserve(capacity_);
+        }
+    }
 
-    // 根据容量参数构造
-    LruCache(int capacity)
+    // 稠密整数key：[0, maxKey]内的key用直接寻址索引，查找只需一次数组访问，也省去哈希索引的内存
+    template<typename K = Key, typename = std::enable_if_t<std::is_integral<K>::value>>
+    LruCache(int capacity, Key maxKey, std::pmr::memory_resource* resource = nullptr)
         : capacity_(capacity)
+        , nodeMap_(0, resource)
+        , denseIndex_(resource)
+        , nodeArena_(std::clamp(capacity, 1, 65536), resource)
+        , resource_(resource)
     {
         initializeList();
+        setDenseKeys(maxKey);
+    }
+
+    ~LruCache() override
+    {
+        setMaintainer(nullptr, 0, 0);
+        if (store_)
+        {
+            flush();
+        }
+        releaseNodes();
+        delete dummyHead_;
+        delete dummyTail_;
     }
 
-    ~LruCache() override = default;
+    // 索引使用的哈希函数，分片缓存用同一个函数选分片并把结果传给带hash参数的接口
+    static size_t hashOf(const Key& key)
+    {
+        return Hasher()(key);
+    }
 
     // key存在则更新，不存在则向缓存中插入key-value
     void put(Key key, Value value) override
+    {
+        put(key, value, hashOf(key));
+    }
+
+    // hash为调用方已算好的hashOf(key)，分片缓存选分片时算过一次，这里直接复用
+    void put(const Key& key, const Value& value, size_t hash)
     {
         // 先确定容量够不够
         if (capacity_ <= 0)
@@ -72,33 +154,91 @@ public:
             return;
         }
 
-        // 互斥锁
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = nodeMap_.find(key);
-        if (it != nodeMap_.end())
+        bool needWriteBack = false;
+        bool needMaintenance = false;
+        CacheStats* stats = stats_.get();
+        LatencyTimer timer(stats ? &stats->putLatency : nullptr);
         {
-            // 如果在当前容器中，则更新value，并调用get方法，代表该数据刚被访问
-            updateExistingNode(it->second, value);
-            return ;
+            // 互斥锁
+            std::unique_lock<std::mutex> lock = CacheProbe::lock(mutex_, this, stats ? &stats->lockContended : nullptr);
+            NodePtr node = XRMS_CACHE_PHASE(Lookup, findNode(key, hash));
+            if (node)
+            {
+                // 如果在当前容器中，则更新value，并调用get方法，代表该数据刚被访问
+                updateExistingNode(node, value);
+            }
+            else
+            {
+                XRMS_CACHE_PROBE_KEY(insert, this, key);
+                node = addNewNode(key, value, hash);
+                needMaintenance = requestMaintenance();
+                if (stats)
+                {
+                    CacheStats::bump(stats->inserts);
+                    stats->setEntries(indexSize());
+                }
+            }
+            if (store_)
+            {
+                needWriteBack = markDirty(node);
+            }
+        }
+        // 写回存储和唤醒维护线程都在锁外进行，不阻塞本分片的其他操作
+        if (needMaintenance)
+        {
+            maintainer_->wakeup(maintainerTask_);
+        }
+        if (needWriteBack)
+        {
+            writeBack(false);
         }
-
-        addNewNode(key, value);
     }
 
     // 利用key尝试取缓存中的页，返回true或false
     bool get(Key key,Value& value) override  // override明确地指示一个函数是基类虚函数的重写
     {
+        return get(key, value, hashOf(key));
+    }
+
+    bool get(const Key& key, Value& value, size_t hash)
+    {
+        CacheStats* stats = stats_.get();
+        LatencyTimer timer(stats ? &stats->getLatency : nullptr);
+        if (stats)
+        {
+            stats->access(hash);
+        }
         // 上锁
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::unique_lock<std::mutex> lock = CacheProbe::lock(mutex_, this, stats ? &stats->lockContended : nullptr);
         // 查找当前key在不在缓存中
-        auto it = nodeMap_.find(key);
-        if (it != nodeMap_.end()) // 说明找到了
+        NodePtr node = XRMS_CACHE_PHASE(Lookup, findNode(key, hash));
+        if (node) // 说明找到了
         {
+            XRMS_CACHE_PROBE_KEY(hit, this, key);
+            if (stats)
+            {
+                CacheStats::bump(stats->hits);
+            }
             // 此节点现在变成最新访问的 需要将其置于最新位置
-            moveToMostRecent(it->second);
-            value = it->second->getValue();
+            XRMS_CACHE_PHASE(Promote, moveToMostRecent(node));
+            XRMS_CACHE_PHASE(ValueCopy, value = node->payload_->value_);
             return true;
         }
+        // 写回模式下已被淘汰但还没写入存储的数据仍然可读
+        if (store_ && findPending(key, value))
+        {
+            XRMS_CACHE_PROBE_KEY(hit, this, key);
+            if (stats)
+            {
+                CacheStats::bump(stats->hits);
+            }
+            return true;
+        }
+        XRMS_CACHE_PROBE_KEY(miss, this, key);
+        if (stats)
+        {
+            CacheStats::bump(stats->misses);
+        }
         return false;
     }
 
@@ -111,47 +251,758 @@ public:
         return value;
     }
 
+    // 当前条目数
+    size_t size()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return indexSize();
+    }
+
+    // 开启稠密整数key模式，只能在缓存为空时调用。key在[0, maxKey]内且 key % stride == residue 时
+    // 以 key / stride 为槽位直接寻址（分片缓存按key取模分片时，stride为分片数、residue为分片号），
+    // 其余key仍走哈希索引。槽位数不超过容量的8倍时用直接数组，否则用按需分配的两级表
+    template<typename K = Key, typename = std::enable_if_t<std::is_integral<K>::value>>
+    void setDenseKeys(Key maxKey, size_t stride = 1, size_t residue = 0)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (capacity_ <= 0 || maxKey < 0 || indexSize() != 0)
+        {
+            return;
+        }
+        denseMaxKey_ = static_cast<uint64_t>(maxKey);
+        denseStride_ = std::max<size_t>(stride, 1);
+        denseResidue_ = residue % denseStride_;
+        denseIndex_.init(denseMaxKey_ / denseStride_ + 1, static_cast<size_t>(capacity_));
+        // 范围外的key通常很少，哈希索引按需增长
+        nodeMap_ = NodeMap(0, resource_);
+    }
+
+    // 索引（哈希索引和稠密索引）本身占用的字节数，不含节点
+    size_t indexMemory()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return nodeMap_.memoryBytes() + denseIndex_.memoryBytes();
+    }
+
+    // 内存占用：索引和节点内存池按已申请的内存计，values遍历全部条目由权重函数累加
+    // 写回模式下尚未写出的数据不计入
+    CacheMemoryUsage memoryUsage()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        CacheMemoryUsage usage;
+        usage.entries = indexSize();
+        usage.index = nodeMap_.memoryBytes() + denseIndex_.memoryBytes();
+        usage.nodes = nodeArena_.memoryBytes();
+        for (NodePtr node = dummyHead_->next_; node != dummyTail_; node = node->next_)
+        {
+            usage.values += CacheMemory::weigh(weigher_, node->payload_->key_, node->payload_->value_);
+        }
+        return usage;
+    }
+
+    // 设置memoryUsage()统计values使用的权重函数
+    void setWeigher(CacheWeigher<Key, Value> weigher)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        weigher_ = std::move(weigher);
+    }
+
+    // 挂上运行指标（见CacheMetrics.h），为空则停止统计；需在并发访问开始之前设置
+    void setStats(std::shared_ptr<CacheStats> stats)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_ = std::move(stats);
+        if (stats_)
+        {
+            stats_->capacity.store(static_cast<size_t>(std::max(capacity_, 0)), std::memory_order_relaxed);
+            stats_->setEntries(indexSize());
+        }
+    }
+
     // 删除指定元素
+    // 写回模式下同时丢弃该key尚未写出的修改，之后get不会再读到它；
+    // 已经开始写入存储的一批无法撤回，存储中的旧值也不会被删除（BackingStore没有删除接口）
     void remove(Key key)
+    {
+        remove(key, hashOf(key));
+    }
+
+    void remove(const Key& key, size_t hash)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (store_)
+        {
+            dropPending(key);
+        }
+        NodePtr node = findNode(key, hash);
+        if (node)
+        {
+            discardDirty(node);
+            removeNode(node);
+            unindexNode(node);
+            destroyNode(node);
+            if (stats_)
+            {
+                stats_->setEntries(indexSize());
+            }
+        }
+    }
+
+    // 提前淘汰指定元素：写回模式下未写出的修改和正常淘汰一样进入待写队列，稍后写入存储
+    void evict(Key key)
+    {
+        evict(key, hashOf(key));
+    }
+
+    void evict(const Key& key, size_t hash)
     {
         std::lock_guard<std::mutex> lock(mutex_);
-        auto it = nodeMap_.find(key);
-        if (it != nodeMap_.end())
+        NodePtr node = findNode(key, hash);
+        if (node)
         {
-            removeNode(it->second);
-            nodeMap_.erase(it);
+            retireNode(node);
+            removeNode(node);
+            unindexNode(node);
+            destroyNode(node);
+            if (stats_)
+            {
+                stats_->setEntries(indexSize());
+            }
         }
     }
 
+    // 清空缓存：节点内存整块归还给系统，只有Key/Value需要析构时才逐个调用析构函数
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        releaseNodes();
+        if (stats_)
+        {
+            stats_->setEntries(0);
+        }
+    }
+
+    // 在一次加锁内按顺序执行一批操作，分片缓存按分片分组后调用
+    // hashed为true表示各操作的hash字段已由调用方填好
+    void applyBatch(BatchOp* const* ops, size_t count, bool hashed = false)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        bool needWriteBack = false;
+        bool needMaintenance = false;
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < count; ++i)
+        {
+            BatchOp* op = ops[i];
+            size_t hash = hashed ? op->hash : hashOf(op->key);
+            if (op->type == BatchOp::Type::Put)
+            {
+                if (capacity_ <= 0)
+                {
+                    continue;
+                }
+                NodePtr node = findNode(op->key, hash);
+                op->found = node != nullptr;
+                if (op->found)
+                {
+                    updateExistingNode(node, op->value);
+                }
+                else
+                {
+                    node = addNewNode(op->key, op->value, hash);
+                    needMaintenance = requestMaintenance() || needMaintenance;
+                }
+                if (store_)
+                {
+                    needWriteBack = markDirty(node) || needWriteBack;
+                }
+                continue;
+            }
+
+            NodePtr node = findNode(op->key, hash);
+            op->found = node != nullptr;
+            if (!op->found)
+            {
+                if (op->type == BatchOp::Type::Get && store_)
+                {
+                    op->found = findPending(op->key, op->value);
+                }
+                else if (op->type == BatchOp::Type::Remove && store_)
+                {
+                    op->found = findPending(op->key, op->value);
+                    dropPending(op->key);
+                }
+                continue;
+            }
+            switch (op->type)
+            {
+            case BatchOp::Type::Get:
+                moveToMostRecent(node);
+                op->value = node->payload_->value_;
+                break;
+            case BatchOp::Type::Remove:
+                if (store_)
+                {
+                    dropPending(op->key);
+                    discardDirty(node);
+                }
+                op->value = std::move(node->payload_->value_);
+                removeNode(node);
+                unindexNode(node);
+                destroyNode(node);
+                break;
+            case BatchOp::Type::Update:
+                op->value = node->payload_->value_;
+                op->found = op->update(op->value, op->updateArg);
+                if (op->found)
+                {
+                    updateExistingNode(node, op->value);
+                    if (store_)
+                    {
+                        needWriteBack = markDirty(node) || needWriteBack;
+                    }
+                }
+                break;
+            default:
+                break;
+            }
+        }
+        lock.unlock();
+        if (needMaintenance)
+        {
+            maintainer_->wakeup(maintainerTask_);
+        }
+        if (needWriteBack)
+        {
+            writeBack(false);
+        }
+    }
+
+    // 开启后，清空和析构时把节点的析构与内存释放交给后台分离线程，调用方立即返回
+    // 释放线程可能在缓存析构之后才结束，需要确认内存已归还时调用waitBackgroundRelease()
+    // 传入了resource时它必须线程安全并存活到waitBackgroundRelease()返回，调用方以resourceThreadSafe=true确认，
+    // 否则不开启并返回false
+    bool setBackgroundRelease(bool enable, bool resourceThreadSafe = false)
+    {
+        if (enable && resource_ && !resourceThreadSafe)
+        {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        backgroundRelease_ = enable;
+        return true;
+    }
+
+    // 开启写回模式：put只更新缓存并标记脏位，不立即写后端存储
+    // 脏节点被淘汰后进入待写队列（同一key只保留最新值），攒够batchSize条时由触发淘汰的线程在锁外批量写入；
+    // 调用flush()时连同仍在缓存中的脏节点一起写出。store的生命周期必须长于缓存，传nullptr关闭写回
+    // BackingStore只有读写没有删除：remove只丢弃缓存中未写出的修改，存储中已有的值保留
+    void setWriteBack(Store* store, size_t batchSize = 64)
+    {
+        if (!store)
+        {
+            flush();
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        store_ = store;
+        writeBatchSize_ = std::max<size_t>(batchSize, 1);
+    }
+
+    // 交给后台维护线程控制容量：条目数超过高水位时由维护线程分批淘汰到低水位，
+    // 前台put只在达到容量（硬上限）时才同步淘汰。传nullptr取消；应在缓存开始使用前设置，
+    // 维护线程池的生命周期必须长于缓存
+    void setMaintainer(CacheMaintainer* maintainer, size_t lowWatermark, size_t highWatermark)
+    {
+        if (maintainer_)
+        {
+            maintainer_->removeTask(maintainerTask_);
+            maintainer_ = nullptr;
+        }
+        if (!maintainer)
+        {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            highWatermark_ = std::min(highWatermark, static_cast<size_t>(std::max(capacity_, 0)));
+            lowWatermark_ = std::min(lowWatermark, highWatermark_);
+            maintenanceRequested_ = false;
+        }
+        maintainerTask_ = maintainer->addTask([this]() { maintain(); });
+        maintainer_ = maintainer;
+    }
+
+    // 后台维护：超过高水位时淘汰到低水位，每淘汰一批释放一次锁，避免长时间阻塞前台操作
+    void maintain()
+    {
+        bool evicting = false;
+        bool needWriteBack = false;
+        while (true)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            size_t size = indexSize();
+            if (size <= lowWatermark_ || (!evicting && size <= highWatermark_))
+            {
+                maintenanceRequested_ = false;
+                needWriteBack = store_ && pendingWrites_.size() >= writeBatchSize_;
+                break;
+            }
+            evicting = true;
+            evictLeastRecentBatch(std::min(kMaintainBatch, size - lowWatermark_), CacheProbe::EvictReason::Background);
+        }
+        if (needWriteBack)
+        {
+            writeBack(false);
+        }
+    }
+
+    // 批量淘汰：缓存满时一次淘汰batch个最久未使用的节点，之后的batch-1次插入无需再淘汰
+    // 链表整段摘下、哈希表集中删除，一次加锁内完成，分摊到一串插入上。条目数会在
+    // [capacity - batch, capacity]之间波动；默认1，即每次插入淘汰一个
+    void setEvictionBatch(size_t batch)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        evictionBatch_ = std::max<size_t>(batch, 1);
+    }
+
+    // 把所有脏数据（包括仍在缓存中的）合并成一批写入存储，写入失败的数据保留在待写队列中等待下次重试
+    bool flush()
+    {
+        return writeBack(true);
+    }
+
+    // 批量加载：预热时一次性灌入大量数据，整个过程只加一次锁，省去逐条put的查找与淘汰检查
+    // range中的元素为(key, value)对，按输入顺序决定新旧，越靠后越新（与依次put的结果一致）
+    template<typename Range>
+    void bulkLoad(const Range& range)
+    {
+        bulkLoad(std::begin(range), std::end(range), [](const Key&) { return true; });
+    }
+
+    // 只加载满足pred(key)的元素
+    template<typename Iter, typename Pred>
+    void bulkLoad(Iter first, Iter last, Pred pred)
+    {
+        bulkLoadEntries(first, last, [&pred](const auto& kv) {
+            using KvPtr = decltype(&kv);
+            return pred(kv.first) ? std::make_pair(&kv, hashOf(kv.first)) : std::make_pair(KvPtr(nullptr), size_t(0));
+        });
+    }
+
+    // 分片缓存预先分好桶的输入：每项为(hashOf(key), 指向(key, value)的指针)，直接复用算好的哈希
+    template<typename Entries>
+    void bulkLoadHashed(const Entries& entries)
+    {
+        bulkLoadEntries(std::begin(entries), std::end(entries),
+                        [](const auto& entry) { return std::make_pair(entry.second, entry.first); });
+    }
+
 private:
+    // access(*it)返回(指向(key, value)的指针, 哈希)，指针为空表示跳过该项
+    template<typename Iter, typename Access>
+    void bulkLoadEntries(Iter first, Iter last, Access access)
+    {
+        if (capacity_ <= 0)
+        {
+            return;
+        }
+
+        using Category = typename std::iterator_traits<Iter>::iterator_category;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!denseIndex_.enabled())
+        {
+            nodeMap_.reserve(capacity_);
+        }
+        if constexpr (std::is_base_of<std::random_access_iterator_tag, Category>::value)
+        {
+            // 输入长度已知时，一次性为新节点申请一整块连续内存
+            size_t count = static_cast<size_t>(std::distance(first, last));
+            nodeArena_.reserve(std::min(count, static_cast<size_t>(capacity_) - indexSize()));
+        }
+        if constexpr (std::is_base_of<std::bidirectional_iterator_tag, Category>::value)
+        {
+            // 空缓存从输入末尾倒着建链：最后capacity_个不同的key就是最终结果，前面的数据无需建节点
+            if (indexSize() == 0)
+            {
+                bulkLoadReverse(first, last, access);
+                return;
+            }
+        }
+
+        // 缓存已满时先淘汰再建节点，节点池和索引都不会超过容量
+        for (; first != last; ++first)
+        {
+            auto entry = access(*first);
+            if (!entry.first)
+            {
+                continue;
+            }
+            const auto& kv = *entry.first;
+            NodePtr node = findNode(kv.first, entry.second);
+            if (node)
+            {
+                updateExistingNode(node, kv.second);
+                continue;
+            }
+            if (indexSize() >= static_cast<size_t>(capacity_))
+            {
+                evictLeastRecent();
+            }
+            node = createNode(kv.first, kv.second, entry.second);
+            indexNode(node);
+            insertNode(node);
+        }
+    }
+
+    // 倒序建链：每个新key都插到最旧的位置，遇到已加载的key说明输入后面有更新的值，直接跳过
+    template<typename Iter, typename Access>
+    void bulkLoadReverse(Iter first, Iter last, Access access)
+    {
+        while (last != first && indexSize() < static_cast<size_t>(capacity_))
+        {
+            --last;
+            auto entry = access(*last);
+            if (!entry.first)
+            {
+                continue;
+            }
+            const auto& kv = *entry.first;
+            if (findNode(kv.first, entry.second))
+            {
+                continue;
+            }
+            NodePtr node = createNode(kv.first, kv.second, entry.second);
+            indexNode(node);
+            insertLeastRecent(node);
+        }
+    }
+
     // 链表的初始化函数
     void initializeList()
     {
         // 创建首尾虚拟节点，作为哨兵节点
-        dummyHead_ = std::make_shared<LruNodeType>(Key(), Value());
-        dummyTail_ = std::make_shared<LruNodeType>(Key(), Value());
+        dummyHead_ = new LruNodeType(nullptr);
+        dummyTail_ = new LruNodeType(nullptr);
         // 一开始的链表只包含头尾哨兵
+        resetList();
+    }
+
+    void resetList()
+    {
         dummyHead_->next_ = dummyTail_;
         dummyTail_->prev_ = dummyHead_;
     }
 
+    // 释放全部节点：沿链表迭代析构（不会像智能指针链那样递归析构），再整块归还内存池
+    void releaseNodes()
+    {
+        // 脏数据先转入待写队列，避免清空缓存时丢失修改
+        collectDirtyNodes();
+        NodePtr first = dummyHead_->next_;
+        size_t count = indexSize();
+        auto destroyLive = [first, count]() {
+            if constexpr (!std::is_trivially_destructible<Key>::value
+                          || !std::is_trivially_destructible<Value>::value)
+            {
+                NodePtr node = first;
+                for (size_t i = 0; i < count; ++i)
+                {
+                    node->payload_->~PayloadType();
+                    node = node->next_;
+                }
+            }
+        };
+
+        if (backgroundRelease_)
+        {
+            // 旧的索引也一并交给后台线程释放
+            uint64_t denseSlots = denseIndex_.slotCount();
+            nodeArena_.releaseInBackground([destroyLive, oldMap = std::move(nodeMap_),
+                                            oldDense = std::move(denseIndex_)]() mutable {
+                destroyLive();
+                NodeMap().swap(oldMap);
+                DenseNodeIndex<LruNodeType>().swap(oldDense);
+            });
+            if (denseSlots != 0)
+            {
+                nodeMap_ = NodeMap(0, resource_);
+                denseIndex_ = DenseNodeIndex<LruNodeType>(resource_);
+                denseIndex_.init(denseSlots, static_cast<size_t>(capacity_));
+            }
+            else
+            {
+                nodeMap_ = NodeMap(static_cast<size_t>(std::max(capacity_, 0)), resource_);
+                denseIndex_ = DenseNodeIndex<LruNodeType>(resource_);
+            }
+        }
+        else
+        {
+            destroyLive();
+            nodeArena_.release();
+            nodeMap_.clear();
+            denseIndex_.clear();
+        }
+        resetList();
+    }
+
     // 尝试命中节点
     void updateExistingNode(NodePtr node, const Value& value)
     {
-       node->setValue(value);
-       moveToMostRecent(node);
+       XRMS_CACHE_PHASE(ValueCopy, node->setValue(value));
+       XRMS_CACHE_PHASE(Promote, moveToMostRecent(node));
     }
 
-    void addNewNode(const Key& key, const Value& value) 
+    NodePtr addNewNode(const Key& key, const Value& value, size_t hash) 
     {
-       if (nodeMap_.size() >= capacity_) 
+       if (indexSize() >= static_cast<size_t>(capacity_)) 
        {
-           evictLeastRecent();
+           evictLeastRecentBatch(evictionBatch_, CacheProbe::EvictReason::Capacity);
        }
 
-       NodePtr newNode = std::make_shared<LruNodeType>(key, value);
-       insertNode(newNode);
-       nodeMap_[key] = newNode;
+       NodePtr newNode = XRMS_CACHE_PHASE(Alloc, createNode(key, value, hash));
+       XRMS_CACHE_PHASE(Promote, insertNode(newNode));
+       XRMS_CACHE_PHASE(IndexInsert, indexNode(newNode));
+       return newNode;
+    }
+
+    NodePtr createNode(const Key& key, const Value& value, size_t hash)
+    {
+        return nodeArena_.create(std::forward_as_tuple(key, value), hash);
+    }
+
+    void destroyNode(NodePtr node)
+    {
+        nodeArena_.destroy(node, node->payload_);
+    }
+
+    // 稠密模式下key落在直接寻址范围内时给出槽位
+    bool denseSlot(const Key& key, uint64_t& slot) const
+    {
+        if constexpr (std::is_integral<Key>::value)
+        {
+            if (!denseIndex_.enabled())
+            {
+                return false;
+            }
+            if constexpr (std::is_signed<Key>::value)
+            {
+                if (key < 0)
+                {
+                    return false;
+                }
+            }
+            uint64_t k = static_cast<uint64_t>(key);
+            if (k > denseMaxKey_)
+            {
+                return false;
+            }
+            if (denseStride_ == 1)
+            {
+                slot = k;
+                return true;
+            }
+            if (k % denseStride_ != denseResidue_)
+            {
+                return false;
+            }
+            slot = k / denseStride_;
+            return true;
+        }
+        else
+        {
+            (void)key;
+            (void)slot;
+            return false;
+        }
+    }
+
+    // 稠密范围内直接取槽位；否则先比较完整哈希值，相等时才比较key
+    NodePtr findNode(const Key& key, size_t hash) const
+    {
+        uint64_t slot;
+        if (denseSlot(key, slot))
+        {
+            return denseIndex_.find(slot);
+        }
+        return nodeMap_.find(hash, [&key](NodePtr node) { return node->payload_->key_ == key; });
+    }
+
+    void indexNode(NodePtr node)
+    {
+        uint64_t slot;
+        if (denseSlot(node->payload_->key_, slot))
+        {
+            denseIndex_.insert(slot, node);
+        }
+        else
+        {
+            nodeMap_.insert(node);
+        }
+    }
+
+    void unindexNode(NodePtr node)
+    {
+        uint64_t slot;
+        if (denseSlot(node->payload_->key_, slot))
+        {
+            denseIndex_.erase(slot);
+        }
+        else
+        {
+            nodeMap_.erase(node);
+        }
+    }
+
+    size_t indexSize() const
+    {
+        return nodeMap_.size() + denseIndex_.size();
+    }
+
+    // 插入后超过高水位且尚未通知维护线程时返回true，由调用方在锁外唤醒
+    bool requestMaintenance()
+    {
+        if (!maintainer_ || maintenanceRequested_ || indexSize() <= highWatermark_)
+        {
+            return false;
+        }
+        maintenanceRequested_ = true;
+        return true;
+    }
+
+    // 标记节点为脏：缓存中的新值取代待写队列里同一key的旧值
+    // 返回待写队列是否已攒够一批
+    bool markDirty(NodePtr node)
+    {
+        if (!node->dirty_)
+        {
+            node->dirty_ = true;
+            ++dirtyCount_;
+        }
+        if (!pendingWrites_.empty())
+        {
+            pendingWrites_.erase(node->payload_->key_);
+        }
+        return pendingWrites_.size() >= writeBatchSize_;
+    }
+
+    // 节点即将离开缓存：脏数据转入待写队列
+    void retireNode(NodePtr node)
+    {
+        if (node->dirty_)
+        {
+            pendingWrites_.insert_or_assign(node->payload_->key_, node->payload_->value_);
+            node->dirty_ = false;
+            --dirtyCount_;
+        }
+    }
+
+    // 节点被删除：丢弃未写出的修改
+    void discardDirty(NodePtr node)
+    {
+        if (node->dirty_)
+        {
+            node->dirty_ = false;
+            --dirtyCount_;
+        }
+    }
+
+    // key被删除：从待写队列和正在写入的一批中去掉，写入失败时也不会再放回待写队列
+    void dropPending(const Key& key)
+    {
+        if (!pendingWrites_.empty())
+        {
+            pendingWrites_.erase(key);
+        }
+        if (!inflightWrites_.empty())
+        {
+            inflightWrites_.erase(key);
+        }
+    }
+
+    // 把仍在缓存中的脏节点的值复制到待写队列并清除脏位
+    void collectDirtyNodes()
+    {
+        for (NodePtr node = dummyHead_->next_; dirtyCount_ > 0 && node != dummyTail_; node = node->next_)
+        {
+            retireNode(node);
+        }
+    }
+
+    // 在待写队列和正在写入的一批中查找，前者更新
+    bool findPending(const Key& key, Value& value)
+    {
+        if (!pendingWrites_.empty())
+        {
+            auto it = pendingWrites_.find(key);
+            if (it != pendingWrites_.end())
+            {
+                value = it->second;
+                return true;
+            }
+        }
+        if (!inflightWrites_.empty())
+        {
+            auto it = inflightWrites_.find(key);
+            if (it != inflightWrites_.end())
+            {
+                value = it->second;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 把待写队列整体换成正在写入的一批，在锁外写入存储；写入期间这批数据仍可被get读到
+    // 同一时间只有一批在写：淘汰触发的写回遇到正在进行的写入时直接跳过，flush则等待
+    bool writeBack(bool collectDirty)
+    {
+        std::unique_lock<std::mutex> flushLock(flushMutex_, std::defer_lock);
+        if (collectDirty)
+        {
+            flushLock.lock();
+        }
+        else if (!flushLock.try_lock())
+        {
+            return true;
+        }
+
+        Store* store = nullptr;
+        std::vector<std::pair<Key, Value>> batch;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            store = store_;
+            if (!store)
+            {
+                return true;
+            }
+            if (collectDirty)
+            {
+                collectDirtyNodes();
+            }
+            if (pendingWrites_.empty())
+            {
+                return true;
+            }
+            inflightWrites_.swap(pendingWrites_);
+            batch.assign(inflightWrites_.begin(), inflightWrites_.end());
+        }
+
+        bool ok = store->writeBatch(batch);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!ok)
+        {
+            // 写入期间产生的更新比失败的这批新，不覆盖
+            for (auto& entry : inflightWrites_)
+            {
+                pendingWrites_.try_emplace(entry.first, std::move(entry.second));
+            }
+        }
+        inflightWrites_.clear();
+        return ok;
     }
     // 将该节点移动到最新位置
     // 最新使用的节点要置于尾部
@@ -178,21 +1029,107 @@ private:
         dummyTail_->prev_ = node;
     }
 
+    // 插到链表头部，即最旧的位置（仅倒序批量加载使用）
+    void insertLeastRecent(NodePtr node)
+    {
+        node->prev_ = dummyHead_;
+        node->next_ = dummyHead_->next_;
+        dummyHead_->next_->prev_ = node;
+        dummyHead_->next_ = node;
+    }
+
     // 驱逐最近最少访问
     void evictLeastRecent()
     {
         NodePtr leastRecent = dummyHead_->next_;
-        removeNode(leastRecent);
-        // 从哈希表中删除
-        nodeMap_.erase(leastRecent->getKey());
+        XRMS_CACHE_PROBE_EVICT(this, leastRecent->payload_->key_, CacheProbe::EvictReason::Capacity);
+        retireNode(leastRecent);
+        XRMS_CACHE_PHASE(Victim, removeNode(leastRecent));
+        // 按节点记录的槽位从索引中删除
+        XRMS_CACHE_PHASE(IndexErase, unindexNode(leastRecent));
+        XRMS_CACHE_PHASE(Alloc, destroyNode(leastRecent));
+        if (stats_)
+        {
+            CacheStats::bump(stats_->evictions);
+        }
+    }
+
+    // 一次淘汰最久未使用的count个节点：先沿链表找到整段并一次性摘下，再逐个按槽位从索引删除、归还内存池
+    // 删除阶段预取下一个节点
+    void evictLeastRecentBatch(size_t count, CacheProbe::EvictReason reason)
+    {
+        count = std::min(count, indexSize());
+        if (count == 0)
+        {
+            return;
+        }
+        XRMS_CACHE_PHASE(Victim, detachLeastRecent(count));
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (i + 1 < count)
+            {
+                __builtin_prefetch(victims_[i + 1], 1);
+            }
+            NodePtr victim = victims_[i];
+            XRMS_CACHE_PROBE_EVICT(this, victim->payload_->key_, reason);
+            retireNode(victim);
+            XRMS_CACHE_PHASE(IndexErase, unindexNode(victim));
+            XRMS_CACHE_PHASE(Alloc, destroyNode(victim));
+        }
+        if (stats_)
+        {
+            stats_->evictions.fetch_add(count, std::memory_order_relaxed);
+            stats_->setEntries(indexSize());
+        }
+    }
+
+    // 沿链表取出最久未使用的count个节点放入victims_，并把这一段从链表上整体摘下
+    void detachLeastRecent(size_t count)
+    {
+        victims_.clear();
+        NodePtr node = dummyHead_->next_;
+        for (size_t i = 0; i < count; ++i)
+        {
+            victims_.push_back(node);
+            node = node->next_;
+        }
+        dummyHead_->next_ = node;
+        node->prev_ = dummyHead_;
     }
 
 private:
+    static constexpr size_t kMaintainBatch = 256;  // 后台维护每次加锁最多淘汰的节点数
+
     int         capacity_;  // 缓存容量
-    NodeMap     nodeMap_;   // key->Node
+    NodeMap     nodeMap_;   // key->Node，按节点中保存的哈希值定位
+    DenseNodeIndex<LruNodeType> denseIndex_;    // 稠密整数key的直接寻址索引，未开启时为空
+    uint64_t    denseMaxKey_ = 0;               // 直接寻址的key上界（含）
+    size_t      denseStride_ = 1;               // 本缓存的key模denseStride_同余于denseResidue_
+    size_t      denseResidue_ = 0;
     std::mutex  mutex_;     // 
     NodePtr     dummyHead_; // 头节点哨兵
     NodePtr     dummyTail_; // 尾节点哨兵 
+    SplitNodeArena<LruNodeType, PayloadType> nodeArena_;  // 节点内存池，热节点和key/value分开存放
+    std::pmr::memory_resource* resource_;   // 节点和索引的内存来源，为空时用malloc
+    CacheWeigher<Key, Value> weigher_;      // 统计values的权重函数，为空时用默认估计
+    bool        backgroundRelease_ = false; // 是否在后台线程中释放节点
+    size_t      evictionBatch_ = 1;         // 缓存满时一次淘汰的节点数
+    std::vector<NodePtr> victims_;          // 批量淘汰时暂存待淘汰节点，复用避免每次分配
+    std::shared_ptr<CacheStats> stats_;     // 运行指标，为空表示不统计
+
+    Store*      store_ = nullptr;           // 写回模式的后端存储，为空表示未开启写回
+    size_t      writeBatchSize_ = 64;       // 待写队列攒够多少条触发一次写回
+    size_t      dirtyCount_ = 0;            // 缓存中的脏节点数
+    std::unordered_map<Key, Value, Hasher> pendingWrites_;  // 已离开缓存或被flush摘下、尚未写出的脏数据
+    std::unordered_map<Key, Value, Hasher> inflightWrites_; // 正在写入存储的一批
+    std::mutex  flushMutex_;                // 保证同一时间只有一批在写
+
+    CacheMaintainer* maintainer_ = nullptr; // 后台维护线程池，为空表示淘汰全部在前台进行
+    size_t      maintainerTask_ = 0;        // 在维护线程池中的任务编号
+    size_t      lowWatermark_ = 0;          // 后台淘汰的目标条目数
+    size_t      highWatermark_ = 0;         // 超过该条目数时唤醒后台淘汰
+    bool        maintenanceRequested_ = false;  // 已唤醒维护线程，尚未处理
 };
 
 // LRU-k算法是对LRU算法的改进，基础的LRU算法被访问数据进入缓存队列只需要访问(put、get)一次就行，
@@ -204,50 +1141,69 @@ private:
 // 同时访问历史队列中的数据也不是一直保留的，也是需要按照LRU的规则进行淘汰的。
 
 // LRU优化：Lru-k版本。 通过继承的方式进行再优化
-template<typename Key, typename Value>
-class LruKCache : public LruCache<Key, Value>
+template<typename Key, typename Value, typename Hasher = CacheHash<Key>>
+class LruKCache : public LruCache<Key, Value, Hasher>
 {
 public:
-    LruKCache(int capacity, int historyCapacity, int k)
-        : LruCache<Key, Value>(capacity)  // 调用基类构造
-        , historyList_(std::make_unique<LruCache<Key, size_t>>)
+    LruKCache(int capacity, int historyCapacity, int k, std::pmr::memory_resource* resource = nullptr)
+        : LruCache<Key, Value, Hasher>(capacity, resource)  // 调用基类构造
         , k_(k)
+        , historyList_(std::make_unique<LruCache<Key, size_t, Hasher>>(historyCapacity, resource))
         {}
 
-    // LRU-k算法的get方法
-    Value get(Key key)
+    // LRU-k算法的get方法：无论是否命中，都计入访问历史
+    bool get(Key key, Value& value) override
     {
         // 从访问历史队列中获取该数据的访问次数
-        int historyCount = historyList_->get(key);
+        size_t historyCount = historyList_->get(key);
         // 如果访问到数据，更新历史访问记录节点值count++
         historyList_->put(key, historyCount + 1);
 
         // 从缓存中获取数据，不一定能获取到，因为可能不在缓存中
-        return LruCache<Key, Value>::get(key);
+        return LruCache<Key, Value, Hasher>::get(key, value);
     }
 
-    void put(Key key, Value value)
+    Value get(Key key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    void put(Key key, Value value) override
     {
         // 先判断是否存在于缓存中，如果存在则直接覆盖，不存在的话不能直接添加到缓存中
-        if (LruCache<Key, Value>::get(key) != " ")
-            LruCache<Key, Value>::put(key, value);
-        
+        Value existing;
+        if (LruCache<Key, Value, Hasher>::get(key, existing))
+        {
+            LruCache<Key, Value, Hasher>::put(key, value);
+            return;
+        }
+
         // 只有数据的历史访问次数达到上限才添加到缓存中
-        int historyCount = historyList_->get(key);
+        size_t historyCount = historyList_->get(key);
         historyList_->put(key, historyCount + 1);
         // 如果历史访问次数达到上限，就将数据添加到缓存中
-        if (historyCount >= k_)
+        if (historyCount >= static_cast<size_t>(k_))
         {
             // 先移除历史访问记录
             historyList_->remove(key);
             // 再添加到缓存中
-            LruCache<Key, Value>::put(key, value);
+            LruCache<Key, Value, Hasher>::put(key, value);
         }
     }
 
+    // 访问历史队列整体计入ghost
+    CacheMemoryUsage memoryUsage()
+    {
+        CacheMemoryUsage usage = LruCache<Key, Value, Hasher>::memoryUsage();
+        usage.ghost += historyList_->memoryUsage().total();
+        return usage;
+    }
+
 private:
     int k_;   // 进入缓存队列的访问次数上限 一般置为2
-    std::unique_ptr<LruCache<Key, size_t>> historyList_; // 访问历史队列
+    std::unique_ptr<LruCache<Key, size_t, Hasher>> historyList_; // 访问历史队列
 };
 
 
@@ -262,11 +1218,12 @@ private:
  */
 
 // LRU优化：对LRU进行分片，可以提高高并发使用的性能
-template<typename Key, typename Value>
+template<typename Key, typename Value, typename Hasher = CacheHash<Key>>
 class HashLruCaches
 {
 public:
-    HashLruCaches(size_t capacity, int sliceNum)
+    // resource为所有分片节点和索引的内存来源，为空时用malloc
+    HashLruCaches(size_t capacity, int sliceNum, std::pmr::memory_resource* resource = nullptr)
         : capacity_(capacity)
           // 若传入值为0，则初始化为当前系统的硬件并发线程数，通过hardware_concurrecy获取
         , sliceNum_(sliceNum > 0? sliceNum : std::thread::hardware_concurrency())
@@ -276,25 +1233,48 @@ public:
         for (int i = 0; i < sliceNum_; ++i)
         {
             // 加强版pushback 也就是在把obj加入vec之前才new这个obj
-            lruSliceCaches_.emplace_back(new LruCache<Key, Value>(sliceSize));
+            lruSliceCaches_.emplace_back(new LruCache<Key, Value, Hasher>(sliceSize, resource));
+        }
+    }
+
+    // 稠密整数key：[0, maxKey]内的key按 key % 分片数 分片，每个分片以 key / 分片数 直接寻址，
+    // 范围外的key仍按哈希分片、走分片内的哈希索引
+    template<typename K = Key, typename = std::enable_if_t<std::is_integral<K>::value>>
+    HashLruCaches(size_t capacity, int sliceNum, Key maxKey, std::pmr::memory_resource* resource = nullptr)
+        : HashLruCaches(capacity, sliceNum, resource)
+    {
+        if (maxKey < 0)
+        {
+            return;
+        }
+        dense_ = true;
+        denseMaxKey_ = static_cast<uint64_t>(maxKey);
+        for (int i = 0; i < sliceNum_; ++i)
+        {
+            lruSliceCaches_[i]->setDenseKeys(maxKey, static_cast<size_t>(sliceNum_), static_cast<size_t>(i));
         }
     }
 
+    ~HashLruCaches()
+    {
+        stopFlusher();
+    }
+
     // HashLru中的put方法
     void put(Key key, Value value)
     {
         // 获取key的hash值， 并计算出对应的分片索引
-        size_t sliceIndex = Hash(key) % sliceNum_;
-        // 再调用该切片上的lru块的put方法
-        return lruSliceCaches_[sliceIndex]->put(key, value);
+        size_t hash = Hash(key);
+        // 再调用该切片上的lru块的put方法，分片内的索引复用同一个哈希值
+        return lruSliceCaches_[sliceIndexOf(key, hash)]->put(key, value, hash);
     }
 
     // HashLru中的get方法
     bool get(Key key, Value& value)
     {
         // 获取key的hash值，并计算出对应的分片索引
-        size_t sliceIndex = Hash(key) % sliceNum_;
-        return lruSliceCaches_[sliceIndex]->get(key, value);
+        size_t hash = Hash(key);
+        return lruSliceCaches_[sliceIndexOf(key, hash)]->get(key, value, hash);
     }
 
     Value get(Key key)
@@ -310,20 +1290,237 @@ public:
         return value;
     }
 
+    // 删除指定元素，写回模式下的语义见LruCache::remove
+    void remove(Key key)
+    {
+        size_t hash = Hash(key);
+        lruSliceCaches_[sliceIndexOf(key, hash)]->remove(key, hash);
+    }
+
+    // 提前淘汰指定元素，见LruCache::evict
+    void evict(Key key)
+    {
+        size_t hash = Hash(key);
+        lruSliceCaches_[sliceIndexOf(key, hash)]->evict(key, hash);
+    }
+
+    // 批量执行：按分片分组后每个分片只加一次锁，同一分片内保持操作的原始顺序
+    void applyBatch(std::vector<typename LruCache<Key, Value, Hasher>::BatchOp>& ops)
+    {
+        using BatchOp = typename LruCache<Key, Value, Hasher>::BatchOp;
+        if (ops.empty())
+        {
+            return;
+        }
+
+        // 计数排序：先统计每个分片的操作数，再把操作指针稳定地放到各分片的区间里
+        std::vector<uint32_t> sliceOf(ops.size());
+        std::vector<size_t> offsets(sliceNum_ + 1, 0);
+        for (size_t i = 0; i < ops.size(); ++i)
+        {
+            ops[i].hash = Hash(ops[i].key);
+            sliceOf[i] = static_cast<uint32_t>(sliceIndexOf(ops[i].key, ops[i].hash));
+            ++offsets[sliceOf[i] + 1];
+        }
+        for (int i = 0; i < sliceNum_; ++i)
+        {
+            offsets[i + 1] += offsets[i];
+        }
+        std::vector<BatchOp*> grouped(ops.size());
+        std::vector<size_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < ops.size(); ++i)
+        {
+            grouped[cursor[sliceOf[i]]++] = &ops[i];
+        }
+
+        for (int i = 0; i < sliceNum_; ++i)
+        {
+            lruSliceCaches_[i]->applyBatch(grouped.data() + offsets[i], offsets[i + 1] - offsets[i], true);
+        }
+    }
+
+    // 清空所有分片
+    void clear()
+    {
+        for (auto& slice : lruSliceCaches_)
+        {
+            slice->clear();
+        }
+    }
+
+    // 清空和析构时是否在后台线程中释放节点，resourceThreadSafe的含义同LruCache；任一分片拒绝时返回false
+    bool setBackgroundRelease(bool enable, bool resourceThreadSafe = false)
+    {
+        bool accepted = true;
+        for (auto& slice : lruSliceCaches_)
+        {
+            accepted = slice->setBackgroundRelease(enable, resourceThreadSafe) && accepted;
+        }
+        return accepted;
+    }
+
+    // 各分片内存占用之和，逐个分片加锁统计
+    CacheMemoryUsage memoryUsage()
+    {
+        CacheMemoryUsage usage;
+        for (auto& slice : lruSliceCaches_)
+        {
+            usage += slice->memoryUsage();
+        }
+        return usage;
+    }
+
+    void setWeigher(CacheWeigher<Key, Value> weigher)
+    {
+        for (auto& slice : lruSliceCaches_)
+        {
+            slice->setWeigher(weigher);
+        }
+    }
+
+    // 每个分片在metrics中登记一组指标（标签cache=name, shard=分片号），
+    // estimateMrc为true时各分片共用一个未命中率曲线估计；需在并发访问开始之前调用
+    void setMetrics(CacheMetrics& metrics, const std::string& name, bool estimateMrc = true)
+    {
+        std::shared_ptr<MissRatioEstimator> mrc;
+        if (estimateMrc)
+        {
+            mrc = metrics.addEstimator(name, capacity_ * 4);
+        }
+        for (int i = 0; i < sliceNum_; ++i)
+        {
+            std::shared_ptr<CacheStats> stats = metrics.addStats(name, i);
+            stats->mrc = mrc;
+            lruSliceCaches_[i]->setStats(std::move(stats));
+        }
+    }
+
+    // 所有分片开启写回模式，flushInterval大于0时由后台线程按该间隔定期flush
+    // 传nullptr关闭写回
+    void setWriteBack(BackingStore<Key, Value>* store, size_t batchSize = 64,
+                      std::chrono::milliseconds flushInterval = std::chrono::milliseconds(1000))
+    {
+        stopFlusher();
+        for (auto& slice : lruSliceCaches_)
+        {
+            slice->setWriteBack(store, batchSize);
+        }
+        if (store && flushInterval.count() > 0)
+        {
+            stopFlusher_ = false;
+            flusher_ = std::thread([this, flushInterval]() {
+                std::unique_lock<std::mutex> lock(flusherMutex_);
+                while (!flusherCond_.wait_for(lock, flushInterval, [this]() { return stopFlusher_; }))
+                {
+                    lock.unlock();
+                    flush();
+                    lock.lock();
+                }
+            });
+        }
+    }
+
+    // 所有分片交给同一个维护线程池，水位按分片容量的比例计算；传nullptr取消
+    void setMaintainer(CacheMaintainer* maintainer, double lowRatio = 0.9, double highRatio = 0.95)
+    {
+        size_t sliceSize = std::ceil(capacity_ / static_cast<double>(sliceNum_));
+        for (auto& slice : lruSliceCaches_)
+        {
+            slice->setMaintainer(maintainer, static_cast<size_t>(sliceSize * lowRatio),
+                                 static_cast<size_t>(sliceSize * highRatio));
+        }
+    }
+
+    // 所有分片的批量淘汰大小
+    void setEvictionBatch(size_t batch)
+    {
+        for (auto& slice : lruSliceCaches_)
+        {
+            slice->setEvictionBatch(batch);
+        }
+    }
+
+    // 逐个分片把脏数据写回存储，全部成功时返回true
+    bool flush()
+    {
+        bool ok = true;
+        for (auto& slice : lruSliceCaches_)
+        {
+            ok = slice->flush() && ok;
+        }
+        return ok;
+    }
+
+    // 并行批量加载：先单线程扫描一遍输入，按分片分桶记下每项的哈希和地址，
+    // 再由不超过硬件线程数的线程各自认领分片建链，分片内直接复用算好的哈希
+    // range须是元素可取地址的容器，加载期间不能修改
+    template<typename Range>
+    void bulkLoad(const Range& range)
+    {
+        using Entry = typename std::remove_reference<decltype(*std::begin(range))>::type;
+        std::vector<std::vector<std::pair<size_t, const Entry*>>> buckets(sliceNum_);
+        for (const auto& kv : range)
+        {
+            size_t hash = Hash(kv.first);
+            buckets[sliceIndexOf(kv.first, hash)].emplace_back(hash, &kv);
+        }
+        forEachSliceParallel(sliceNum_, [this, &buckets](size_t i) {
+            lruSliceCaches_[i]->bulkLoadHashed(buckets[i]);
+        });
+    }
+
 private:
     // 将key转换为对应的hash值
-    size_t Hash(Key key)
+    size_t Hash(const Key& key)
     {
-        std::hash<Key> hashFunc;
-        return hashFunc(key);
+        return LruCache<Key, Value, Hasher>::hashOf(key);
+    }
+
+    // 稠密模式下范围内的key按key取模分片，与分片内的直接寻址槽位对应；其余按哈希分片
+    size_t sliceIndexOf(const Key& key, size_t hash) const
+    {
+        if constexpr (std::is_integral<Key>::value)
+        {
+            bool negative = false;
+            if constexpr (std::is_signed<Key>::value)
+            {
+                negative = key < 0;
+            }
+            if (dense_ && !negative && static_cast<uint64_t>(key) <= denseMaxKey_)
+            {
+                return static_cast<size_t>(static_cast<uint64_t>(key) % sliceNum_);
+            }
+        }
+        return hash % sliceNum_;
+    }
+
+    void stopFlusher()
+    {
+        if (!flusher_.joinable())
+        {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(flusherMutex_);
+            stopFlusher_ = true;
+        }
+        flusherCond_.notify_all();
+        flusher_.join();
     }
 
 private:
     size_t  capacity_; // 总容量
     int     sliceNum_; //切片数量
+    bool    dense_ = false;         // 是否开启稠密整数key模式
+    uint64_t denseMaxKey_ = 0;      // 稠密模式下直接寻址的key上界（含）
     // 这里声明了一个LruCache类型的智能指针数组。HashLruCaches将多个LruCache对象组合在一起，形成一个整体。
     // 因此这里两个类是组合关系，HashCaches依赖于LruCache
-    std::vector<std::unique_ptr<LruCache<Key, Value>>> lruSliceCaches_; // 切片lru缓存
+    std::vector<std::unique_ptr<LruCache<Key, Value, Hasher>>> lruSliceCaches_; // 切片lru缓存
+
+    std::thread             flusher_;           // 写回模式下定期flush的后台线程
+    std::mutex              flusherMutex_;
+    std::condition_variable flusherCond_;
+    bool                    stopFlusher_ = false;
 };
 
 }  // namespace JazhCache
\ No newline at end of file
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "CacheMetrics.h"
+
+namespace XrmsCache
+{
+
+/*
+ * MetricsExporter 以Prometheus文本格式对外提供缓存指标的HTTP端点
+ * 后台线程监听一个TCP端口，GET /metrics 返回CacheMetrics::render()的内容，其他路径返回404。
+ * 请求逐个处理、每次回复后关闭连接，只面向抓取程序，不追求并发；
+ * 生成回复只读各缓存统计中的原子计数，不获取任何分片锁。
+ * 默认只监听127.0.0.1，port为0时由系统分配端口，可通过port()取得。
+ */
+class MetricsExporter
+{
+public:
+    MetricsExporter(const CacheMetrics& metrics, uint16_t port, const std::string& address = "127.0.0.1")
+        : MetricsExporter([&metrics]() { return metrics.render(); }, port, address)
+    {}
+
+    // render在导出线程中调用，返回完整的指标文本
+    MetricsExporter(std::function<std::string()> render, uint16_t port, const std::string& address = "127.0.0.1")
+        : render_(std::move(render))
+    {
+        listenFd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (listenFd_ < 0)
+        {
+            throw std::runtime_error(std::string("MetricsExporter: socket: ") + std::strerror(errno));
+        }
+        int on = 1;
+        ::setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        if (::inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1)
+        {
+            ::close(listenFd_);
+            throw std::runtime_error("MetricsExporter: bad address " + address);
+        }
+        if (::bind(listenFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(listenFd_, 16) != 0)
+        {
+            int err = errno;
+            ::close(listenFd_);
+            throw std::runtime_error("MetricsExporter: listen on " + address + ":" + std::to_string(port) + ": "
+                                     + std::strerror(err));
+        }
+        socklen_t len = sizeof(addr);
+        ::getsockname(listenFd_, reinterpret_cast<sockaddr*>(&addr), &len);
+        port_ = ntohs(addr.sin_port);
+
+        // 自管道：stop()写入一个字节唤醒poll
+        if (::pipe(wakeFds_) != 0)
+        {
+            int err = errno;
+            ::close(listenFd_);
+            throw std::runtime_error(std::string("MetricsExporter: pipe: ") + std::strerror(err));
+        }
+        thread_ = std::thread([this]() { run(); });
+    }
+
+    ~MetricsExporter()
+    {
+        stop();
+        if (thread_.joinable())
+        {
+            thread_.join();
+        }
+        ::close(listenFd_);
+        ::close(wakeFds_[0]);
+        ::close(wakeFds_[1]);
+    }
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    uint16_t port() const { return port_; }
+
+    // 已回复的请求数
+    uint64_t served() const { return served_.load(std::memory_order_relaxed); }
+
+    void stop()
+    {
+        if (!stopping_.exchange(true))
+        {
+            char byte = 0;
+            ssize_t n = ::write(wakeFds_[1], &byte, 1);
+            (void)n;
+        }
+    }
+
+private:
+    static constexpr size_t kMaxRequestBytes = 8192;
+    static constexpr int kReadTimeoutMs = 2000;
+
+    void run()
+    {
+        pollfd fds[2] = {{listenFd_, POLLIN, 0}, {wakeFds_[0], POLLIN, 0}};
+        while (!stopping_.load())
+        {
+            if (::poll(fds, 2, -1) < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                break;
+            }
+            if (fds[1].revents)
+            {
+                break;
+            }
+            if (fds[0].revents & POLLIN)
+            {
+                int fd = ::accept(listenFd_, nullptr, nullptr);
+                if (fd >= 0)
+                {
+                    serve(fd);
+                    ::close(fd);
+                }
+            }
+        }
+    }
+
+    // 读到请求头结束为止，只看请求行
+    void serve(int fd)
+    {
+        std::string request;
+        char buffer[1024];
+        while (request.find("\r\n\r\n") == std::string::npos && request.size() < kMaxRequestBytes)
+        {
+            pollfd pfd{fd, POLLIN, 0};
+            if (::poll(&pfd, 1, kReadTimeoutMs) <= 0)
+            {
+                return;
+            }
+            ssize_t n = ::read(fd, buffer, sizeof(buffer));
+            if (n <= 0)
+            {
+                return;
+            }
+            request.append(buffer, static_cast<size_t>(n));
+        }
+
+        std::string line = request.substr(0, request.find("\r\n"));
+        if (line.compare(0, 13, "GET /metrics ") == 0 || line.compare(0, 14, "HEAD /metrics ") == 0)
+        {
+            std::string body = render_();
+            respond(fd, "200 OK", "text/plain; version=0.0.4; charset=utf-8", body, line[0] == 'H');
+        }
+        else if (line.compare(0, 4, "GET ") == 0 || line.compare(0, 5, "HEAD ") == 0)
+        {
+            respond(fd, "404 Not Found", "text/plain; charset=utf-8", "not found\n", false);
+        }
+        else
+        {
+            respond(fd, "405 Method Not Allowed", "text/plain; charset=utf-8", "method not allowed\n", false);
+        }
+        served_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void respond(int fd, const char* status, const char* contentType, const std::string& body, bool headOnly)
+    {
+        std::string response = std::string("HTTP/1.1 ") + status + "\r\nContent-Type: " + contentType
+            + "\r\nContent-Length: " + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n";
+        if (!headOnly)
+        {
+            response += body;
+        }
+        size_t sent = 0;
+        while (sent < response.size())
+        {
+            ssize_t n = ::send(fd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0)
+            {
+                if (n < 0 && errno == EINTR)
+                    continue;
+                return;
+            }
+            sent += static_cast<size_t>(n);
+        }
+    }
+
+    std::function<std::string()> render_;
+    int listenFd_ = -1;
+    int wakeFds_[2] = {-1, -1};
+    uint16_t port_ = 0;
+    std::atomic<bool> stopping_{false};
+    std::atomic<uint64_t> served_{0};
+    std::thread thread_;
+};
+
+}   // namespace XrmsCache
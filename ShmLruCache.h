@@ -0,0 +1,722 @@
+#pragma once
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+#include "CacheHash.h"
+#include "ICachePolicy.h"
+
+// 跨进程共享内存LRU缓存
+namespace XrmsCache
+{
+
+/*
+ * ShmLruCache 同一台机器上多个进程共享的一份LRU缓存
+ * 整个缓存放在一段POSIX共享内存(shm_open + mmap)中，段内不保存任何指针：
+ * 节点之间的链接、哈希桶、空闲链表全部使用下标，因此各进程把段映射到不同地址也能直接使用。
+ * 每个分片一把进程间共享的健壮互斥锁(PTHREAD_MUTEX_ROBUST)。持锁进程崩溃后，
+ * 下一个加锁的进程会收到EOWNERDEAD，若崩溃发生在修改过程中就按节点的占用标志重建该分片，
+ * 正在写入的那个节点直接丢弃，其余数据保留（最近使用顺序按槽位顺序近似恢复）。
+ *
+ * Key和Value必须是可平凡拷贝的类型（整数、定长结构体、定长字符数组等），
+ * 且所有进程需使用同一份程序构建：段头会校验Key/Value的大小和分片参数，哈希函数必须一致。
+ */
+template<typename Key, typename Value, typename Hasher = CacheHash<Key>>
+class ShmLruCache : public ICachePolicy<Key, Value>
+{
+    static_assert(std::is_trivially_copyable<Key>::value, "ShmLruCache requires a trivially copyable Key");
+    static_assert(std::is_trivially_copyable<Value>::value, "ShmLruCache requires a trivially copyable Value");
+
+public:
+    // 打开名为name的共享内存段，不存在则按给定的分片数和每分片容量创建
+    // 已存在的段必须与参数一致，否则抛出std::runtime_error
+    ShmLruCache(const std::string& name, uint32_t sliceNum, uint32_t sliceCapacity)
+        : name_(name)
+    {
+        if (sliceNum == 0 || sliceCapacity == 0)
+        {
+            throw std::invalid_argument("ShmLruCache: sliceNum and sliceCapacity must be positive");
+        }
+        layout_ = computeLayout(sliceNum, sliceCapacity);
+        attach();
+    }
+
+    ~ShmLruCache() override
+    {
+        if (base_)
+        {
+            ::munmap(base_, layout_.totalSize);
+        }
+    }
+
+    ShmLruCache(const ShmLruCache&) = delete;
+    ShmLruCache& operator=(const ShmLruCache&) = delete;
+
+    // 删除共享内存段的名字，已映射的进程不受影响，最后一个进程解除映射后内存才真正释放
+    static void unlink(const std::string& name)
+    {
+        ::shm_unlink(name.c_str());
+    }
+
+    void put(Key key, Value value) override
+    {
+        uint64_t hash = hashOf(key);
+        Slice& slice = sliceOf(hash);
+        SliceLock lock(*this, slice);
+
+        uint32_t index = find(slice, key, hash);
+        beginMutation(slice, index);
+        if (index != NIL)
+        {
+            Node& node = nodeAt(slice, index);
+            node.value = value;
+            moveToMostRecent(slice, index);
+        }
+        else
+        {
+            if (slice.freeHead == NIL)
+            {
+                evictLeastRecent(slice);
+            }
+            index = slice.freeHead;
+            Node& node = nodeAt(slice, index);
+            slice.freeHead = node.next;
+            slice.pendingNode = index;
+            node.key = key;
+            node.value = value;
+            node.hash = hash;
+            linkBucket(slice, index);
+            linkMostRecent(slice, index);
+            node.used = 1;
+            ++slice.size;
+        }
+        endMutation(slice);
+    }
+
+    bool get(Key key, Value& value) override
+    {
+        uint64_t hash = hashOf(key);
+        Slice& slice = sliceOf(hash);
+        SliceLock lock(*this, slice);
+
+        uint32_t index = find(slice, key, hash);
+        if (index == NIL)
+        {
+            return false;
+        }
+        value = nodeAt(slice, index).value;
+        beginMutation(slice, NIL);
+        moveToMostRecent(slice, index);
+        endMutation(slice);
+        return true;
+    }
+
+    Value get(Key key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 删除指定元素
+    void remove(Key key)
+    {
+        uint64_t hash = hashOf(key);
+        Slice& slice = sliceOf(hash);
+        SliceLock lock(*this, slice);
+
+        uint32_t index = find(slice, key, hash);
+        if (index != NIL)
+        {
+            beginMutation(slice, index);
+            releaseNode(slice, index);
+            endMutation(slice);
+        }
+    }
+
+    // 清空所有分片
+    void clear()
+    {
+        for (uint32_t i = 0; i < layout_.sliceNum; ++i)
+        {
+            Slice& slice = sliceAt(i);
+            SliceLock lock(*this, slice);
+            beginMutation(slice, NIL);
+            resetSlice(slice);
+            endMutation(slice);
+        }
+    }
+
+    // 当前缓存的条目总数
+    size_t size()
+    {
+        size_t total = 0;
+        for (uint32_t i = 0; i < layout_.sliceNum; ++i)
+        {
+            Slice& slice = sliceAt(i);
+            SliceLock lock(*this, slice);
+            total += slice.size;
+        }
+        return total;
+    }
+
+    // 逐个分片检查链表、哈希桶与计数是否自洽，用于崩溃恢复后的校验
+    bool verify()
+    {
+        for (uint32_t i = 0; i < layout_.sliceNum; ++i)
+        {
+            Slice& slice = sliceAt(i);
+            SliceLock lock(*this, slice);
+            uint32_t count = 0;
+            uint32_t prev = NIL;
+            for (uint32_t index = slice.head; index != NIL; index = nodeAt(slice, index).next)
+            {
+                const Node& node = nodeAt(slice, index);
+                if (!node.used || node.prev != prev || find(slice, node.key, node.hash) != index
+                    || ++count > layout_.sliceCapacity)
+                {
+                    return false;
+                }
+                prev = index;
+            }
+            if (prev != slice.tail || count != slice.size)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 段创建以来，所有进程因持锁进程崩溃而重建分片的总次数
+    uint64_t recoveredSlices() const { return header_->recoveredSlices.load(std::memory_order_relaxed); }
+
+    // 故障注入，只在准备丢弃的子进程中调用：按put的步骤写入新key，节点已挂入哈希桶和LRU链表、
+    // 但尚未置占用标志和更新计数时直接_exit，持锁退出，模拟持锁进程在修改中途崩溃
+    [[noreturn]] void crashDuringPut(Key key, Value value)
+    {
+        uint64_t hash = hashOf(key);
+        Slice& slice = sliceOf(hash);
+        SliceLock lock(*this, slice);
+        if (find(slice, key, hash) == NIL)
+        {
+            beginMutation(slice, NIL);
+            if (slice.freeHead == NIL)
+            {
+                evictLeastRecent(slice);
+            }
+            uint32_t index = slice.freeHead;
+            Node& node = nodeAt(slice, index);
+            slice.freeHead = node.next;
+            slice.pendingNode = index;
+            node.key = key;
+            node.value = value;
+            node.hash = hash;
+            linkBucket(slice, index);
+            linkMostRecent(slice, index);
+        }
+        ::_exit(0);
+    }
+
+private:
+    static constexpr uint32_t NIL = 0xffffffffu;
+    static constexpr uint64_t MAGIC = 0x584d5253484d4c52ull;  // "XMRSHMLR"
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t STATE_EMPTY = 0;
+    static constexpr uint32_t STATE_INITIALIZING = 1;
+    static constexpr uint32_t STATE_READY = 2;
+
+    struct Node
+    {
+        Key      key;
+        Value    value;
+        uint64_t hash;
+        uint32_t prev;      // LRU链表，head为最久未使用
+        uint32_t next;      // LRU链表；节点空闲时作为空闲链表的next
+        uint32_t chain;     // 同一哈希桶中的下一个节点
+        uint32_t used;      // 节点完整写入后置1，崩溃恢复据此判断节点是否有效
+    };
+
+    struct alignas(64) Slice
+    {
+        pthread_mutex_t mutex;
+        std::atomic<uint32_t> dirty;    // 正在修改中，持锁进程在此期间崩溃需要重建分片
+        uint32_t pendingNode;           // 修改中正在写入的节点，重建时丢弃
+        uint32_t head;
+        uint32_t tail;
+        uint32_t freeHead;
+        uint32_t size;
+    };
+
+    struct Header
+    {
+        uint64_t magic;
+        uint32_t version;
+        std::atomic<uint32_t> state;
+        std::atomic<int32_t> initPid;   // 正在初始化段的进程，用于发现初始化中途崩溃；接管时对它做CAS
+        uint32_t keySize;
+        uint32_t valueSize;
+        uint32_t sliceNum;
+        uint32_t sliceCapacity;
+        uint32_t bucketCount;
+        uint64_t totalSize;
+        std::atomic<uint64_t> recoveredSlices;
+    };
+
+    // 段内布局：段头 | 分片头数组 | 每个分片的(哈希桶数组, 节点数组)
+    struct Layout
+    {
+        uint32_t sliceNum;
+        uint32_t sliceCapacity;
+        uint32_t bucketCount;
+        size_t   slicesOffset;
+        size_t   sliceDataOffset;
+        size_t   sliceDataSize;
+        size_t   nodesOffset;   // 相对分片数据起点
+        size_t   totalSize;
+    };
+
+    static size_t alignUp(size_t n, size_t align) { return (n + align - 1) / align * align; }
+
+    static Layout computeLayout(uint32_t sliceNum, uint32_t sliceCapacity)
+    {
+        Layout layout;
+        layout.sliceNum = sliceNum;
+        layout.sliceCapacity = sliceCapacity;
+        layout.bucketCount = 1;
+        while (layout.bucketCount < sliceCapacity)
+        {
+            layout.bucketCount <<= 1;
+        }
+        layout.slicesOffset = alignUp(sizeof(Header), 64);
+        layout.sliceDataOffset = alignUp(layout.slicesOffset + sizeof(Slice) * sliceNum, 64);
+        layout.nodesOffset = alignUp(sizeof(uint32_t) * layout.bucketCount, alignof(Node));
+        layout.sliceDataSize = alignUp(layout.nodesOffset + sizeof(Node) * sliceCapacity, 64);
+        layout.totalSize = layout.sliceDataOffset + layout.sliceDataSize * sliceNum;
+        return layout;
+    }
+
+    // 加锁时处理持锁进程崩溃的情况
+    class SliceLock
+    {
+    public:
+        SliceLock(ShmLruCache& cache, Slice& slice) : slice_(slice)
+        {
+            int rc = ::pthread_mutex_lock(&slice.mutex);
+            if (rc == EOWNERDEAD)
+            {
+                if (slice.dirty.load(std::memory_order_acquire))
+                {
+                    cache.rebuildSlice(slice);
+                }
+                ::pthread_mutex_consistent(&slice.mutex);
+            }
+            else if (rc != 0)
+            {
+                throw std::runtime_error(std::string("ShmLruCache: lock failed: ") + std::strerror(rc));
+            }
+        }
+
+        ~SliceLock() { ::pthread_mutex_unlock(&slice_.mutex); }
+
+    private:
+        Slice& slice_;
+    };
+
+    void attach()
+    {
+        int fd = ::shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        bool creator = fd >= 0;
+        if (!creator)
+        {
+            if (errno != EEXIST)
+            {
+                throwErrno("shm_open");
+            }
+            fd = ::shm_open(name_.c_str(), O_RDWR, 0600);
+            if (fd < 0)
+            {
+                throwErrno("shm_open");
+            }
+        }
+
+        if (creator && ::ftruncate(fd, static_cast<off_t>(layout_.totalSize)) != 0)
+        {
+            int err = errno;
+            ::close(fd);
+            unlink(name_);
+            errno = err;
+            throwErrno("ftruncate");
+        }
+        if (!creator && !waitForSize(fd))
+        {
+            ::close(fd);
+            throw std::runtime_error("ShmLruCache: segment " + name_ + " has unexpected size");
+        }
+
+        void* addr = ::mmap(nullptr, layout_.totalSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED)
+        {
+            throwErrno("mmap");
+        }
+        base_ = static_cast<char*>(addr);
+        header_ = reinterpret_cast<Header*>(base_);
+
+        if (!creator || !tryInitialize())
+        {
+            waitUntilReady();
+        }
+    }
+
+    // 新建的段全为0，state为STATE_EMPTY；抢到初始化权的进程负责构造段头与各分片，没抢到返回false
+    bool tryInitialize()
+    {
+        uint32_t expected = STATE_EMPTY;
+        if (!header_->state.compare_exchange_strong(expected, STATE_INITIALIZING))
+        {
+            return false;
+        }
+        header_->initPid.store(static_cast<int32_t>(::getpid()), std::memory_order_relaxed);
+        initialize();
+        return true;
+    }
+
+    // 构造段头与各分片，调用方已持有初始化权
+    void initialize()
+    {
+        header_->magic = MAGIC;
+        header_->version = VERSION;
+        header_->keySize = sizeof(Key);
+        header_->valueSize = sizeof(Value);
+        header_->sliceNum = layout_.sliceNum;
+        header_->sliceCapacity = layout_.sliceCapacity;
+        header_->bucketCount = layout_.bucketCount;
+        header_->totalSize = layout_.totalSize;
+        header_->recoveredSlices.store(0, std::memory_order_relaxed);
+
+        for (uint32_t i = 0; i < layout_.sliceNum; ++i)
+        {
+            Slice& slice = sliceAt(i);
+            pthread_mutexattr_t attr;
+            ::pthread_mutexattr_init(&attr);
+            ::pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+            ::pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+            ::pthread_mutex_init(&slice.mutex, &attr);
+            ::pthread_mutexattr_destroy(&attr);
+            slice.dirty.store(0, std::memory_order_relaxed);
+            resetSlice(slice);
+        }
+        header_->state.store(STATE_READY, std::memory_order_release);
+    }
+
+    // 等待创建者完成初始化；只有确认初始化进程已经不存在(kill返回ESRCH)时才由当前进程接管重新初始化，
+    // 初始化进程仍然存活却迟迟未完成时抛出std::runtime_error，不抢占，避免两个进程同时构造段头
+    void waitUntilReady()
+    {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (true)
+        {
+            uint32_t state = header_->state.load(std::memory_order_acquire);
+            if (state == STATE_READY)
+            {
+                break;
+            }
+            if (state == STATE_EMPTY)
+            {
+                // 创建者还没抢到初始化权就退出了，或者尚未走到那一步：初始化权由CAS决定
+                if (tryInitialize())
+                {
+                    return;
+                }
+                continue;
+            }
+            // initPid为0说明初始化者刚抢到初始化权、还没写入pid；接管对initPid做CAS，
+            // 同一个已退出的进程只会被一个等待者接管
+            int32_t initPid = header_->initPid.load(std::memory_order_relaxed);
+            if (initPid > 0 && ::kill(static_cast<pid_t>(initPid), 0) != 0 && errno == ESRCH)
+            {
+                if (header_->initPid.compare_exchange_strong(initPid, static_cast<int32_t>(::getpid())))
+                {
+                    initialize();
+                    return;
+                }
+                continue;
+            }
+            if (std::chrono::steady_clock::now() > deadline)
+            {
+                throw std::runtime_error("ShmLruCache: segment " + name_ + " is still being initialized by process "
+                                         + std::to_string(initPid));
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        if (header_->magic != MAGIC || header_->version != VERSION
+            || header_->keySize != sizeof(Key) || header_->valueSize != sizeof(Value)
+            || header_->sliceNum != layout_.sliceNum || header_->sliceCapacity != layout_.sliceCapacity
+            || header_->totalSize != layout_.totalSize)
+        {
+            throw std::runtime_error("ShmLruCache: segment " + name_ + " was created with a different layout");
+        }
+    }
+
+    bool waitForSize(int fd)
+    {
+        for (int i = 0; i < 5000; ++i)
+        {
+            struct stat st;
+            if (::fstat(fd, &st) != 0)
+            {
+                return false;
+            }
+            if (static_cast<size_t>(st.st_size) == layout_.totalSize)
+            {
+                return true;
+            }
+            if (st.st_size != 0)
+            {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return false;
+    }
+
+    [[noreturn]] void throwErrno(const char* what)
+    {
+        throw std::runtime_error("ShmLruCache: " + std::string(what) + " " + name_ + ": " + std::strerror(errno));
+    }
+
+    // 进程间哈希必须一致，Hasher不能带进程内的随机种子；
+    // 在Hasher的基础上再做一次64位混淆，即使传入的Hasher对整数是恒等映射也能均匀分布
+    static uint64_t hashOf(const Key& key)
+    {
+        uint64_t h = static_cast<uint64_t>(Hasher()(key));
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    Slice& sliceAt(uint32_t i)
+    {
+        return reinterpret_cast<Slice*>(base_ + layout_.slicesOffset)[i];
+    }
+
+    // 高32位选分片，低位选哈希桶，两者互不相关
+    Slice& sliceOf(uint64_t hash)
+    {
+        return sliceAt(static_cast<uint32_t>((hash >> 32) % layout_.sliceNum));
+    }
+
+    char* sliceData(const Slice& slice)
+    {
+        size_t i = static_cast<size_t>(&slice - &sliceAt(0));
+        return base_ + layout_.sliceDataOffset + layout_.sliceDataSize * i;
+    }
+
+    uint32_t* buckets(const Slice& slice)
+    {
+        return reinterpret_cast<uint32_t*>(sliceData(slice));
+    }
+
+    Node& nodeAt(const Slice& slice, uint32_t index)
+    {
+        return reinterpret_cast<Node*>(sliceData(slice) + layout_.nodesOffset)[index];
+    }
+
+    uint32_t& bucketOf(const Slice& slice, uint64_t hash)
+    {
+        return buckets(slice)[hash & (layout_.bucketCount - 1)];
+    }
+
+    uint32_t find(const Slice& slice, const Key& key, uint64_t hash)
+    {
+        for (uint32_t index = bucketOf(slice, hash); index != NIL; )
+        {
+            const Node& node = nodeAt(slice, index);
+            if (node.hash == hash && std::memcmp(&node.key, &key, sizeof(Key)) == 0)
+            {
+                return index;
+            }
+            index = node.chain;
+        }
+        return NIL;
+    }
+
+    // 修改分片前打上标记，修改完成后清除；release语义保证标记先于数据修改可见
+    void beginMutation(Slice& slice, uint32_t pendingNode)
+    {
+        slice.pendingNode = pendingNode;
+        slice.dirty.store(1, std::memory_order_release);
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    }
+
+    void endMutation(Slice& slice)
+    {
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        slice.dirty.store(0, std::memory_order_release);
+        slice.pendingNode = NIL;
+    }
+
+    void linkBucket(Slice& slice, uint32_t index)
+    {
+        Node& node = nodeAt(slice, index);
+        uint32_t& bucket = bucketOf(slice, node.hash);
+        node.chain = bucket;
+        bucket = index;
+    }
+
+    void unlinkBucket(Slice& slice, uint32_t index)
+    {
+        Node& node = nodeAt(slice, index);
+        uint32_t* link = &bucketOf(slice, node.hash);
+        while (*link != index)
+        {
+            link = &nodeAt(slice, *link).chain;
+        }
+        *link = node.chain;
+    }
+
+    // 最近使用的节点放在链表尾部
+    void linkMostRecent(Slice& slice, uint32_t index)
+    {
+        Node& node = nodeAt(slice, index);
+        node.prev = slice.tail;
+        node.next = NIL;
+        if (slice.tail != NIL)
+        {
+            nodeAt(slice, slice.tail).next = index;
+        }
+        else
+        {
+            slice.head = index;
+        }
+        slice.tail = index;
+    }
+
+    void unlinkList(Slice& slice, uint32_t index)
+    {
+        Node& node = nodeAt(slice, index);
+        if (node.prev != NIL)
+            nodeAt(slice, node.prev).next = node.next;
+        else
+            slice.head = node.next;
+        if (node.next != NIL)
+            nodeAt(slice, node.next).prev = node.prev;
+        else
+            slice.tail = node.prev;
+    }
+
+    void moveToMostRecent(Slice& slice, uint32_t index)
+    {
+        if (slice.tail == index)
+        {
+            return;
+        }
+        unlinkList(slice, index);
+        linkMostRecent(slice, index);
+    }
+
+    void releaseNode(Slice& slice, uint32_t index)
+    {
+        Node& node = nodeAt(slice, index);
+        node.used = 0;
+        unlinkList(slice, index);
+        unlinkBucket(slice, index);
+        node.next = slice.freeHead;
+        slice.freeHead = index;
+        --slice.size;
+    }
+
+    void evictLeastRecent(Slice& slice)
+    {
+        releaseNode(slice, slice.head);
+    }
+
+    void resetSlice(Slice& slice)
+    {
+        uint32_t* bucketArray = buckets(slice);
+        for (uint32_t i = 0; i < layout_.bucketCount; ++i)
+        {
+            bucketArray[i] = NIL;
+        }
+        for (uint32_t i = 0; i < layout_.sliceCapacity; ++i)
+        {
+            Node& node = nodeAt(slice, i);
+            node.used = 0;
+            node.next = i + 1 < layout_.sliceCapacity ? i + 1 : NIL;
+        }
+        slice.head = NIL;
+        slice.tail = NIL;
+        slice.freeHead = 0;
+        slice.size = 0;
+        slice.pendingNode = NIL;
+    }
+
+    // 持锁进程在修改中途崩溃：按占用标志重建哈希桶、LRU链表与空闲链表
+    // 正在写入的节点和重复的key被丢弃，最近使用顺序按槽位顺序近似恢复
+    void rebuildSlice(Slice& slice)
+    {
+        uint32_t pending = slice.pendingNode;
+        uint32_t* bucketArray = buckets(slice);
+        for (uint32_t i = 0; i < layout_.bucketCount; ++i)
+        {
+            bucketArray[i] = NIL;
+        }
+        slice.head = NIL;
+        slice.tail = NIL;
+        slice.freeHead = NIL;
+        slice.size = 0;
+        for (uint32_t i = layout_.sliceCapacity; i-- > 0; )
+        {
+            Node& node = nodeAt(slice, i);
+            if (node.used && i != pending && find(slice, node.key, node.hash) == NIL)
+            {
+                linkBucket(slice, i);
+                ++slice.size;
+            }
+            else
+            {
+                node.used = 0;
+                node.next = slice.freeHead;
+                slice.freeHead = i;
+            }
+        }
+        for (uint32_t i = 0; i < layout_.sliceCapacity; ++i)
+        {
+            if (nodeAt(slice, i).used)
+            {
+                linkMostRecent(slice, i);
+            }
+        }
+        slice.pendingNode = NIL;
+        slice.dirty.store(0, std::memory_order_release);
+        header_->recoveredSlices.fetch_add(1, std::memory_order_relaxed);
+    }
+
+private:
+    std::string name_;          // 共享内存段名，如 "/xrms-cache"
+    Layout      layout_;        // 段内布局
+    char*       base_ = nullptr;
+    Header*     header_ = nullptr;
+};
+
+} // namespace XrmsCache
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "BackingStore.h"
+#include "CacheHash.h"
+#include "ICachePolicy.h"
+
+// 读穿透 / 写穿透：缓存作为后端存储前面的一层
+namespace XrmsCache
+{
+
+/*
+ * StoreBackedCache 在任意缓存（LruCache、LfuCache、ArcCache、HashLruCaches等）前包一层读写穿透
+ * - get未命中时从存储read，读到后填入缓存
+ * - getAll把一批key中未命中的部分合并成一次readBatch
+ * - put先写存储，成功后才更新缓存；写失败时缓存保持原值，与存储一致
+ *
+ * 未命中填充与写入之间存在竞争：若读线程从存储读到旧值后、填入缓存前，另一个线程完成了写穿透，
+ * 旧值就会覆盖缓存中的新值。为此按key哈希到固定数量的条带锁，同一key的填充与写入串行执行；
+ * 缓存命中的读取不加条带锁。
+ *
+ * 只读写缓存的put/get，写回模式请直接使用LruCache::setWriteBack。
+ * Hasher用于选条带锁和getAll去重，默认CacheHash。
+ */
+template<typename Key, typename Value, typename Cache = ICachePolicy<Key, Value>, typename Hasher = CacheHash<Key>>
+class StoreBackedCache : public ICachePolicy<Key, Value>
+{
+public:
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;        // 缓存未命中（包括存储中也没有的）
+        uint64_t loadFailures = 0;  // 存储中也没有或读取失败
+        uint64_t writeFailures = 0; // 写穿透失败次数
+    };
+
+    StoreBackedCache(Cache& cache, BackingStore<Key, Value>& store)
+        : cache_(cache)
+        , store_(store)
+    {}
+
+    // 写穿透：先写存储，成功后再更新缓存，失败返回false且缓存不变
+    bool tryPut(const Key& key, const Value& value)
+    {
+        std::lock_guard<std::mutex> lock(stripeOf(key));
+        if (!store_.write(key, value))
+        {
+            writeFailures_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        cache_.put(key, value);
+        return true;
+    }
+
+    void put(Key key, Value value) override
+    {
+        tryPut(key, value);
+    }
+
+    // 读穿透：缓存未命中时从存储读取并填入缓存，存储中也没有时返回false
+    bool get(Key key, Value& value) override
+    {
+        if (cache_.get(key, value))
+        {
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        misses_.fetch_add(1, std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(stripeOf(key));
+        // 等锁期间可能已有其他线程填充或写入
+        if (cache_.get(key, value))
+        {
+            return true;
+        }
+        if (!store_.read(key, value))
+        {
+            loadFailures_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        cache_.put(key, value);
+        return true;
+    }
+
+    Value get(Key key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 批量读取：values与keys一一对应，读不到的为空；返回读到的个数
+    // 所有未命中的key（去重后）合并成一次readBatch
+    size_t getAll(const std::vector<Key>& keys, std::vector<std::optional<Value>>& values)
+    {
+        values.assign(keys.size(), std::nullopt);
+        size_t found = 0;
+        Value value;
+        std::vector<size_t> missing;
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            if (cache_.get(keys[i], value))
+            {
+                values[i] = std::move(value);
+                ++found;
+            }
+            else
+            {
+                missing.push_back(i);
+            }
+        }
+        hits_.fetch_add(found, std::memory_order_relaxed);
+        misses_.fetch_add(missing.size(), std::memory_order_relaxed);
+        if (missing.empty())
+        {
+            return found;
+        }
+
+        // 同一key在一批中可能出现多次，只读一次
+        std::unordered_map<Key, std::vector<size_t>, Hasher> positions;
+        std::vector<Key> loadKeys;
+        for (size_t i : missing)
+        {
+            auto& slots = positions[keys[i]];
+            if (slots.empty())
+            {
+                loadKeys.push_back(keys[i]);
+            }
+            slots.push_back(i);
+        }
+
+        // 按条带下标顺序加锁，避免与其他批量读取互相等待
+        std::vector<size_t> stripes;
+        for (const Key& key : loadKeys)
+        {
+            stripes.push_back(stripeIndex(key));
+        }
+        std::sort(stripes.begin(), stripes.end());
+        stripes.erase(std::unique(stripes.begin(), stripes.end()), stripes.end());
+        for (size_t stripe : stripes)
+        {
+            stripes_[stripe].lock();
+        }
+
+        std::vector<std::optional<Value>> loaded;
+        bool ok = store_.readBatch(loadKeys, loaded);
+        for (size_t i = 0; ok && i < loadKeys.size(); ++i)
+        {
+            // 等锁期间写穿透写入的值比存储中读到的更新
+            if (cache_.get(loadKeys[i], value))
+            {
+                loaded[i] = std::move(value);
+            }
+            else if (loaded[i])
+            {
+                cache_.put(loadKeys[i], *loaded[i]);
+            }
+        }
+
+        for (size_t stripe : stripes)
+        {
+            stripes_[stripe].unlock();
+        }
+
+        for (size_t i = 0; i < loadKeys.size(); ++i)
+        {
+            if (!ok || !loaded[i])
+            {
+                loadFailures_.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            for (size_t slot : positions[loadKeys[i]])
+            {
+                values[slot] = *loaded[i];
+                ++found;
+            }
+        }
+        return found;
+    }
+
+    Stats stats() const
+    {
+        Stats s;
+        s.hits = hits_.load(std::memory_order_relaxed);
+        s.misses = misses_.load(std::memory_order_relaxed);
+        s.loadFailures = loadFailures_.load(std::memory_order_relaxed);
+        s.writeFailures = writeFailures_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    static constexpr size_t kStripeNum = 64;
+
+    size_t stripeIndex(const Key& key) const
+    {
+        return Hasher()(key) % kStripeNum;
+    }
+
+    std::mutex& stripeOf(const Key& key)
+    {
+        return stripes_[stripeIndex(key)];
+    }
+
+private:
+    Cache&                    cache_;
+    BackingStore<Key, Value>& store_;
+    std::array<std::mutex, kStripeNum> stripes_;   // 同一key的未命中填充与写穿透串行执行
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> loadFailures_{0};
+    std::atomic<uint64_t> writeFailures_{0};
+};
+
+} // namespace XrmsCache
@@ -0,0 +1,401 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "CacheArena.h"
+#include "CacheHash.h"
+#include "CacheIndex.h"
+#include "CacheProbe.h"
+
+// 字符串key/value的LRU：短字符串内联在节点中，长字符串放在分片自己的内存池里
+namespace XrmsCache
+{
+
+/*
+ * StringArena 变长字符串内存池，每个分片一个，由分片的锁保护
+ * 不超过kMaxClassSize的请求向上取整到2的幂大小级别，从kChunkSize的大块中顺序切分，
+ * 释放后挂到对应级别的空闲链表复用；更大的请求直接malloc。
+ * 释放时由调用方给出长度，池本身不记录每块的大小。
+ */
+class StringArena
+{
+public:
+    StringArena() = default;
+
+    ~StringArena()
+    {
+        for (char* chunk : chunks_)
+        {
+            std::free(chunk);
+        }
+    }
+
+    StringArena(const StringArena&) = delete;
+    StringArena& operator=(const StringArena&) = delete;
+
+    char* allocate(size_t len)
+    {
+        if (len > kMaxClassSize)
+        {
+            char* p = static_cast<char*>(std::malloc(len));
+            if (!p)
+            {
+                throw std::bad_alloc();
+            }
+            largeBytes_ += len;
+            return p;
+        }
+        size_t cls = classOf(len);
+        if (FreeBlock* block = freeLists_[cls])
+        {
+            freeLists_[cls] = block->next;
+            return reinterpret_cast<char*>(block);
+        }
+        size_t size = kMinClassSize << cls;
+        if (static_cast<size_t>(chunkEnd_ - cursor_) < size)
+        {
+            // 当前块剩余不足一个该级别的块，余下部分放弃
+            char* chunk = static_cast<char*>(std::malloc(kChunkSize));
+            if (!chunk)
+            {
+                throw std::bad_alloc();
+            }
+            chunks_.push_back(chunk);
+            cursor_ = chunk;
+            chunkEnd_ = chunk + kChunkSize;
+        }
+        char* p = cursor_;
+        cursor_ += size;
+        return p;
+    }
+
+    void deallocate(char* p, size_t len)
+    {
+        if (len > kMaxClassSize)
+        {
+            std::free(p);
+            largeBytes_ -= len;
+            return;
+        }
+        size_t cls = classOf(len);
+        FreeBlock* block = reinterpret_cast<FreeBlock*>(p);
+        block->next = freeLists_[cls];
+        freeLists_[cls] = block;
+    }
+
+    // 已从系统申请的字节数
+    size_t memoryBytes() const { return chunks_.size() * kChunkSize + largeBytes_; }
+
+private:
+    static constexpr size_t kMinClassSize = 16;
+    static constexpr size_t kMaxClassSize = 4096;
+    static constexpr size_t kClassCount = 9;        // 16, 32, ..., 4096
+    static constexpr size_t kChunkSize = 64 * 1024;
+
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    static size_t classOf(size_t len)
+    {
+        size_t cls = 0;
+        while ((kMinClassSize << cls) < len)
+        {
+            ++cls;
+        }
+        return cls;
+    }
+
+private:
+    std::vector<char*>  chunks_;
+    char*               cursor_ = nullptr;
+    char*               chunkEnd_ = nullptr;
+    FreeBlock*          freeLists_[kClassCount] = {};
+    size_t              largeBytes_ = 0;
+};
+
+/*
+ * StringLruCache 字符串key/value的分片LRU
+ * 每个条目是节点内存池中的一个定长槽位：key和value合计不超过InlineBytes字节时直接存在槽位里，
+ * 整个条目没有单独的堆分配；放不下的部分从分片的StringArena按大小级别分配。
+ * 相比LruCache<std::string, std::string>的节点加两个std::string各自的堆内存，
+ * 每条目最多一次池内分配，淘汰时也只是把块挂回空闲链表。
+ * 取值可以拷贝到std::string，也可以用read在分片锁内以std::string_view直接访问，不做拷贝。
+ */
+template<size_t InlineBytes = 48, typename Hasher = CacheHash<std::string_view>>
+class StringLruCache
+{
+public:
+    StringLruCache(size_t capacity, int sliceNum = 1)
+        : sliceNum_(sliceNum > 0 ? sliceNum : std::thread::hardware_concurrency())
+    {
+        size_t sliceSize = std::ceil(capacity / static_cast<double>(sliceNum_));
+        for (int i = 0; i < sliceNum_; ++i)
+        {
+            shards_.emplace_back(new Shard(sliceSize));
+        }
+    }
+
+    ~StringLruCache()
+    {
+        for (auto& shard : shards_)
+        {
+            releaseStrings(*shard);
+        }
+    }
+
+    StringLruCache(const StringLruCache&) = delete;
+    StringLruCache& operator=(const StringLruCache&) = delete;
+
+    void put(std::string_view key, std::string_view value)
+    {
+        size_t hash = Hasher()(key);
+        Shard& shard = shardOf(hash);
+        std::unique_lock<std::mutex> lock = CacheProbe::lock(shard.mutex, &shard);
+        if (shard.capacity == 0)
+        {
+            return;
+        }
+        Entry* entry = findEntry(shard, key, hash);
+        if (entry)
+        {
+            freeValue(shard, entry);
+            storeValue(shard, entry, value);
+            moveToMostRecent(shard, entry);
+            return;
+        }
+        XRMS_CACHE_PROBE_KEY(insert, &shard, key);
+        if (shard.index.size() >= shard.capacity)
+        {
+            evictLeastRecent(shard);
+        }
+        entry = shard.entries.create();
+        entry->hash_ = hash;
+        storeKey(shard, entry, key);
+        storeValue(shard, entry, value);
+        shard.index.insert(entry);
+        linkMostRecent(shard, entry);
+    }
+
+    bool get(std::string_view key, std::string& value)
+    {
+        return read(key, [&value](std::string_view stored) { value.assign(stored.data(), stored.size()); });
+    }
+
+    // 命中时在分片锁内以fn(std::string_view)访问value，视图只在回调期间有效
+    template<typename F>
+    bool read(std::string_view key, F&& fn)
+    {
+        size_t hash = Hasher()(key);
+        Shard& shard = shardOf(hash);
+        std::unique_lock<std::mutex> lock = CacheProbe::lock(shard.mutex, &shard);
+        Entry* entry = findEntry(shard, key, hash);
+        if (!entry)
+        {
+            XRMS_CACHE_PROBE_KEY(miss, &shard, key);
+            return false;
+        }
+        XRMS_CACHE_PROBE_KEY(hit, &shard, key);
+        moveToMostRecent(shard, entry);
+        fn(std::string_view(entry->valueData_, entry->valueLen_));
+        return true;
+    }
+
+    bool remove(std::string_view key)
+    {
+        size_t hash = Hasher()(key);
+        Shard& shard = shardOf(hash);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        Entry* entry = findEntry(shard, key, hash);
+        if (!entry)
+        {
+            return false;
+        }
+        unlink(entry);
+        shard.index.erase(entry);
+        destroyEntry(shard, entry);
+        return true;
+    }
+
+    void clear()
+    {
+        for (auto& shard : shards_)
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            releaseStrings(*shard);
+            shard->index.clear();
+            shard->entries.release();
+            shard->head.next_ = &shard->tail;
+            shard->tail.prev_ = &shard->head;
+        }
+    }
+
+    size_t size()
+    {
+        size_t total = 0;
+        for (auto& shard : shards_)
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            total += shard->index.size();
+        }
+        return total;
+    }
+
+    // 条目槽位、索引和字符串内存池占用的字节数（条目按已使用的槽位数计）
+    size_t memoryBytes()
+    {
+        size_t total = 0;
+        for (auto& shard : shards_)
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            total += shard->index.size() * sizeof(Entry) + shard->index.memoryBytes() + shard->strings.memoryBytes();
+        }
+        return total;
+    }
+
+private:
+    // key优先内联；value放在key之后剩余的内联空间中，放不下时由内存池分配
+    struct Entry
+    {
+        Entry*      prev_ = nullptr;
+        Entry*      next_ = nullptr;
+        size_t      hash_ = 0;
+        size_t      slot_ = 0;      // 在索引中的槽位，由NodeIndex维护
+        char*       keyData_ = nullptr;
+        char*       valueData_ = nullptr;
+        uint32_t    keyLen_ = 0;
+        uint32_t    valueLen_ = 0;
+        char        inline_[InlineBytes];
+
+        bool keyInline() const { return keyLen_ <= InlineBytes; }
+        size_t inlineUsedByKey() const { return keyInline() ? keyLen_ : 0; }
+        bool valueInline() const { return valueLen_ <= InlineBytes - inlineUsedByKey(); }
+    };
+
+    struct Shard
+    {
+        explicit Shard(size_t sliceSize)
+            : capacity(sliceSize)
+            , index(sliceSize)
+            , entries(std::clamp<size_t>(sliceSize, 1, 65536))
+        {
+            head.next_ = &tail;
+            tail.prev_ = &head;
+        }
+
+        std::mutex          mutex;
+        size_t              capacity;
+        NodeIndex<Entry>    index;
+        NodeArena<Entry>    entries;
+        StringArena         strings;
+        Entry               head;   // 哨兵，head.next_为最久未使用
+        Entry               tail;   // 哨兵，tail.prev_为最近使用
+    };
+
+    Shard& shardOf(size_t hash)
+    {
+        return *shards_[hash % sliceNum_];
+    }
+
+    static Entry* findEntry(Shard& shard, std::string_view key, size_t hash)
+    {
+        return shard.index.find(hash, [key](Entry* entry) {
+            return std::string_view(entry->keyData_, entry->keyLen_) == key;
+        });
+    }
+
+    static void storeKey(Shard& shard, Entry* entry, std::string_view key)
+    {
+        entry->keyLen_ = static_cast<uint32_t>(key.size());
+        entry->keyData_ = entry->keyInline() ? entry->inline_ : shard.strings.allocate(key.size());
+        std::memcpy(entry->keyData_, key.data(), key.size());
+    }
+
+    static void storeValue(Shard& shard, Entry* entry, std::string_view value)
+    {
+        entry->valueLen_ = static_cast<uint32_t>(value.size());
+        entry->valueData_ = entry->valueInline() ? entry->inline_ + entry->inlineUsedByKey()
+                                                 : shard.strings.allocate(value.size());
+        std::memcpy(entry->valueData_, value.data(), value.size());
+    }
+
+    static void freeValue(Shard& shard, Entry* entry)
+    {
+        if (!entry->valueInline())
+        {
+            shard.strings.deallocate(entry->valueData_, entry->valueLen_);
+        }
+    }
+
+    static void destroyEntry(Shard& shard, Entry* entry)
+    {
+        if (!entry->keyInline())
+        {
+            shard.strings.deallocate(entry->keyData_, entry->keyLen_);
+        }
+        freeValue(shard, entry);
+        shard.entries.destroy(entry);
+    }
+
+    // 归还所有存活条目在内存池外的大块字符串（池内的块随StringArena整体释放）
+    static void releaseStrings(Shard& shard)
+    {
+        for (Entry* entry = shard.head.next_; entry != &shard.tail; entry = entry->next_)
+        {
+            if (!entry->keyInline())
+            {
+                shard.strings.deallocate(entry->keyData_, entry->keyLen_);
+            }
+            freeValue(shard, entry);
+        }
+    }
+
+    static void unlink(Entry* entry)
+    {
+        entry->prev_->next_ = entry->next_;
+        entry->next_->prev_ = entry->prev_;
+    }
+
+    static void linkMostRecent(Shard& shard, Entry* entry)
+    {
+        entry->next_ = &shard.tail;
+        entry->prev_ = shard.tail.prev_;
+        shard.tail.prev_->next_ = entry;
+        shard.tail.prev_ = entry;
+    }
+
+    static void moveToMostRecent(Shard& shard, Entry* entry)
+    {
+        unlink(entry);
+        linkMostRecent(shard, entry);
+    }
+
+    static void evictLeastRecent(Shard& shard)
+    {
+        Entry* victim = shard.head.next_;
+        XRMS_CACHE_PROBE4(evict, static_cast<const void*>(&shard), victim->keyData_,
+                          static_cast<size_t>(victim->keyLen_), static_cast<int>(CacheProbe::EvictReason::Capacity));
+        unlink(victim);
+        shard.index.erase(victim);
+        destroyEntry(shard, victim);
+    }
+
+private:
+    int sliceNum_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+} // namespace XrmsCache
@@ -0,0 +1,267 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+#include <string>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// 性能测试公共工具
+namespace XrmsBench
+{
+
+// 定时器类，用于记录代码执行时间
+class Timer
+{
+public:
+    Timer() : start_(std::chrono::steady_clock::now()) {}
+
+    // 重新开始计时
+    void reset() { start_ = std::chrono::steady_clock::now(); }
+
+    // 从创建(或reset)到现在经过的时间，单位毫秒
+    double elapsedMs() const
+    {
+        auto now = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(now - start_).count();
+    }
+
+    // 从创建(或reset)到现在经过的时间，单位纳秒
+    double elapsedNs() const
+    {
+        auto now = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(now - start_).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point start_;
+};
+
+// 读取命令行第index个参数作为数值，缺省时返回defaultValue
+inline long long argOr(int argc, char* argv[], int index, long long defaultValue)
+{
+    if (argc > index)
+    {
+        return std::atoll(argv[index]);
+    }
+    return defaultValue;
+}
+
+// 防止编译器把测试结果优化掉
+template<typename T>
+inline void doNotOptimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// 硬件事件计数器，基于perf_event_open，只统计本线程的用户态
+// 虚拟机、容器或perf_event_paranoid限制下可能打不开，此时available()为false，value()返回-1
+// 事件多于硬件计数器时内核会分时复用，value()按实际计数时间占比换算
+class PerfCounter
+{
+public:
+    PerfCounter() = default;
+
+    PerfCounter(uint32_t type, uint64_t config)
+    {
+        open(type, config);
+    }
+
+    ~PerfCounter()
+    {
+#if defined(__linux__)
+        if (fd_ >= 0)
+        {
+            close(fd_);
+        }
+#endif
+    }
+
+    PerfCounter(const PerfCounter&) = delete;
+    PerfCounter& operator=(const PerfCounter&) = delete;
+
+    void open(uint32_t type, uint64_t config)
+    {
+#if defined(__linux__)
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#else
+        (void)type;
+        (void)config;
+#endif
+    }
+
+    bool available() const { return fd_ >= 0; }
+
+    void start()
+    {
+#if defined(__linux__)
+        if (fd_ >= 0)
+        {
+            ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    void stop()
+    {
+#if defined(__linux__)
+        if (fd_ >= 0)
+        {
+            ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+        }
+#endif
+    }
+
+    long long value() const
+    {
+#if defined(__linux__)
+        uint64_t data[3] = {0, 0, 0};   // 计数、启用时间、实际计数时间
+        if (fd_ >= 0 && read(fd_, data, sizeof(data)) == static_cast<ssize_t>(sizeof(data)))
+        {
+            if (data[2] == 0)
+            {
+                return 0;
+            }
+            return static_cast<long long>(static_cast<double>(data[0]) * data[1] / data[2]);
+        }
+#endif
+        return -1;
+    }
+
+private:
+    int fd_ = -1;
+};
+
+// 一组常用的硬件计数器：周期、指令、L1d读未命中、LLC未命中、dTLB读未命中、分支预测失败
+// 每个事件单独打开，某个事件不支持时只影响这一列；全部不可用时输出n/a
+class PerfCounters
+{
+public:
+    enum Event
+    {
+        Cycles,
+        Instructions,
+        L1dMisses,
+        LlcMisses,
+        DtlbMisses,
+        BranchMisses,
+        kEventCount
+    };
+
+    PerfCounters()
+    {
+#if defined(__linux__)
+        counters_[Cycles].open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        counters_[Instructions].open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        counters_[L1dMisses].open(PERF_TYPE_HW_CACHE, cacheEvent(PERF_COUNT_HW_CACHE_L1D));
+        counters_[LlcMisses].open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+        counters_[DtlbMisses].open(PERF_TYPE_HW_CACHE, cacheEvent(PERF_COUNT_HW_CACHE_DTLB));
+        counters_[BranchMisses].open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+#endif
+    }
+
+    static const char* name(Event event)
+    {
+        static const char* names[kEventCount] = {"cycles", "instr", "L1d-miss", "LLC-miss", "dTLB-miss", "br-miss"};
+        return names[event];
+    }
+
+    bool available(Event event) const { return counters_[event].available(); }
+
+    bool anyAvailable() const
+    {
+        for (const PerfCounter& counter : counters_)
+        {
+            if (counter.available())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void start()
+    {
+        for (PerfCounter& counter : counters_)
+        {
+            counter.start();
+        }
+    }
+
+    void stop()
+    {
+        for (PerfCounter& counter : counters_)
+        {
+            counter.stop();
+        }
+    }
+
+    // 每次操作的事件数，不可用时返回-1
+    double perOp(Event event, size_t ops) const
+    {
+        long long value = counters_[event].value();
+        return value < 0 || ops == 0 ? -1 : static_cast<double>(value) / ops;
+    }
+
+    // 与print对齐的表头
+    static void printHeader(std::ostream& out)
+    {
+        for (int i = 0; i < kEventCount; ++i)
+        {
+            out << std::setw(11) << name(static_cast<Event>(i));
+        }
+    }
+
+    // 输出每次操作的各事件数，不可用的列为n/a
+    void print(std::ostream& out, size_t ops) const
+    {
+        std::ios::fmtflags flags = out.flags();
+        std::streamsize precision = out.precision();
+        out << std::right << std::fixed << std::setprecision(2);
+        for (int i = 0; i < kEventCount; ++i)
+        {
+            double value = perOp(static_cast<Event>(i), ops);
+            if (value < 0)
+            {
+                out << std::setw(11) << "n/a";
+            }
+            else
+            {
+                out << std::setw(11) << value;
+            }
+        }
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+private:
+#if defined(__linux__)
+    static uint64_t cacheEvent(uint64_t cache)
+    {
+        return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    }
+#endif
+
+    PerfCounter counters_[kEventCount];
+};
+
+} // namespace XrmsBench
@@ -0,0 +1,260 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "ArcCache/ArcCache.h"
+#include "BenchUtil.h"
+#include "CacheMemory.h"
+#include "FlatLruCache.h"
+#include "LfuCache.h"
+#include "LruCache.h"
+
+// 堆分配次数测试：替换全局operator new/delete，并让缓存的内存池、索引经计数的resource分配，
+// 统计各策略每次操作的堆分配次数
+// 场景：命中的get（预热后的稳态）、未命中的get、更新已有key的put、插入新key的put（缓存已满，伴随淘汰）
+// 命中的get必须为0次分配，否则以非0退出，分配回归由本测试而不是线上发现
+// 用法: benchAllocations [容量]
+
+static std::atomic<long long> gAllocations{0};
+
+// 替换的各个new/delete都经这一对函数分配和释放；不内联，GCC就不会把内置的new与free配对而报-Wmismatched-new-delete
+__attribute__((noinline)) static void* countedAllocate(size_t size, size_t alignment)
+{
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = alignment > alignof(std::max_align_t)
+        ? std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)
+        : std::malloc(size ? size : 1);
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+__attribute__((noinline)) static void countedRelease(void* p) noexcept
+{
+    std::free(p);
+}
+
+void* operator new(size_t size) { return countedAllocate(size, 0); }
+void* operator new[](size_t size) { return countedAllocate(size, 0); }
+void* operator new(size_t size, std::align_val_t align) { return countedAllocate(size, static_cast<size_t>(align)); }
+void* operator new[](size_t size, std::align_val_t align) { return countedAllocate(size, static_cast<size_t>(align)); }
+
+void operator delete(void* p) noexcept { countedRelease(p); }
+void operator delete[](void* p) noexcept { countedRelease(p); }
+void operator delete(void* p, size_t) noexcept { countedRelease(p); }
+void operator delete[](void* p, size_t) noexcept { countedRelease(p); }
+void operator delete(void* p, std::align_val_t) noexcept { countedRelease(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { countedRelease(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { countedRelease(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { countedRelease(p); }
+
+// 缓存内部经CacheMemory直接malloc的内存（节点内存池、索引表）改由这个resource分配，计入同一个计数
+class CountingUpstream : public std::pmr::memory_resource
+{
+    void* do_allocate(size_t bytes, size_t align) override
+    {
+        gAllocations.fetch_add(1, std::memory_order_relaxed);
+        return XrmsCache::CacheMemory::allocate(nullptr, bytes, align);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t align) override
+    {
+        XrmsCache::CacheMemory::deallocate(nullptr, p, bytes, align);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+template<typename Value>
+static Value makeValue(int key)
+{
+    if constexpr (std::is_same<Value, std::string>::value)
+    {
+        return std::string(64, static_cast<char>('a' + key % 26));
+    }
+    else
+    {
+        return key;
+    }
+}
+
+// 一段操作中平均每次操作的分配次数
+template<typename F>
+static double allocationsPerOp(size_t ops, F&& fn)
+{
+    long long before = gAllocations.load(std::memory_order_relaxed);
+    fn();
+    return static_cast<double>(gAllocations.load(std::memory_order_relaxed) - before) / ops;
+}
+
+template<typename Value, typename Cache>
+static bool measure(const char* name, Cache& cache, int capacity)
+{
+    const int hot = capacity / 2;
+    const int warmPasses = 64;
+    Value out = makeValue<Value>(0);    // 取值的目标预先有足够容量，赋值不必重新分配
+    std::vector<Value> values;
+    for (int i = 0; i < 26; ++i)
+    {
+        values.push_back(makeValue<Value>(i));
+    }
+
+    for (int i = 0; i < capacity; ++i)
+    {
+        cache.put(i, values[i % 26]);
+    }
+    // 预热：分片缓存各片负载不均，写满时可能已淘汰部分热点key，未命中的补写回去；
+    // ARC把命中的key转入LFU部分，LFU在老化下反复经过的各个频次链表都建立起来（频次链表建立后不再释放）
+    for (int pass = 0; pass < warmPasses; ++pass)
+    {
+        for (int i = 0; i < hot; ++i)
+        {
+            if (!cache.get(i, out))
+            {
+                cache.put(i, values[i % 26]);
+            }
+        }
+    }
+
+    bool allHit = true;
+    double hit = allocationsPerOp(hot, [&] {
+        for (int i = 0; i < hot; ++i)
+        {
+            allHit &= cache.get(i, out);
+        }
+    });
+    double miss = allocationsPerOp(hot, [&] {
+        for (int i = 0; i < hot; ++i)
+        {
+            cache.get(capacity * 4 + i, out);
+        }
+    });
+    double update = allocationsPerOp(hot, [&] {
+        for (int i = 0; i < hot; ++i)
+        {
+            cache.put(i, values[(i + 1) % 26]);
+        }
+    });
+    double insert = allocationsPerOp(capacity, [&] {
+        for (int i = 0; i < capacity; ++i)
+        {
+            cache.put(capacity * 8 + i, values[i % 26]);
+        }
+    });
+
+    // 首次命中：每个新key写入后立刻读一次，只统计读的分配；ARC在这次命中时把key转入LFU部分
+    bool allColdHit = true;
+    long long coldAllocations = 0;
+    for (int i = 0; i < hot; ++i)
+    {
+        int key = capacity * 12 + i;
+        cache.put(key, values[i % 26]);
+        long long before = gAllocations.load(std::memory_order_relaxed);
+        allColdHit &= cache.get(key, out);
+        coldAllocations += gAllocations.load(std::memory_order_relaxed) - before;
+    }
+    double coldHit = static_cast<double>(coldAllocations) / hot;
+
+    bool ok = allHit && hit == 0;
+    bool coldOk = allColdHit && coldHit == 0;
+    std::cout << std::left << std::setw(18) << name << std::right << std::fixed << std::setprecision(3)
+              << std::setw(10) << hit << std::setw(10) << coldHit << std::setw(10) << miss << std::setw(10) << update
+              << std::setw(10) << insert << std::setw(8) << (ok ? "通过" : "失败") << std::setw(8)
+              << (coldOk ? "通过" : "失败") << std::endl;
+    ok &= coldOk;
+    return ok;
+}
+
+// 全新的缓存：写入少量key后反复命中，频次链表在计时的读中从无到有建立，统计读的分配
+template<typename Value, typename Cache>
+static bool measureFresh(const char* name, Cache& cache, int keys, int rounds)
+{
+    Value out = makeValue<Value>(0);
+    for (int i = 0; i < keys; ++i)
+    {
+        cache.put(i, makeValue<Value>(i));
+    }
+    bool allHit = true;
+    double hit = allocationsPerOp(static_cast<size_t>(keys) * rounds, [&] {
+        for (int round = 0; round < rounds; ++round)
+        {
+            for (int i = 0; i < keys; ++i)
+            {
+                // key i只在前i+1轮被读，各key的访问次数不同，频次链表不断新建和清空
+                if (round <= i)
+                {
+                    allHit &= cache.get(i, out);
+                }
+            }
+        }
+    });
+    bool ok = allHit && hit == 0;
+    std::cout << std::left << std::setw(18) << name << std::right << std::fixed << std::setprecision(3)
+              << std::setw(10) << hit << std::setw(8) << (ok ? "通过" : "失败") << std::endl;
+    return ok;
+}
+
+template<typename Value>
+static bool runAll(const char* title, int capacity, std::pmr::memory_resource* resource)
+{
+    std::cout << "=== " << title << " ===" << std::endl;
+    std::cout << std::left << std::setw(18) << "缓存" << std::right << std::setw(10) << "get命中"
+              << std::setw(10) << "首次命中" << std::setw(10) << "get未命中" << std::setw(10) << "put更新" << std::setw(10) << "put插入"
+              << std::setw(8) << "命中" << std::setw(8) << "首次" << std::endl;
+    bool ok = true;
+    {
+        XrmsCache::LruCache<int, Value> cache(capacity, resource);
+        ok &= measure<Value>("LruCache", cache, capacity);
+    }
+    if constexpr (std::is_trivially_copyable<Value>::value)
+    {
+        XrmsCache::FlatLruCache<int, Value> cache(capacity, resource);
+        ok &= measure<Value>("FlatLruCache", cache, capacity);
+    }
+    {
+        XrmsCache::LfuCache<int, Value> cache(capacity, 10, resource);
+        ok &= measure<Value>("LfuCache", cache, capacity);
+    }
+    {
+        XrmsCache::ArcCache<int, Value> cache(capacity, 2, resource);
+        ok &= measure<Value>("ArcCache", cache, capacity);
+    }
+    {
+        XrmsCache::HashLruCaches<int, Value> cache(capacity, 4, resource);
+        ok &= measure<Value>("HashLruCaches/4", cache, capacity);
+    }
+    {
+        XrmsCache::HashLfuCache<int, Value> cache(capacity, 4, 10, resource);
+        ok &= measure<Value>("HashLfuCache/4", cache, capacity);
+    }
+    std::cout << std::left << std::setw(18) << "全新缓存" << std::right << std::setw(10) << "get命中"
+              << std::setw(8) << "命中" << std::endl;
+    {
+        XrmsCache::ArcCache<int, Value> cache(capacity, 2, resource);
+        ok &= measureFresh<Value>("ArcCache", cache, 48, 48);
+    }
+    return ok;
+}
+
+int main(int argc, char* argv[])
+{
+    const int capacity = static_cast<int>(XrmsBench::argOr(argc, argv, 1, 10000));
+    CountingUpstream upstream;
+
+    std::cout << "每次操作的堆分配次数，容量 " << capacity << std::endl;
+    bool ok = runAll<int>("value: int", capacity, &upstream);
+    ok &= runAll<std::string>("value: 64字节std::string", capacity, &upstream);
+    std::cout << (ok ? "命中路径无分配" : "命中路径存在分配") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,182 @@
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ArcCache/ArcCache.h"
+#include "BenchUtil.h"
+#include "BlockCache.h"
+#include "LruCache.h"
+
+// 文件块缓存测试：顺序扫描时的合并读取与预读、热点随机读在不同策略下的命中率、零拷贝读取
+// 用法: benchBlockCache [文件大小MB] [随机读次数]
+
+using XrmsCache::BlockCache;
+using XrmsCache::BlockKey;
+using XrmsCache::BlockRef;
+using LruBlocks = XrmsCache::HashLruCaches<BlockKey, BlockRef>;
+using ArcBlocks = XrmsCache::ArcCache<BlockKey, BlockRef>;
+
+static const size_t kBlockSize = 4096;
+
+// 生成测试文件，每个字节由偏移推出，便于校验读到的数据
+static std::string makeTestFile(size_t bytes)
+{
+    char path[] = "/tmp/xrms-block-cache-XXXXXX";
+    int fd = ::mkstemp(path);
+    if (fd < 0)
+    {
+        std::perror("mkstemp");
+        std::exit(1);
+    }
+    std::vector<char> chunk(1 << 20);
+    for (size_t offset = 0; offset < bytes; offset += chunk.size())
+    {
+        size_t n = std::min(chunk.size(), bytes - offset);
+        for (size_t i = 0; i < n; ++i)
+        {
+            chunk[i] = static_cast<char>((offset + i) * 131 >> 7);
+        }
+        if (::write(fd, chunk.data(), n) != static_cast<ssize_t>(n))
+        {
+            std::perror("write");
+            std::exit(1);
+        }
+    }
+    ::close(fd);
+    return path;
+}
+
+static bool checkData(const char* data, size_t n, uint64_t offset)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (data[i] != static_cast<char>((offset + i) * 131 >> 7))
+            return false;
+    }
+    return true;
+}
+
+template<typename Cache>
+static void printStats(const std::string& name, BlockCache<Cache>& blocks, double ms)
+{
+    auto s = blocks.stats();
+    double hitRate = s.hits + s.misses ? 100.0 * s.hits / (s.hits + s.misses) : 0;
+    std::cout << std::left << std::setw(26) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << ms << " ms" << std::setw(9) << hitRate << "%"
+              << std::setw(10) << s.readCalls << std::setw(12) << s.readaheadBlocks << std::endl;
+}
+
+static void printHeader()
+{
+    std::cout << std::left << std::setw(26) << "场景" << std::right << std::setw(13) << "耗时"
+              << std::setw(10) << "命中率" << std::setw(10) << "pread" << std::setw(12) << "预读块" << std::endl;
+}
+
+// 以64KB为单位顺序扫描整个文件，期间模拟少量处理时间让预读有机会跑在前面
+static void sequentialScan(const std::string& path, size_t fileBytes, size_t readahead)
+{
+    LruBlocks cache(fileBytes / kBlockSize + 64, 4);
+    BlockCache<LruBlocks> blocks(cache, kBlockSize, readahead);
+    int fileId = blocks.openFile(path);
+    std::vector<char> buf(64 * 1024);
+    bool ok = true;
+    XrmsBench::Timer timer;
+    for (uint64_t offset = 0; offset < fileBytes; offset += buf.size())
+    {
+        ssize_t n = blocks.pread(fileId, buf.data(), buf.size(), offset);
+        ok = ok && n > 0 && checkData(buf.data(), static_cast<size_t>(n), offset);
+    }
+    double ms = timer.elapsedMs();
+    printStats(readahead ? "顺序扫描(预读32块)" : "顺序扫描(无预读)", blocks, ms);
+    if (!ok)
+        std::cout << "  数据校验失败" << std::endl;
+}
+
+// 热点随机读：80%的读落在10%的块上，另有一个一次性扫描不断冲刷缓存
+template<typename Cache>
+static void randomReads(const std::string& name, Cache& cache, const std::string& path, size_t fileBytes, long long reads)
+{
+    BlockCache<Cache> blocks(cache, kBlockSize, 0);
+    int fileId = blocks.openFile(path);
+    uint64_t totalBlocks = fileBytes / kBlockSize;
+    uint64_t hotBlocks = totalBlocks / 10;
+    std::mt19937_64 rng(42);
+    uint64_t scanBlock = 0;
+    char buf[kBlockSize];
+    bool ok = true;
+    XrmsBench::Timer timer;
+    for (long long i = 0; i < reads; ++i)
+    {
+        uint64_t blockNo;
+        int r = static_cast<int>(rng() % 100);
+        if (r < 80)
+            blockNo = rng() % hotBlocks;
+        else if (r < 90)
+            blockNo = rng() % totalBlocks;
+        else
+            blockNo = hotBlocks + scanBlock++ % (totalBlocks - hotBlocks);
+        ssize_t n = blocks.pread(fileId, buf, kBlockSize, blockNo * kBlockSize);
+        ok = ok && n == static_cast<ssize_t>(kBlockSize) && checkData(buf, kBlockSize, blockNo * kBlockSize);
+    }
+    printStats(name, blocks, timer.elapsedMs());
+    if (!ok)
+        std::cout << "  数据校验失败" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t fileBytes = static_cast<size_t>(XrmsBench::argOr(argc, argv, 1, 64)) << 20;
+    const long long reads = XrmsBench::argOr(argc, argv, 2, 500000);
+    std::string path = makeTestFile(fileBytes);
+
+    std::cout << "=== 文件 " << (fileBytes >> 20) << " MB, 块大小 " << kBlockSize << " ===" << std::endl;
+    printHeader();
+    sequentialScan(path, fileBytes, 0);
+    sequentialScan(path, fileBytes, 32);
+
+    // 缓存容量为文件的15%
+    size_t capacity = fileBytes / kBlockSize * 15 / 100;
+    LruBlocks lru(capacity, 4);
+    randomReads("热点随机读(HashLru)", lru, path, fileBytes, reads);
+    ArcBlocks arc(capacity);
+    randomReads("热点随机读(Arc)", arc, path, fileBytes, reads);
+
+    // 数据已全部缓存时，对比拷贝读取和零拷贝读取
+    {
+        LruBlocks cache(fileBytes / kBlockSize + 64, 4);
+        BlockCache<LruBlocks> blocks(cache, kBlockSize, 0);
+        int fileId = blocks.openFile(path);
+        std::vector<char> buf(256 * 1024);
+        for (uint64_t offset = 0; offset < fileBytes; offset += buf.size())
+            blocks.pread(fileId, buf.data(), buf.size(), offset);
+
+        XrmsBench::Timer timer;
+        for (uint64_t offset = 0; offset < fileBytes; offset += buf.size())
+            blocks.pread(fileId, buf.data(), buf.size(), offset);
+        double copyMs = timer.elapsedMs();
+
+        std::vector<BlockRef> refs;
+        uint64_t checksum = 0;
+        timer.reset();
+        for (uint64_t offset = 0; offset < fileBytes; offset += buf.size())
+        {
+            blocks.readBlocks(fileId, offset, buf.size(), refs);
+            for (const BlockRef& ref : refs)
+                checksum += static_cast<unsigned char>(ref.data.get()[0]);
+        }
+        double zeroCopyMs = timer.elapsedMs();
+        XrmsBench::doNotOptimize(checksum);
+        std::cout << std::fixed << std::setprecision(2) << "已缓存全文件: pread拷贝 " << copyMs
+                  << " ms, readBlocks零拷贝 " << zeroCopyMs << " ms" << std::endl;
+    }
+
+    ::unlink(path.c_str());
+    return 0;
+}
@@ -0,0 +1,200 @@
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "BenchUtil.h"
+#include "LfuCache.h"
+#include "LruCache.h"
+
+// 预热性能测试：逐条put与bulkLoad灌入同一份输入的耗时对比
+// 之后在含重复key的小输入上核对bulkLoad与逐条put得到的缓存内容完全一致（空缓存和非空缓存两种起点），
+// 不一致时以非0退出
+// 用法: benchBulkLoad [条目数] [分片数]
+
+using Entry = std::pair<int, int>;
+
+template<typename Cache>
+double timePutLoop(Cache& cache, const std::vector<Entry>& input)
+{
+    XrmsBench::Timer timer;
+    for (const auto& kv : input)
+    {
+        cache.put(kv.first, kv.second);
+    }
+    return timer.elapsedMs();
+}
+
+template<typename Cache>
+double timeBulkLoad(Cache& cache, const std::vector<Entry>& input)
+{
+    XrmsBench::Timer timer;
+    cache.bulkLoad(input);
+    return timer.elapsedMs();
+}
+
+// 抽查最后写入的若干条目，确认两种方式加载出的内容一致
+template<typename Cache>
+bool verifyTail(Cache& cache, const std::vector<Entry>& input, size_t count)
+{
+    for (size_t i = input.size() - count; i < input.size(); ++i)
+    {
+        int value = 0;
+        if (!cache.get(input[i].first, value) || value != input[i].second)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 两个缓存逐个key比较是否命中及取到的值，再各写入一批新key，比较淘汰后剩下的内容，以此检验频次/新旧顺序也一致
+// 两边执行的操作完全相同，get带来的状态变化也相同
+template<typename Cache>
+bool sameContents(Cache& a, Cache& b, const std::set<int>& keys)
+{
+    auto compare = [&]() {
+        for (int key : keys)
+        {
+            int va = 0, vb = 0;
+            bool ha = a.get(key, va), hb = b.get(key, vb);
+            if (ha != hb || (ha && va != vb))
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+    if (!compare())
+    {
+        return false;
+    }
+    for (int i = 0; i < 4; ++i)
+    {
+        a.put(-1 - i, i);
+        b.put(-1 - i, i);
+    }
+    return compare();
+}
+
+// 在input上比较bulkLoad与逐条put；prefill非空时两个缓存先逐条put同样的prefill
+template<typename Cache, typename Make>
+bool checkEquivalent(const char* name, Make make, const std::vector<Entry>& prefill, const std::vector<Entry>& input)
+{
+    Cache a = make(), b = make();
+    std::set<int> keys;
+    for (const auto& kv : prefill)
+    {
+        a.put(kv.first, kv.second);
+        b.put(kv.first, kv.second);
+        keys.insert(kv.first);
+    }
+    for (const auto& kv : input)
+    {
+        a.put(kv.first, kv.second);
+        keys.insert(kv.first);
+    }
+    b.bulkLoad(input);
+    bool ok = sameContents(a, b, keys);
+    std::cout << (ok ? "  通过  " : "  失败  ") << name << (prefill.empty() ? " (空缓存)" : " (非空缓存)")
+              << std::endl;
+    return ok;
+}
+
+template<typename Cache, typename Make>
+bool checkPolicy(const char* name, Make make, const std::vector<std::vector<Entry>>& inputs)
+{
+    bool ok = true;
+    for (const auto& input : inputs)
+    {
+        ok &= checkEquivalent<Cache>(name, make, {}, input);
+        ok &= checkEquivalent<Cache>(name, make, {{100, 1}, {101, 2}, {100, 3}}, input);
+    }
+    return ok;
+}
+
+void printRow(const std::string& name, double putMs, double bulkMs, bool ok)
+{
+    std::cout << std::left << std::setw(16) << name
+              << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << putMs << " ms"
+              << std::setw(12) << bulkMs << " ms"
+              << std::setw(9) << std::setprecision(1) << putMs / bulkMs << "x"
+              << (ok ? "" : "   [内容不一致]") << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t N = XrmsBench::argOr(argc, argv, 1, 2000000);
+    const int SLICES = static_cast<int>(XrmsBench::argOr(argc, argv, 2, 8));
+    const size_t CHECK = 1000;
+
+    std::vector<Entry> input;
+    input.reserve(N);
+    for (size_t i = 0; i < N; ++i)
+    {
+        input.emplace_back(static_cast<int>(i), static_cast<int>(i * 7));
+    }
+
+    std::cout << "=== 批量加载测试: " << N << " 条, " << SLICES << " 分片 ===" << std::endl;
+    std::cout << std::left << std::setw(16) << "策略"
+              << std::right << std::setw(15) << "逐条put" << std::setw(15) << "bulkLoad"
+              << std::setw(10) << "加速比" << std::endl;
+
+    {
+        XrmsCache::LruCache<int, int> a(N), b(N);
+        double putMs = timePutLoop(a, input);
+        double bulkMs = timeBulkLoad(b, input);
+        printRow("LruCache", putMs, bulkMs, verifyTail(b, input, CHECK));
+    }
+    {
+        XrmsCache::HashLruCaches<int, int> a(N, SLICES), b(N, SLICES);
+        double putMs = timePutLoop(a, input);
+        double bulkMs = timeBulkLoad(b, input);
+        printRow("HashLruCaches", putMs, bulkMs, verifyTail(b, input, CHECK));
+    }
+    {
+        XrmsCache::LfuCache<int, int> a(N), b(N);
+        double putMs = timePutLoop(a, input);
+        double bulkMs = timeBulkLoad(b, input);
+        printRow("LfuCache", putMs, bulkMs, verifyTail(b, input, CHECK));
+    }
+    {
+        XrmsCache::HashLfuCache<int, int> a(N, SLICES), b(N, SLICES);
+        double putMs = timePutLoop(a, input);
+        double bulkMs = timeBulkLoad(b, input);
+        printRow("HashLfuCache", putMs, bulkMs, verifyTail(b, input, CHECK));
+    }
+
+    // 含重复key的输入：A,A,A,B,C（容量2时LFU应保留A和C），以及偏斜分布的随机序列
+    const int A = 1, B = 2, C = 3;
+    std::vector<std::vector<Entry>> inputs = {{{A, 1}, {A, 2}, {A, 3}, {B, 4}, {C, 5}}};
+    std::mt19937 rng(7);
+    for (int round = 0; round < 3; ++round)
+    {
+        std::vector<Entry> skewed;
+        for (int i = 0; i < 2000; ++i)
+        {
+            int key = (rng() % 4 == 0) ? static_cast<int>(rng() % 200) : static_cast<int>(rng() % 16);
+            skewed.emplace_back(key, i);
+        }
+        inputs.push_back(std::move(skewed));
+    }
+
+    std::cout << "=== bulkLoad与逐条put结果核对 ===" << std::endl;
+    bool ok = true;
+    ok &= checkPolicy<XrmsCache::LruCache<int, int>>("LruCache", [] { return XrmsCache::LruCache<int, int>(2); }, {inputs[0]});
+    ok &= checkPolicy<XrmsCache::LfuCache<int, int>>("LfuCache", [] { return XrmsCache::LfuCache<int, int>(2); }, {inputs[0]});
+    std::vector<std::vector<Entry>> randomInputs(inputs.begin() + 1, inputs.end());
+    ok &= checkPolicy<XrmsCache::LruCache<int, int>>("LruCache", [] { return XrmsCache::LruCache<int, int>(40); }, randomInputs);
+    ok &= checkPolicy<XrmsCache::LfuCache<int, int>>("LfuCache", [] { return XrmsCache::LfuCache<int, int>(40); }, randomInputs);
+    ok &= checkPolicy<XrmsCache::HashLruCaches<int, int>>("HashLruCaches",
+        [] { return XrmsCache::HashLruCaches<int, int>(40, 4); }, randomInputs);
+    ok &= checkPolicy<XrmsCache::HashLfuCache<int, int>>("HashLfuCache",
+        [] { return XrmsCache::HashLfuCache<int, int>(40, 4); }, randomInputs);
+    std::cout << (ok ? "bulkLoad结果与逐条put一致" : "bulkLoad结果与逐条put不一致") << std::endl;
+    return ok ? 0 : 1;
+}
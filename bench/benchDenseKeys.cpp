@@ -0,0 +1,116 @@
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BenchUtil.h"
+#include "LruCache.h"
+
+// 稠密整数key测试：哈希索引与直接寻址索引的吞吐和索引内存
+// 1. key为连续id（如数据库自增主键），工作集为容量的2倍：
+//    哈希索引 / 直接数组（key范围不超过容量8倍）/ 两级表（key范围远大于容量，但活跃id集中在最近一段）
+// 2. 分片LRU开启稠密模式前后
+// 用法: benchDenseKeys [容量] [操作次数]
+
+struct Result
+{
+    double mops = 0;
+    double hitRate = 0;
+    size_t indexBytes = 0;
+};
+
+// 每次先get，未命中则put
+static Result run(XrmsCache::LruCache<int, int>& cache, const std::vector<int>& order)
+{
+    long long hits = 0;
+    int value;
+    XrmsBench::Timer timer;
+    for (int key : order)
+    {
+        if (cache.get(key, value))
+            ++hits;
+        else
+            cache.put(key, key);
+    }
+    double ms = timer.elapsedMs();
+    return {order.size() / ms / 1000, 100.0 * hits / order.size(), cache.indexMemory()};
+}
+
+static void print(const std::string& name, const Result& result)
+{
+    std::cout << std::left << std::setw(26) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << result.mops << std::setw(10) << result.hitRate << "%"
+              << std::setw(12) << result.indexBytes / 1024 << " KB" << std::endl;
+}
+
+static std::vector<int> makeOrder(size_t ops, int base, int keyRange, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::vector<int> order(ops);
+    for (auto& key : order)
+        key = base + static_cast<int>(rng() % static_cast<unsigned>(keyRange));
+    return order;
+}
+
+int main(int argc, char* argv[])
+{
+    const int capacity = static_cast<int>(XrmsBench::argOr(argc, argv, 1, 100000));
+    const size_t ops = static_cast<size_t>(XrmsBench::argOr(argc, argv, 2, 2000000));
+
+    std::cout << "=== LruCache<int,int>: 容量 " << capacity << ", " << ops << " 次操作 ===" << std::endl;
+    std::cout << std::left << std::setw(26) << "索引" << std::right << std::setw(10) << "Mops/s"
+              << std::setw(11) << "命中率" << std::setw(15) << "索引内存" << std::endl;
+    struct Workload
+    {
+        const char* name;
+        int maxKey;
+        int base;
+    };
+    // 全部id都在范围内；id空间1亿而活跃id集中在末尾
+    for (const Workload& workload : {Workload{"小范围id", capacity * 2 - 1, 0},
+                                     Workload{"大范围id", 100000000, 100000000 - capacity * 2}})
+    {
+        const int maxKey = workload.maxKey;
+        std::vector<int> order = makeOrder(ops, workload.base, capacity * 2, 7);
+        std::cout << "--- " << workload.name << ", key上界 " << maxKey << " ---" << std::endl;
+        {
+            XrmsCache::LruCache<int, int> cache(capacity);
+            print("哈希索引", run(cache, order));
+        }
+        {
+            XrmsCache::LruCache<int, int> cache(capacity, maxKey);
+            print(workload.base == 0 ? "直接寻址(数组)" : "直接寻址(两级表)", run(cache, order));
+        }
+    }
+
+    const int sliceNum = 4;
+    std::cout << "=== 分片LRU<int,int>: " << sliceNum << " 个分片, 连续id ===" << std::endl;
+    std::vector<int> order = makeOrder(ops, 0, capacity * 2, 11);
+    auto sharded = [&](const char* name, XrmsCache::HashLruCaches<int, int>& cache) {
+        long long hits = 0;
+        int value;
+        XrmsBench::Timer timer;
+        for (int key : order)
+        {
+            if (cache.get(key, value))
+                ++hits;
+            else
+                cache.put(key, key);
+        }
+        double ms = timer.elapsedMs();
+        std::cout << std::left << std::setw(26) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(10) << order.size() / ms / 1000 << std::setw(10) << 100.0 * hits / order.size()
+                  << "%" << std::endl;
+    };
+    {
+        XrmsCache::HashLruCaches<int, int> cache(capacity, sliceNum);
+        sharded("哈希分片", cache);
+    }
+    {
+        XrmsCache::HashLruCaches<int, int> cache(capacity, sliceNum, capacity * 2 - 1);
+        sharded("稠密分片", cache);
+    }
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BenchUtil.h"
+#include "LruCache.h"
+
+// 批量淘汰测试：不同淘汰批大小下，缓存写满后连续插入新key的吞吐，以及热点读写负载的命中率
+// 用法: benchEvictionBatch [容量] [插入次数]
+
+template<typename Value, typename MakeValue>
+static double insertThroughput(int capacity, int inserts, size_t batch, MakeValue makeValue)
+{
+    XrmsCache::LruCache<int, Value> cache(capacity);
+    cache.setEvictionBatch(batch);
+    for (int key = 0; key < capacity; ++key)
+        cache.put(key, makeValue(key));
+
+    std::vector<Value> values;
+    values.reserve(inserts);
+    for (int i = 0; i < inserts; ++i)
+        values.push_back(makeValue(capacity + i));
+
+    XrmsBench::Timer timer;
+    for (int i = 0; i < inserts; ++i)
+        cache.put(capacity + i, std::move(values[i]));
+    return inserts / timer.elapsedMs() / 1000;
+}
+
+// 80%访问落在20%的key上，未命中时写入
+static double hitRate(int capacity, size_t batch)
+{
+    XrmsCache::LruCache<int, int> cache(capacity);
+    cache.setEvictionBatch(batch);
+    std::mt19937 rng(3);
+    int keyRange = capacity * 5;
+    int hot = keyRange / 5;
+    long long hits = 0, total = 2000000;
+    int value;
+    for (long long i = 0; i < total; ++i)
+    {
+        int key = rng() % 100 < 80 ? static_cast<int>(rng() % hot) : static_cast<int>(rng() % keyRange);
+        if (cache.get(key, value))
+            ++hits;
+        else
+            cache.put(key, key);
+    }
+    return 100.0 * hits / total;
+}
+
+int main(int argc, char* argv[])
+{
+    const int capacity = static_cast<int>(XrmsBench::argOr(argc, argv, 1, 100000));
+    const int inserts = static_cast<int>(XrmsBench::argOr(argc, argv, 2, 2000000));
+    auto intValue = [](int key) { return key; };
+    auto stringValue = [](int key) { return "evicted-value-" + std::to_string(key); };
+
+    std::cout << "=== 容量 " << capacity << ", 写满后插入 " << inserts << " 个新key ===" << std::endl;
+    std::cout << std::setw(8) << "批大小" << std::setw(18) << "<int,int> Mops/s"
+              << std::setw(21) << "<int,string> Mops/s" << std::setw(12) << "命中率" << std::endl;
+    for (size_t batch : {1, 8, 32, 128})
+    {
+        std::cout << std::setw(8) << batch << std::fixed << std::setprecision(2)
+                  << std::setw(18) << insertThroughput<int>(capacity, inserts, batch, intValue)
+                  << std::setw(21) << insertThroughput<std::string>(capacity, inserts, batch, stringValue)
+                  << std::setw(11) << hitRate(capacity, batch) << "%" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BenchUtil.h"
+#include "FlatLruCache.h"
+#include "LruCache.h"
+
+// 可平凡拷贝key/value的紧凑LRU测试：FlatLruCache与LruCache对比
+// 1. 同一串随机put/get/remove，两者的命中结果和取到的值必须一致
+// 2. 每条目字节数（条目数组+索引 / 节点+索引）
+// 3. 命中为主和未命中为主两种负载的吞吐，value为int和32字节结构体
+// 用法: benchFlatLru [容量] [操作次数]
+
+struct Record
+{
+    uint64_t id;
+    uint64_t version;
+    double score;
+    uint32_t flags;
+    uint32_t owner;
+};
+
+template<typename Value>
+static Value makeValue(int key)
+{
+    if constexpr (std::is_same<Value, int>::value)
+    {
+        return key;
+    }
+    else
+    {
+        return Value{static_cast<uint64_t>(key), 1, key * 0.5, 0, 7};
+    }
+}
+
+template<typename Cache, typename Value>
+static double run(Cache& cache, const std::vector<int>& order)
+{
+    long long hits = 0;
+    Value value;
+    XrmsBench::Timer timer;
+    for (int key : order)
+    {
+        if (cache.get(key, value))
+            ++hits;
+        else
+            cache.put(key, makeValue<Value>(key));
+    }
+    XrmsBench::doNotOptimize(hits);
+    return order.size() / timer.elapsedMs() / 1000;
+}
+
+template<typename Value>
+static void compare(const char* name, int capacity, const std::vector<int>& order)
+{
+    XrmsCache::LruCache<int, Value> lru(capacity);
+    XrmsCache::FlatLruCache<int, Value> flat(capacity);
+    double lruMops = run<XrmsCache::LruCache<int, Value>, Value>(lru, order);
+    double flatMops = run<XrmsCache::FlatLruCache<int, Value>, Value>(flat, order);
+    std::cout << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(12) << lruMops << std::setw(12) << flatMops << std::endl;
+}
+
+template<typename Value>
+static void footprint(const char* name, int capacity)
+{
+    XrmsCache::LruCache<int, Value> lru(capacity);
+    XrmsCache::FlatLruCache<int, Value> flat(capacity);
+    for (int i = 0; i < capacity; ++i)
+    {
+        lru.put(i, makeValue<Value>(i));
+        flat.put(i, makeValue<Value>(i));
+    }
+    double lruBytes = sizeof(XrmsCache::LruNode<int, Value>) + sizeof(XrmsCache::LruPayload<int, Value>)
+                    + static_cast<double>(lru.indexMemory()) / capacity;
+    double flatBytes = static_cast<double>(flat.memoryBytes()) / capacity;
+    std::cout << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << lruBytes << std::setw(12) << flatBytes << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    const int capacity = static_cast<int>(XrmsBench::argOr(argc, argv, 1, 100000));
+    const size_t ops = static_cast<size_t>(XrmsBench::argOr(argc, argv, 2, 2000000));
+
+    bool consistent = true;
+    {
+        XrmsCache::LruCache<int, int> lru(capacity);
+        XrmsCache::FlatLruCache<int, int> flat(capacity);
+        std::mt19937 rng(3);
+        for (size_t i = 0; i < ops; ++i)
+        {
+            int key = static_cast<int>(rng() % static_cast<unsigned>(capacity * 2));
+            int op = static_cast<int>(rng() % 10);
+            if (op == 0)
+            {
+                lru.remove(key);
+                flat.remove(key);
+            }
+            else if (op < 6)
+            {
+                int a = -1, b = -1;
+                consistent &= lru.get(key, a) == flat.get(key, b) && a == b;
+            }
+            else
+            {
+                lru.put(key, static_cast<int>(i));
+                flat.put(key, static_cast<int>(i));
+            }
+        }
+        consistent &= lru.size() == flat.size();
+    }
+    std::cout << "=== 与LruCache逐次比较: " << (consistent ? "一致" : "不一致") << " ===" << std::endl;
+
+    std::cout << "=== 每条目字节数: 容量 " << capacity << " ===" << std::endl;
+    std::cout << std::left << std::setw(22) << "value" << std::right << std::setw(12) << "LruCache"
+              << std::setw(12) << "FlatLru" << std::endl;
+    footprint<int>("int", capacity);
+    footprint<Record>("32字节结构体", capacity);
+
+    std::cout << "=== 吞吐 (Mops/s): " << ops << " 次操作 ===" << std::endl;
+    std::cout << std::left << std::setw(22) << "负载" << std::right << std::setw(12) << "LruCache"
+              << std::setw(12) << "FlatLru" << std::endl;
+    std::mt19937 rng(7);
+    std::vector<int> hitHeavy(ops), missHeavy(ops);
+    for (size_t i = 0; i < ops; ++i)
+    {
+        hitHeavy[i] = static_cast<int>(rng() % static_cast<unsigned>(capacity / 2));
+        missHeavy[i] = static_cast<int>(rng() % static_cast<unsigned>(capacity * 8));
+    }
+    compare<int>("命中为主 int", capacity, hitHeavy);
+    compare<int>("未命中为主 int", capacity, missHeavy);
+    compare<Record>("命中为主 结构体", capacity, hitHeavy);
+    compare<Record>("未命中为主 结构体", capacity, missHeavy);
+    return consistent ? 0 : 1;
+}
@@ -0,0 +1,185 @@
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BenchUtil.h"
+#include "CacheHash.h"
+#include "LruCache.h"
+
+// 哈希函数测试：std::hash与CacheHash对比
+// 1. 吞吐：整数和不同长度字符串每次哈希的耗时
+// 2. 分布：连续/等间隔整数和字符串按 hash % 分片数 分片后的最大负载，以及低位取桶的卡方值
+// 3. 雪崩：翻转输入的每一位，输出平均翻转的位数（理想为32）和最偏的输出位
+// 4. 分片LRU在等间隔整数key下的命中率和吞吐
+// 用法: benchHash [key数] [分片数]
+
+template<typename Key, typename Hasher>
+static double nsPerHash(const std::vector<Key>& keys, int rounds)
+{
+    Hasher hasher;
+    size_t sum = 0;
+    XrmsBench::Timer timer;
+    for (int r = 0; r < rounds; ++r)
+        for (const Key& key : keys)
+            sum += hasher(key);
+    XrmsBench::doNotOptimize(sum);
+    return timer.elapsedNs() / (static_cast<double>(keys.size()) * rounds);
+}
+
+// 分片最大负载/平均负载，1.00为完全均匀
+template<typename Key, typename Hasher>
+static double shardImbalance(const std::vector<Key>& keys, int sliceNum)
+{
+    Hasher hasher;
+    std::vector<size_t> load(sliceNum, 0);
+    for (const Key& key : keys)
+        ++load[hasher(key) % sliceNum];
+    double average = static_cast<double>(keys.size()) / sliceNum;
+    return *std::max_element(load.begin(), load.end()) / average;
+}
+
+// 用低位取桶（hash & (buckets-1)）时的卡方值除以自由度，接近1为均匀
+template<typename Key, typename Hasher>
+static double bucketChiSquare(const std::vector<Key>& keys)
+{
+    Hasher hasher;
+    size_t buckets = 1;
+    while (buckets * 4 < keys.size())
+        buckets <<= 1;
+    std::vector<size_t> count(buckets, 0);
+    for (const Key& key : keys)
+        ++count[hasher(key) & (buckets - 1)];
+    double expected = static_cast<double>(keys.size()) / buckets;
+    double chi = 0;
+    for (size_t c : count)
+        chi += (c - expected) * (c - expected) / expected;
+    return chi / (buckets - 1);
+}
+
+// 整数key翻转一位后输出翻转位数的平均值，以及各输出位翻转概率偏离0.5的最大值
+template<typename Hasher>
+static void avalanche(const char* name, int samples)
+{
+    Hasher hasher;
+    std::mt19937_64 rng(1);
+    std::vector<double> flips(64, 0);
+    double totalBits = 0;
+    for (int s = 0; s < samples; ++s)
+    {
+        uint64_t x = rng();
+        uint64_t h = hasher(x);
+        for (int bit = 0; bit < 64; ++bit)
+        {
+            uint64_t diff = h ^ hasher(x ^ (1ull << bit));
+            totalBits += std::bitset<64>(diff).count();
+            for (int out = 0; out < 64; ++out)
+                flips[out] += (diff >> out) & 1;
+        }
+    }
+    double worst = 0;
+    for (double f : flips)
+        worst = std::max(worst, std::fabs(f / (samples * 64.0) - 0.5));
+    std::cout << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(12) << totalBits / (samples * 64.0) << std::setw(14) << worst << std::endl;
+}
+
+template<typename Hasher>
+static void shardedLru(const char* name, const std::vector<uint64_t>& keys, size_t capacity, int sliceNum)
+{
+    XrmsCache::HashLruCaches<uint64_t, uint64_t, Hasher> cache(capacity, sliceNum);
+    std::mt19937 rng(9);
+    long long hits = 0, ops = 2000000;
+    uint64_t value;
+    XrmsBench::Timer timer;
+    for (long long i = 0; i < ops; ++i)
+    {
+        const uint64_t& key = keys[rng() % keys.size()];
+        if (cache.get(key, value))
+            ++hits;
+        else
+            cache.put(key, key);
+    }
+    double ms = timer.elapsedMs();
+    std::cout << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(12) << ops / ms / 1000 << std::setw(11) << 100.0 * hits / ops << "%" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t n = static_cast<size_t>(XrmsBench::argOr(argc, argv, 1, 1000000));
+    const int sliceNum = static_cast<int>(XrmsBench::argOr(argc, argv, 2, 16));
+    using StdInt = std::hash<uint64_t>;
+    using CacheInt = XrmsCache::CacheHash<uint64_t>;
+    using StdString = std::hash<std::string>;
+    using CacheString = XrmsCache::CacheHash<std::string>;
+
+    std::vector<uint64_t> sequential(n), strided(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        sequential[i] = i;
+        strided[i] = i * static_cast<uint64_t>(sliceNum) * 4;   // 对齐的id、指针等常见模式
+    }
+
+    std::cout << "=== 吞吐 (ns/次) ===" << std::endl;
+    std::cout << std::left << std::setw(22) << "key" << std::right << std::setw(12) << "std::hash"
+              << std::setw(12) << "CacheHash" << std::endl;
+    std::cout << std::left << std::setw(22) << "uint64" << std::right << std::fixed << std::setprecision(2)
+              << std::setw(12) << nsPerHash<uint64_t, StdInt>(sequential, 5)
+              << std::setw(12) << nsPerHash<uint64_t, CacheInt>(sequential, 5) << std::endl;
+    for (size_t length : {8, 16, 32, 64, 256, 1024})
+    {
+        std::vector<std::string> keys;
+        size_t count = std::max<size_t>(1000, n / 10 / std::max<size_t>(1, length / 16));
+        for (size_t i = 0; i < count; ++i)
+        {
+            std::string key = std::to_string(i) + ":";
+            key.resize(std::max(length, key.size()), 'k');
+            keys.push_back(std::move(key));
+        }
+        std::cout << std::left << std::setw(22) << ("string " + std::to_string(length) + "B") << std::right
+                  << std::setw(12) << nsPerHash<std::string, StdString>(keys, 3)
+                  << std::setw(12) << nsPerHash<std::string, CacheString>(keys, 3) << std::endl;
+    }
+
+    std::vector<std::string> strings;
+    for (size_t i = 0; i < n; ++i)
+        strings.push_back("user:" + std::to_string(i));
+
+    std::cout << "=== 分布: " << sliceNum << " 个分片的最大负载/平均负载, 低位取桶的卡方/自由度 ===" << std::endl;
+    std::cout << std::left << std::setw(22) << "key" << std::right << std::setw(12) << "std分片"
+              << std::setw(12) << "Cache分片" << std::setw(14) << "std卡方" << std::setw(14) << "Cache卡方" << std::endl;
+    auto distribution = [&](const char* name, const auto& keys, auto stdHash, auto cacheHash) {
+        using Key = typename std::decay_t<decltype(keys)>::value_type;
+        using Std = decltype(stdHash);
+        using Cache = decltype(cacheHash);
+        std::cout << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(12) << shardImbalance<Key, Std>(keys, sliceNum)
+                  << std::setw(12) << shardImbalance<Key, Cache>(keys, sliceNum)
+                  << std::setw(14) << bucketChiSquare<Key, Std>(keys)
+                  << std::setw(14) << bucketChiSquare<Key, Cache>(keys) << std::endl;
+    };
+    distribution("连续整数", sequential, StdInt(), CacheInt());
+    distribution("等间隔整数", strided, StdInt(), CacheInt());
+    distribution("字符串 user:N", strings, StdString(), CacheString());
+
+    std::cout << "=== 雪崩: 翻转输入一位 ===" << std::endl;
+    std::cout << std::left << std::setw(22) << "哈希" << std::right << std::setw(12) << "平均翻转位"
+              << std::setw(14) << "最大偏差" << std::endl;
+    avalanche<StdInt>("std::hash<uint64>", 2000);
+    avalanche<CacheInt>("CacheHash<uint64>", 2000);
+
+    std::cout << "=== 分片LRU: 等间隔整数key, 总容量 " << n / 4 << ", " << sliceNum << " 个分片 ===" << std::endl;
+    std::cout << std::left << std::setw(22) << "哈希" << std::right << std::setw(12) << "Mops/s"
+              << std::setw(12) << "命中率" << std::endl;
+    std::vector<uint64_t> hotKeys(strided.begin(), strided.begin() + n / 5);
+    shardedLru<StdInt>("std::hash", hotKeys, n / 4, sliceNum);
+    shardedLru<CacheInt>("CacheHash", hotKeys, n / 4, sliceNum);
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BenchUtil.h"
+#include "CacheMemory.h"
+#include "FlatLruCache.h"
+#include "LruCache.h"
+
+// 大页内存测试：同一缓存分别用默认malloc和CacheMemory::hugePages()分配节点内存池和索引
+// 写满后按随机key查找（全部命中），报告每次查找耗时、透明大页承载的内存和每次查找的硬件事件数（重点看dTLB-miss）
+// 硬件计数依赖perf_event_open，不可用时显示n/a；THP未开启时大页列为0，两者耗时应基本相同
+// 用法: benchHugePages [容量] [查找次数]
+
+// /proc/self/smaps_rollup中的AnonHugePages，单位MB
+static long long anonHugePagesMb()
+{
+    std::ifstream in("/proc/self/smaps_rollup");
+    std::string line;
+    while (std::getline(in, line))
+    {
+        if (line.compare(0, 14, "AnonHugePages:") == 0)
+        {
+            std::istringstream fields(line.substr(14));
+            long long kb = 0;
+            fields >> kb;
+            return kb / 1024;
+        }
+    }
+    return -1;
+}
+
+template<typename Cache>
+static void run(const char* name, std::pmr::memory_resource* resource, int capacity, const std::vector<int>& order)
+{
+    Cache cache(capacity, resource);
+    for (int i = 0; i < capacity; ++i)
+    {
+        cache.put(i, i);
+    }
+
+    XrmsBench::PerfCounters counters;
+    long long hits = 0;
+    int value = 0;
+    counters.start();
+    XrmsBench::Timer timer;
+    for (int key : order)
+    {
+        hits += cache.get(key, value);
+    }
+    double ns = timer.elapsedNs() / order.size();
+    counters.stop();
+    XrmsBench::doNotOptimize(hits);
+
+    std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << ns << std::setw(12) << anonHugePagesMb();
+    counters.print(std::cout, order.size());
+    std::cout << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    const int capacity = static_cast<int>(XrmsBench::argOr(argc, argv, 1, 4000000));
+    const size_t ops = static_cast<size_t>(XrmsBench::argOr(argc, argv, 2, 4000000));
+
+    std::mt19937 rng(23);
+    std::vector<int> order(ops);
+    for (size_t i = 0; i < ops; ++i)
+    {
+        order[i] = static_cast<int>(rng() % static_cast<unsigned>(capacity));
+    }
+
+    std::cout << "=== 随机命中查找: 容量 " << capacity << ", " << ops << " 次 ===" << std::endl;
+    std::cout << std::left << std::setw(24) << "缓存" << std::right << std::setw(12) << "ns/次"
+              << std::setw(12) << "大页MB";
+    XrmsBench::PerfCounters::printHeader(std::cout);
+    std::cout << std::endl;
+    XrmsCache::CacheMemory::HugePageResource* huge = XrmsCache::CacheMemory::hugePages();
+    run<XrmsCache::LruCache<int, int>>("LruCache malloc", nullptr, capacity, order);
+    run<XrmsCache::LruCache<int, int>>("LruCache 大页", huge, capacity, order);
+    run<XrmsCache::FlatLruCache<int, int>>("FlatLruCache malloc", nullptr, capacity, order);
+    run<XrmsCache::FlatLruCache<int, int>>("FlatLruCache 大页", huge, capacity, order);
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ArcCache/ArcCache.h"
+#include "BenchUtil.h"
+#include "CacheIndex.h"
+#include "LruCache.h"
+
+// 索引扩容测试：
+// 1. 逐个插入N个key，统计单次插入延迟的p99.9和最大值
+//    std::unordered_map不预分配 / 预分配 / IncrementalHashMap不预分配
+// 2. IncrementalHashMap与std::unordered_map执行同一串随机插入删除，检查结果一致
+// 3. 缓存填充：LruCache（构造时预分配索引）和ArcCache的单次put最大延迟
+// 用法: benchIndexGrowth [key数]
+
+struct Latency
+{
+    double totalMs = 0;
+    double p999Ns = 0;
+    double maxNs = 0;
+};
+
+template<typename Fn>
+static Latency measure(long long n, Fn fn)
+{
+    std::vector<double> samples(static_cast<size_t>(n));
+    XrmsBench::Timer total;
+    for (long long i = 0; i < n; ++i)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        fn(i);
+        samples[static_cast<size_t>(i)] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    }
+    Latency result;
+    result.totalMs = total.elapsedMs();
+    std::sort(samples.begin(), samples.end());
+    result.p999Ns = samples[static_cast<size_t>(n * 0.999)];
+    result.maxNs = samples.back();
+    return result;
+}
+
+static void print(const std::string& name, const Latency& latency)
+{
+    std::cout << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << latency.totalMs << " ms" << std::setw(12) << latency.p999Ns << " ns"
+              << std::setw(14) << latency.maxNs / 1000 << " us" << std::endl;
+}
+
+static void printHeader()
+{
+    std::cout << std::left << std::setw(28) << "索引" << std::right << std::setw(13) << "总耗时"
+              << std::setw(15) << "p99.9" << std::setw(17) << "最大" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    const long long n = XrmsBench::argOr(argc, argv, 1, 2000000);
+
+    std::cout << "=== 逐个插入 " << n << " 个key ===" << std::endl;
+    printHeader();
+    {
+        std::unordered_map<uint64_t, uint64_t> map;
+        print("unordered_map", measure(n, [&](long long i) { map[static_cast<uint64_t>(i)] = i; }));
+    }
+    {
+        std::unordered_map<uint64_t, uint64_t> map;
+        map.reserve(static_cast<size_t>(n));
+        print("unordered_map + reserve", measure(n, [&](long long i) { map[static_cast<uint64_t>(i)] = i; }));
+    }
+    {
+        XrmsCache::IncrementalHashMap<uint64_t, uint64_t> map;
+        print("IncrementalHashMap", measure(n, [&](long long i) { map.insertOrAssign(static_cast<uint64_t>(i), i); }));
+    }
+
+    std::cout << "=== 随机插入删除一致性 ===" << std::endl;
+    bool consistent = true;
+    {
+        XrmsCache::IncrementalHashMap<std::string, int> map;
+        std::unordered_map<std::string, int> expected;
+        std::mt19937 rng(3);
+        const int keyRange = 50000;
+        for (long long i = 0; i < n; ++i)
+        {
+            std::string key = "key" + std::to_string(rng() % keyRange);
+            // 前半段以插入为主让表持续扩容，后半段插入删除各半
+            if (rng() % 100 < (i < n / 2 ? 80 : 50))
+            {
+                map.insertOrAssign(key, static_cast<int>(i));
+                expected[key] = static_cast<int>(i);
+            }
+            else
+            {
+                consistent &= map.erase(key) == (expected.erase(key) == 1);
+            }
+        }
+        consistent &= map.size() == expected.size();
+        for (const auto& entry : expected)
+        {
+            int* value = map.find(entry.first);
+            consistent &= value && *value == entry.second;
+        }
+        size_t visited = 0;
+        map.forEach([&](const std::string&, int&) { ++visited; });
+        consistent &= visited == expected.size();
+        std::cout << (consistent ? "一致" : "不一致") << ", 元素数 " << map.size() << std::endl;
+    }
+
+    std::cout << "=== 缓存填充: 容量 " << n / 2 << ", 插入 " << n << " 个key ===" << std::endl;
+    printHeader();
+    {
+        XrmsCache::LruCache<int, int> lru(static_cast<int>(n / 2));
+        print("LruCache", measure(n, [&](long long i) { lru.put(static_cast<int>(i), static_cast<int>(i)); }));
+        XrmsCache::ArcCache<int, int> arc(static_cast<int>(n / 2));
+        print("ArcCache", measure(n, [&](long long i) { arc.put(static_cast<int>(i), static_cast<int>(i)); }));
+    }
+    return consistent ? 0 : 1;
+}
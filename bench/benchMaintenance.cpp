@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "BenchUtil.h"
+#include "CacheMaintainer.h"
+#include "LfuCache.h"
+#include "LruCache.h"
+
+// 后台维护测试：缓存写满后持续插入新key，对比淘汰全部在前台进行与交给维护线程（水位90%~95%）时
+// 单次put的延迟分布，并检查结束时条目数不超过容量
+// 用法: benchMaintenance [容量] [插入次数]
+
+static std::string valueOf(int key) { return "maintained-value-" + std::to_string(key); }
+
+template<typename Cache>
+static void runCase(const std::string& name, Cache& cache, int capacity, int inserts,
+                    XrmsCache::CacheMaintainer* maintainer)
+{
+    if (maintainer)
+    {
+        cache.setMaintainer(maintainer, capacity * 9 / 10, capacity * 95 / 100);
+    }
+    for (int key = 0; key < capacity; ++key)
+    {
+        cache.put(key, valueOf(key));
+    }
+
+    std::vector<double> latencies(inserts);
+    for (int i = 0; i < inserts; ++i)
+    {
+        int key = capacity + i;
+        std::string value = valueOf(key);
+        auto start = std::chrono::steady_clock::now();
+        cache.put(key, std::move(value));
+        latencies[i] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+    size_t finalSize = cache.size();
+    if (maintainer)
+    {
+        cache.setMaintainer(nullptr, 0, 0);
+    }
+
+    double total = 0;
+    for (double ns : latencies)
+        total += ns;
+    std::sort(latencies.begin(), latencies.end());
+    auto pct = [&](double p) { return latencies[std::min(latencies.size() - 1, static_cast<size_t>(latencies.size() * p))]; };
+    std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(0)
+              << std::setw(9) << total / inserts << std::setw(9) << pct(0.5) << std::setw(9) << pct(0.99)
+              << std::setw(10) << pct(0.999) << std::setw(11) << latencies.back()
+              << std::setw(11) << finalSize << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    const int capacity = static_cast<int>(XrmsBench::argOr(argc, argv, 1, 200000));
+    const int inserts = static_cast<int>(XrmsBench::argOr(argc, argv, 2, 1000000));
+
+    std::cout << "=== 容量 " << capacity << ", 写满后插入 " << inserts << " 个新key, 单位ns ===" << std::endl;
+    std::cout << std::left << std::setw(24) << "缓存" << std::right << std::setw(9) << "mean" << std::setw(9) << "p50"
+              << std::setw(9) << "p99" << std::setw(10) << "p999" << std::setw(11) << "max" << std::setw(11) << "size" << std::endl;
+
+    XrmsCache::CacheMaintainer maintainer(1, std::chrono::milliseconds(10));
+    {
+        XrmsCache::LruCache<int, std::string> cache(capacity);
+        runCase("LruCache 前台淘汰", cache, capacity, inserts, nullptr);
+    }
+    {
+        XrmsCache::LruCache<int, std::string> cache(capacity);
+        runCase("LruCache 后台维护", cache, capacity, inserts, &maintainer);
+    }
+    {
+        XrmsCache::LfuCache<int, std::string> cache(capacity);
+        runCase("LfuCache 前台淘汰", cache, capacity, inserts, nullptr);
+    }
+    {
+        XrmsCache::LfuCache<int, std::string> cache(capacity);
+        runCase("LfuCache 后台维护", cache, capacity, inserts, &maintainer);
+    }
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "ArcCache/ArcCache.h"
+#include "BenchUtil.h"
+#include "CacheMemory.h"
+#include "LfuCache.h"
+#include "LruCache.h"
+
+// 每条目内存占用测试：各缓存写满后按memoryUsage()的分类输出每个容量单位的字节数
+// key为int，value为64字节的std::string（超出短字符串缓冲区，计入values）
+// 写入2倍容量的不同key使幽灵列表写满，再重复访问一部分key，让LFU和ARC的频率结构有多个频次
+// 缓存的resource是一个CountingResource，"核对"列比较它记录的字节数与index+nodes+ghost+frequency是否一致
+// 用法: benchMemoryFootprint [最大容量]
+
+template<typename Cache>
+static void fill(Cache& cache, int capacity)
+{
+    const std::string value(64, 'v');
+    for (int i = 0; i < capacity * 2; ++i)
+    {
+        cache.put(i, value);
+    }
+    std::string out;
+    int hot = std::min(capacity, 1000);
+    for (int round = 0; round < 2; ++round)
+    {
+        for (int i = capacity * 2 - hot; i < capacity * 2; ++i)
+        {
+            cache.get(i, out);
+        }
+    }
+}
+
+// LRU-K中key的历史访问次数达到k之后再写一次才进入缓存，先按k=2多写两遍
+template<typename Key, typename Value>
+static void fill(XrmsCache::LruKCache<Key, Value>& cache, int capacity)
+{
+    const std::string value(64, 'v');
+    for (int i = 0; i < capacity * 2; ++i)
+    {
+        for (int pass = 0; pass < 3; ++pass)
+        {
+            cache.put(i, value);
+        }
+    }
+    std::string out;
+    for (int i = capacity * 2 - std::min(capacity, 1000); i < capacity * 2; ++i)
+    {
+        cache.get(i, out);
+    }
+}
+
+static void report(const char* name, int capacity, const XrmsCache::CacheMemoryUsage& usage,
+                   const XrmsCache::CacheMemory::CountingResource& counted)
+{
+    double n = capacity;
+    size_t structural = usage.index + usage.nodes + usage.ghost + usage.frequency;
+    std::cout << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << usage.index / n << std::setw(10) << usage.nodes / n
+              << std::setw(10) << usage.ghost / n << std::setw(10) << usage.frequency / n
+              << std::setw(10) << usage.values / n << std::setw(10) << usage.total() / n;
+    if (counted.bytes() == structural)
+    {
+        std::cout << std::setw(10) << "一致" << std::endl;
+    }
+    else
+    {
+        std::cout << std::setw(10) << static_cast<long long>(counted.bytes()) - static_cast<long long>(structural)
+                  << std::endl;
+    }
+}
+
+template<typename Cache, typename Make>
+static void measure(const char* name, int capacity, Make make)
+{
+    XrmsCache::CacheMemory::CountingResource counted;
+    {
+        Cache* cache = make(capacity, &counted);
+        fill(*cache, capacity);
+        report(name, capacity, cache->memoryUsage(), counted);
+        delete cache;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    using Value = std::string;
+    const int maxCapacity = static_cast<int>(XrmsBench::argOr(argc, argv, 1, 100000));
+
+    for (int capacity = 1000; capacity <= maxCapacity; capacity *= 10)
+    {
+        std::cout << "=== 容量 " << capacity << ", 每个容量单位的字节数 ===" << std::endl;
+        std::cout << std::left << std::setw(16) << "缓存" << std::right << std::setw(10) << "index"
+                  << std::setw(10) << "nodes" << std::setw(10) << "ghost" << std::setw(10) << "freq"
+                  << std::setw(10) << "values" << std::setw(10) << "total" << std::setw(10) << "核对" << std::endl;
+        measure<XrmsCache::LruCache<int, Value>>("LruCache", capacity, [](int c, std::pmr::memory_resource* r) {
+            return new XrmsCache::LruCache<int, Value>(c, r);
+        });
+        measure<XrmsCache::LruKCache<int, Value>>("LruKCache", capacity, [](int c, std::pmr::memory_resource* r) {
+            return new XrmsCache::LruKCache<int, Value>(c, c, 2, r);
+        });
+        measure<XrmsCache::LfuCache<int, Value>>("LfuCache", capacity, [](int c, std::pmr::memory_resource* r) {
+            return new XrmsCache::LfuCache<int, Value>(c, 10, r);
+        });
+        measure<XrmsCache::ArcCache<int, Value>>("ArcCache", capacity, [](int c, std::pmr::memory_resource* r) {
+            return new XrmsCache::ArcCache<int, Value>(c, 2, r);
+        });
+        measure<XrmsCache::HashLruCaches<int, Value>>("HashLruCaches/4", capacity, [](int c, std::pmr::memory_resource* r) {
+            return new XrmsCache::HashLruCaches<int, Value>(c, 4, r);
+        });
+        measure<XrmsCache::HashLfuCache<int, Value>>("HashLfuCache/4", capacity, [](int c, std::pmr::memory_resource* r) {
+            return new XrmsCache::HashLfuCache<int, Value>(c, 4, 10, r);
+        });
+    }
+    return 0;
+}
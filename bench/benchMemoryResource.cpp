@@ -0,0 +1,99 @@
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <memory_resource>
+#include <random>
+#include <vector>
+
+#include "ArcCache/ArcCache.h"
+#include "BenchUtil.h"
+#include "LfuCache.h"
+#include "LruCache.h"
+
+// 内存来源测试：同一缓存分别使用默认malloc、monotonic_buffer_resource和unsynchronized_pool_resource
+// 每轮构造缓存、写满后继续随机读写、析构；monotonic的缓冲区在轮次之间release后复用，
+// 析构时逐块归还变成空操作，整轮结束一次性回收
+// 用法: benchMemoryResource [容量] [每轮操作次数] [轮数]
+
+template<typename Cache>
+static double run(std::pmr::memory_resource* resource, int capacity, const std::vector<int>& order, int rounds,
+                  std::pmr::monotonic_buffer_resource* monotonic)
+{
+    long long hits = 0;
+    XrmsBench::Timer timer;
+    for (int round = 0; round < rounds; ++round)
+    {
+        {
+            Cache cache(capacity, resource);
+            for (int i = 0; i < capacity; ++i)
+            {
+                cache.put(i, i);
+            }
+            int value = 0;
+            for (int key : order)
+            {
+                if (cache.get(key, value))
+                    ++hits;
+                else
+                    cache.put(key, key);
+            }
+        }
+        if (monotonic)
+        {
+            monotonic->release();
+        }
+    }
+    XrmsBench::doNotOptimize(hits);
+    return timer.elapsedMs() / rounds;
+}
+
+template<typename Cache>
+static void compare(const char* name, int capacity, const std::vector<int>& order, int rounds)
+{
+    // 缓冲区取一轮所需的大小，之后的轮次不再向上游申请
+    std::pmr::monotonic_buffer_resource monotonic(static_cast<size_t>(capacity) * 512);
+    std::pmr::unsynchronized_pool_resource pool;
+
+    double mallocMs = run<Cache>(nullptr, capacity, order, rounds, nullptr);
+    double monotonicMs = run<Cache>(&monotonic, capacity, order, rounds, &monotonic);
+    double poolMs = run<Cache>(&pool, capacity, order, rounds, nullptr);
+    std::cout << std::left << std::setw(12) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(12) << mallocMs << std::setw(14) << monotonicMs << std::setw(12) << poolMs << std::endl;
+}
+
+// ArcCache的构造参数多一个转换阈值
+struct ArcForBench : XrmsCache::ArcCache<int, int>
+{
+    ArcForBench(int capacity, std::pmr::memory_resource* resource)
+        : XrmsCache::ArcCache<int, int>(capacity, 2, resource)
+    {}
+};
+
+struct LfuForBench : XrmsCache::LfuCache<int, int>
+{
+    LfuForBench(int capacity, std::pmr::memory_resource* resource)
+        : XrmsCache::LfuCache<int, int>(capacity, 10, resource)
+    {}
+};
+
+int main(int argc, char* argv[])
+{
+    const int capacity = static_cast<int>(XrmsBench::argOr(argc, argv, 1, 5000));
+    const size_t ops = static_cast<size_t>(XrmsBench::argOr(argc, argv, 2, 50000));
+    const int rounds = static_cast<int>(XrmsBench::argOr(argc, argv, 3, 10));
+
+    std::mt19937 rng(17);
+    std::vector<int> order(ops);
+    for (size_t i = 0; i < ops; ++i)
+    {
+        order[i] = static_cast<int>(rng() % static_cast<unsigned>(capacity * 2));
+    }
+
+    std::cout << "=== 每轮耗时 (ms): 容量 " << capacity << ", 每轮 " << ops << " 次操作, " << rounds << " 轮 ===" << std::endl;
+    std::cout << std::left << std::setw(12) << "缓存" << std::right << std::setw(12) << "malloc"
+              << std::setw(14) << "monotonic" << std::setw(12) << "pool" << std::endl;
+    compare<XrmsCache::LruCache<int, int>>("LruCache", capacity, order, rounds);
+    compare<LfuForBench>("LfuCache", capacity, order, rounds);
+    compare<ArcForBench>("ArcCache", capacity, order, rounds);
+    return 0;
+}
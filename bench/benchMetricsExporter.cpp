@@ -0,0 +1,223 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ArcCache/ArcCache.h"
+#include "BenchUtil.h"
+#include "CacheMetrics.h"
+#include "LfuCache.h"
+#include "LruCache.h"
+#include "MetricsExporter.h"
+
+// 指标导出测试：
+// 1. 同一串get/put（未命中时put）分别在不挂指标和挂指标的分片缓存上运行，比较每次操作耗时
+// 2. 启动MetricsExporter（127.0.0.1，系统分配端口），多个线程持续访问缓存的同时用回环连接反复抓取/metrics；
+//    结束后再抓一次，核对各分片hits/misses之和与实际操作数一致、抽样的get延迟直方图计数约为操作数的1/8，MRC和幽灵命中等指标存在，
+//    其他路径返回404。任何一项不符时以非0退出
+// 用法: benchMetricsExporter [容量] [每线程操作次数] [线程数]
+
+// 回环HTTP客户端：发送一个GET请求，返回完整回复（状态行、头部和正文）
+static std::string httpGet(uint16_t port, const std::string& path)
+{
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+    {
+        if (fd >= 0)
+            ::close(fd);
+        return "";
+    }
+    std::string request = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    ::send(fd, request.data(), request.size(), MSG_NOSIGNAL);
+    std::string response;
+    char buffer[4096];
+    ssize_t n;
+    while ((n = ::read(fd, buffer, sizeof(buffer))) > 0)
+    {
+        response.append(buffer, static_cast<size_t>(n));
+    }
+    ::close(fd);
+    return response;
+}
+
+// 对正文中名为name、标签含有labelFilter的所有样本求和；找不到时返回-1
+static double sumSamples(const std::string& body, const std::string& name, const std::string& labelFilter)
+{
+    std::istringstream lines(body);
+    std::string line;
+    double sum = 0;
+    bool found = false;
+    while (std::getline(lines, line))
+    {
+        if (line.compare(0, name.size() + 1, name + "{") != 0 || line.find(labelFilter) == std::string::npos)
+        {
+            continue;
+        }
+        sum += std::stod(line.substr(line.rfind(' ') + 1));
+        found = true;
+    }
+    return found ? sum : -1;
+}
+
+template<typename Cache>
+static double nsPerOp(Cache& cache, const std::vector<int>& order)
+{
+    int value = 0;
+    long long hits = 0;
+    XrmsBench::Timer timer;
+    for (int key : order)
+    {
+        if (cache.get(key, value))
+            ++hits;
+        else
+            cache.put(key, key);
+    }
+    XrmsBench::doNotOptimize(hits);
+    return timer.elapsedNs() / order.size();
+}
+
+static bool check(bool ok, const std::string& what)
+{
+    std::cout << (ok ? "  通过  " : "  失败  ") << what << std::endl;
+    return ok;
+}
+
+int main(int argc, char* argv[])
+{
+    const int capacity = static_cast<int>(XrmsBench::argOr(argc, argv, 1, 20000));
+    const size_t ops = static_cast<size_t>(XrmsBench::argOr(argc, argv, 2, 200000));
+    const int threads = static_cast<int>(XrmsBench::argOr(argc, argv, 3, 2));
+
+    std::vector<std::vector<int>> orders(threads, std::vector<int>(ops));
+    for (int t = 0; t < threads; ++t)
+    {
+        std::mt19937 rng(41 + t);
+        std::uniform_int_distribution<int> hot(0, capacity - 1), all(0, capacity * 4 - 1);
+        for (size_t i = 0; i < ops; ++i)
+        {
+            orders[t][i] = (rng() % 4 != 0) ? hot(rng) : all(rng);
+        }
+    }
+
+    std::cout << "=== 每次操作耗时(ns): 不挂指标 / 挂指标 ===" << std::endl;
+    {
+        XrmsCache::HashLruCaches<int, int> plain(capacity, 4);
+        XrmsCache::HashLruCaches<int, int> measured(capacity, 4);
+        XrmsCache::CacheMetrics metrics;
+        measured.setMetrics(metrics, "lru");
+        double base = nsPerOp(plain, orders[0]);
+        double with = nsPerOp(measured, orders[0]);
+        std::cout << std::fixed << std::setprecision(1) << "HashLruCaches/4   " << std::setw(8) << base
+                  << std::setw(8) << with << std::endl;
+    }
+
+    std::cout << "=== 回环抓取 ===" << std::endl;
+    XrmsCache::CacheMetrics metrics;
+    XrmsCache::HashLruCaches<int, int> lru(capacity, 4);
+    XrmsCache::HashLfuCache<int, int> lfu(capacity, 4);
+    XrmsCache::ArcCache<int, int> arc(capacity);
+    lru.setMetrics(metrics, "lru");
+    lfu.setMetrics(metrics, "lfu");
+    arc.setMetrics(metrics, "arc");
+    XrmsCache::MetricsExporter exporter(metrics, 0);
+
+    std::atomic<long long> hits{0}, misses{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&, t]() {
+            long long localHits = 0, localMisses = 0;
+            int value = 0;
+            for (int key : orders[t])
+            {
+                if (lru.get(key, value))
+                {
+                    ++localHits;
+                }
+                else
+                {
+                    ++localMisses;
+                    lru.put(key, key);
+                }
+                if (!lfu.get(key, value))
+                    lfu.put(key, key);
+            }
+            hits += localHits;
+            misses += localMisses;
+        });
+    }
+    // ARC的几部分不是线程安全地协调的，只在单线程中访问
+    {
+        int value = 0;
+        for (int key : orders[0])
+        {
+            if (!arc.get(key, value))
+                arc.put(key, key);
+        }
+    }
+    int scrapes = 0;
+    int goodScrapes = 0;
+    while (scrapes < 5 || goodScrapes == 0)
+    {
+        std::string response = httpGet(exporter.port(), "/metrics");
+        ++scrapes;
+        goodScrapes += response.compare(0, 15, "HTTP/1.1 200 OK") == 0;
+        if (scrapes > 50)
+            break;
+    }
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+
+    std::string response = httpGet(exporter.port(), "/metrics");
+    std::string body = response.substr(std::min(response.size(), response.find("\r\n\r\n") + 4));
+    long long gets = static_cast<long long>(ops) * threads;
+    bool ok = true;
+    ok &= check(goodScrapes == scrapes, "访问进行中抓取 " + std::to_string(scrapes) + " 次，均返回200");
+    ok &= check(response.compare(0, 15, "HTTP/1.1 200 OK") == 0
+                && response.find("Content-Type: text/plain; version=0.0.4") != std::string::npos,
+                "GET /metrics 返回200和Prometheus文本格式");
+    ok &= check(sumSamples(body, "xrms_cache_hits_total", "cache=\"lru\"") == hits.load(),
+                "lru各分片hits之和 = " + std::to_string(hits.load()));
+    ok &= check(sumSamples(body, "xrms_cache_misses_total", "cache=\"lru\"") == misses.load(),
+                "lru各分片misses之和 = " + std::to_string(misses.load()));
+    // 每个线程每8次操作计时一次，各线程的计数器从0开始
+    double sampledGets = sumSamples(body, "xrms_cache_get_latency_seconds_count", "cache=\"lru\"");
+    long long expectedSampled = threads * static_cast<long long>((ops + 7) / 8);
+    ok &= check(sampledGets >= expectedSampled / 2 && sampledGets <= expectedSampled * 2,
+                "lru get延迟直方图抽样计数 " + std::to_string(static_cast<long long>(sampledGets)) + " 约为get次数的1/8");
+    ok &= check(sumSamples(body, "xrms_cache_inserts_total", "cache=\"lfu\"") > 0
+                && sumSamples(body, "xrms_cache_evictions_total", "cache=\"lfu\"") > 0,
+                "lfu有插入和淘汰");
+    ok &= check(sumSamples(body, "xrms_cache_entries", "cache=\"lru\"") > 0
+                && sumSamples(body, "xrms_cache_entries", "cache=\"lru\"") <= capacity + 4,
+                "lru条目数在容量以内");
+    ok &= check(sumSamples(body, "xrms_cache_ghost_hits_total", "cache=\"arc\"") >= 0, "arc幽灵命中计数存在");
+    ok &= check(sumSamples(body, "xrms_cache_lock_contended_total", "cache=\"lru\"") >= 0, "锁竞争计数存在");
+    double mrcSmall = sumSamples(body, "xrms_cache_mrc_miss_ratio", "cache=\"lru\",size=\"1024\"");
+    double mrcLarge = sumSamples(body, "xrms_cache_mrc_miss_ratio",
+                                 "cache=\"lru\",size=\"" + std::to_string(size_t(1) << 16) + "\"");
+    ok &= check(mrcSmall >= 0 && mrcLarge >= 0 && mrcLarge <= mrcSmall,
+                "lru未命中率曲线随容量递减: 1024 -> " + std::to_string(mrcSmall) + ", 65536 -> "
+                + std::to_string(mrcLarge));
+    ok &= check(httpGet(exporter.port(), "/other").compare(0, 22, "HTTP/1.1 404 Not Found") == 0, "其他路径返回404");
+
+    std::cout << "实际命中率 " << std::fixed << std::setprecision(3)
+              << static_cast<double>(hits.load()) / gets << std::endl;
+    std::cout << (ok ? "指标导出正常" : "指标导出异常") << std::endl;
+    return ok ? 0 : 1;
+}
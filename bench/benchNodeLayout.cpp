@@ -0,0 +1,73 @@
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BenchUtil.h"
+#include "LruCache.h"
+
+// 冷热分离节点测试：LruNode只保存链表、哈希值和索引槽位，key/value在内存池的另一个数组中
+// 1. 热节点和冷数据的大小
+// 2. value较大时，未命中为主（每次插入都触发淘汰）和命中为主两种负载的吞吐
+//    淘汰只访问热节点，value越大，节点不分离时淘汰扫过的缓存行越多
+// 用法: benchNodeLayout [容量] [操作次数]
+
+template<size_t N>
+struct Blob
+{
+    uint64_t words[N / 8];
+};
+
+template<size_t N>
+static void run(int capacity, const std::vector<int>& missHeavy, const std::vector<int>& hitHeavy)
+{
+    using Cache = XrmsCache::LruCache<int, Blob<N>>;
+    auto measure = [&](const std::vector<int>& order) {
+        Cache cache(capacity);
+        cache.setEvictionBatch(64);
+        Blob<N> value{};
+        long long hits = 0;
+        XrmsBench::Timer timer;
+        for (int key : order)
+        {
+            if (cache.get(key, value))
+            {
+                ++hits;
+            }
+            else
+            {
+                value.words[0] = static_cast<uint64_t>(key);
+                cache.put(key, value);
+            }
+        }
+        XrmsBench::doNotOptimize(hits);
+        return order.size() / timer.elapsedMs() / 1000;
+    };
+    std::cout << std::right << std::setw(8) << N << std::setw(10) << sizeof(XrmsCache::LruNode<int, Blob<N>>)
+              << std::setw(10) << sizeof(XrmsCache::LruPayload<int, Blob<N>>) << std::fixed << std::setprecision(2)
+              << std::setw(14) << measure(missHeavy) << std::setw(14) << measure(hitHeavy) << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    const int capacity = static_cast<int>(XrmsBench::argOr(argc, argv, 1, 200000));
+    const size_t ops = static_cast<size_t>(XrmsBench::argOr(argc, argv, 2, 2000000));
+
+    std::mt19937 rng(13);
+    std::vector<int> missHeavy(ops), hitHeavy(ops);
+    for (size_t i = 0; i < ops; ++i)
+    {
+        missHeavy[i] = static_cast<int>(rng() % static_cast<unsigned>(capacity * 8));
+        hitHeavy[i] = static_cast<int>(rng() % static_cast<unsigned>(capacity / 2));
+    }
+
+    std::cout << "=== LruCache<int, Blob>: 容量 " << capacity << ", " << ops << " 次操作 ===" << std::endl;
+    std::cout << std::right << std::setw(8) << "value" << std::setw(10) << "热节点" << std::setw(10) << "冷数据"
+              << std::setw(18) << "未命中Mops/s" << std::setw(16) << "命中Mops/s" << std::endl;
+    run<8>(capacity, missHeavy, hitHeavy);
+    run<64>(capacity, missHeavy, hitHeavy);
+    run<256>(capacity, missHeavy, hitHeavy);
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ArcCache/ArcCache.h"
+#include "BenchUtil.h"
+#include "FlatLruCache.h"
+#include "LfuCache.h"
+#include "LruCache.h"
+
+// 各策略吞吐与硬件事件：同一串get/put（未命中时put）在每个缓存上运行一遍，
+// 报告每次操作的耗时和周期、指令、L1d/LLC未命中、dTLB未命中、分支预测失败次数
+// 硬件计数依赖perf_event_open，虚拟机或权限受限时相应列为n/a，耗时照常输出
+// 用法: benchPerfCounters [容量] [操作次数]
+
+template<typename Cache>
+static void run(const char* name, Cache& cache, const std::vector<int>& order)
+{
+    XrmsBench::PerfCounters counters;
+    long long hits = 0;
+    int value = 0;
+    counters.start();
+    XrmsBench::Timer timer;
+    for (int key : order)
+    {
+        if (cache.get(key, value))
+            ++hits;
+        else
+            cache.put(key, key);
+    }
+    double ns = timer.elapsedNs() / order.size();
+    counters.stop();
+    XrmsBench::doNotOptimize(hits);
+
+    std::cout << std::left << std::setw(18) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(8) << ns << std::setw(8) << 100.0 * hits / order.size();
+    counters.print(std::cout, order.size());
+    std::cout << std::endl;
+}
+
+static void workload(const char* title, int capacity, const std::vector<int>& order)
+{
+    std::cout << "=== " << title << " ===" << std::endl;
+    std::cout << std::left << std::setw(18) << "缓存" << std::right << std::setw(8) << "ns/op" << std::setw(8) << "hit%";
+    XrmsBench::PerfCounters::printHeader(std::cout);
+    std::cout << std::endl;
+
+    {
+        XrmsCache::LruCache<int, int> cache(capacity);
+        run("LruCache", cache, order);
+    }
+    {
+        XrmsCache::FlatLruCache<int, int> cache(capacity);
+        run("FlatLruCache", cache, order);
+    }
+    {
+        XrmsCache::LfuCache<int, int> cache(capacity);
+        run("LfuCache", cache, order);
+    }
+    {
+        XrmsCache::ArcCache<int, int> cache(capacity);
+        run("ArcCache", cache, order);
+    }
+    {
+        XrmsCache::HashLruCaches<int, int> cache(capacity, 4);
+        run("HashLruCaches/4", cache, order);
+    }
+    {
+        XrmsCache::HashLfuCache<int, int> cache(capacity, 4);
+        run("HashLfuCache/4", cache, order);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const int capacity = static_cast<int>(XrmsBench::argOr(argc, argv, 1, 4096));
+    const size_t ops = static_cast<size_t>(XrmsBench::argOr(argc, argv, 2, 400000));
+
+    if (!XrmsBench::PerfCounters().anyAvailable())
+    {
+        std::cout << "硬件计数器不可用（perf_event_open失败），只输出耗时" << std::endl;
+    }
+
+    std::mt19937 rng(29);
+    std::vector<int> hitHeavy(ops), missHeavy(ops);
+    for (size_t i = 0; i < ops; ++i)
+    {
+        hitHeavy[i] = static_cast<int>(rng() % static_cast<unsigned>(capacity / 2));
+        missHeavy[i] = static_cast<int>(rng() % static_cast<unsigned>(capacity * 8));
+    }
+    workload("命中为主", capacity, hitHeavy);
+    workload("未命中为主", capacity, missHeavy);
+    return 0;
+}
@@ -0,0 +1,94 @@
+// 本测试总是打开分阶段计时，其余目标默认不计时（cmake -DXRMS_CACHE_PHASE_TIMING=ON 可全部打开）
+#ifndef XRMS_CACHE_PHASE_TIMING
+#define XRMS_CACHE_PHASE_TIMING
+#endif
+
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "ArcCache/ArcCache.h"
+#include "BenchUtil.h"
+#include "CachePhase.h"
+#include "LfuCache.h"
+#include "LruCache.h"
+
+// 分阶段周期分布：各缓存跑同一串get/put（未命中时put，key集合是容量的2倍，持续淘汰），
+// 输出查找、调整位置、选淘汰对象、索引删除/插入、节点分配、value拷贝各阶段的次数和周期占比
+// 分片缓存用多个线程同时访问，各线程的计数分别累加，输出时汇总
+// 用法: benchPhaseBreakdown [容量] [每线程操作次数] [线程数]
+
+namespace Timing = XrmsCache::CachePhaseTiming;
+
+template<typename Cache>
+static void runOps(Cache& cache, const std::vector<int>& order)
+{
+    long long hits = 0;
+    int value = 0;
+    for (int key : order)
+    {
+        if (cache.get(key, value))
+            ++hits;
+        else
+            cache.put(key, key);
+    }
+    XrmsBench::doNotOptimize(hits);
+}
+
+template<typename Cache>
+static void report(const char* name, Cache& cache, const std::vector<std::vector<int>>& orders, int threads)
+{
+    Timing::reset();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&cache, &orders, t]() { runOps(cache, orders[t]); });
+    }
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+    std::cout << "=== " << name << ", " << threads << " 线程 ===" << std::endl;
+    Timing::dump(std::cout);
+}
+
+int main(int argc, char* argv[])
+{
+    const int capacity = static_cast<int>(XrmsBench::argOr(argc, argv, 1, 10000));
+    const size_t ops = static_cast<size_t>(XrmsBench::argOr(argc, argv, 2, 200000));
+    const int threads = static_cast<int>(XrmsBench::argOr(argc, argv, 3, 2));
+
+    std::vector<std::vector<int>> orders(threads, std::vector<int>(ops));
+    for (int t = 0; t < threads; ++t)
+    {
+        std::mt19937 rng(31 + t);
+        for (size_t i = 0; i < ops; ++i)
+        {
+            orders[t][i] = static_cast<int>(rng() % static_cast<unsigned>(capacity * 2));
+        }
+    }
+    const std::vector<std::vector<int>> single(orders.begin(), orders.begin() + 1);
+
+    {
+        XrmsCache::LruCache<int, int> cache(capacity);
+        report("LruCache", cache, single, 1);
+    }
+    {
+        XrmsCache::LfuCache<int, int> cache(capacity);
+        report("LfuCache", cache, single, 1);
+    }
+    {
+        XrmsCache::ArcCache<int, int> cache(capacity);
+        report("ArcCache", cache, single, 1);
+    }
+    {
+        XrmsCache::HashLruCaches<int, int> cache(capacity, 4);
+        report("HashLruCaches/4", cache, orders, threads);
+    }
+    {
+        XrmsCache::HashLfuCache<int, int> cache(capacity, 4);
+        report("HashLfuCache/4", cache, orders, threads);
+    }
+    return 0;
+}
@@ -0,0 +1,188 @@
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ArcCache/ArcCache.h"
+#include "BackingStore.h"
+#include "BenchUtil.h"
+#include "LfuCache.h"
+#include "LruCache.h"
+#include "StoreBackedCache.h"
+
+// 读写穿透测试：
+// 1. LRU / LFU / ARC 作为文件存储前的读缓存，对比命中率和存储读取次数
+// 2. 多key读取逐个get与getAll合并读取对比存储调用次数
+// 3. 存储按固定比例写失败时并发读写，检查缓存与存储始终一致
+// 用法: benchReadThrough [key数] [读取次数] [缓存容量]
+
+using Store = XrmsCache::FileBackingStore<int, std::string>;
+
+static std::string valueOf(int key) { return "stored-value-" + std::to_string(key); }
+
+// 热点读：80%落在10%的key上
+static int nextKey(std::mt19937& rng, int keyRange)
+{
+    int hot = std::max(keyRange / 10, 1);
+    return rng() % 100 < 80 ? static_cast<int>(rng() % hot) : static_cast<int>(rng() % keyRange);
+}
+
+template<typename Cache>
+static void readWorkload(const std::string& name, Cache& cache, Store& store, int keyRange, long long reads)
+{
+    XrmsCache::StoreBackedCache<int, std::string> through(cache, store);
+    uint64_t readsBefore = store.readCalls();
+    std::mt19937 rng(7);
+    std::string value;
+    long long wrong = 0;
+    XrmsBench::Timer timer;
+    for (long long i = 0; i < reads; ++i)
+    {
+        int key = nextKey(rng, keyRange);
+        if (!through.get(key, value) || value != valueOf(key))
+            ++wrong;
+    }
+    double ms = timer.elapsedMs();
+    auto s = through.stats();
+    std::cout << std::left << std::setw(12) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << ms << " ms" << std::setw(10) << 100.0 * s.hits / (s.hits + s.misses) << "%"
+              << std::setw(12) << store.readCalls() - readsBefore << std::setw(8) << wrong << std::endl;
+}
+
+// 每failEvery次写入失败一次的存储
+class FlakyStore : public XrmsCache::BackingStore<int, std::string>
+{
+public:
+    FlakyStore(Store& inner, int failEvery) : inner_(inner), failEvery_(failEvery) {}
+
+    bool read(const int& key, std::string& value) override { return inner_.read(key, value); }
+
+    bool write(const int& key, const std::string& value) override
+    {
+        if (++writes_ % failEvery_ == 0)
+            return false;
+        return inner_.write(key, value);
+    }
+
+private:
+    Store&           inner_;
+    int              failEvery_;
+    std::atomic<int> writes_{0};
+};
+
+int main(int argc, char* argv[])
+{
+    const int keyRange = static_cast<int>(XrmsBench::argOr(argc, argv, 1, 100000));
+    const long long reads = XrmsBench::argOr(argc, argv, 2, 300000);
+    const int capacity = static_cast<int>(XrmsBench::argOr(argc, argv, 3, 10000));
+
+    std::string path = "/tmp/xrms-read-through.log";
+    ::unlink(path.c_str());
+    Store store(path);
+    {
+        std::vector<std::pair<int, std::string>> entries;
+        for (int key = 0; key < keyRange; ++key)
+            entries.emplace_back(key, valueOf(key));
+        store.writeBatch(entries);
+    }
+
+    std::cout << "=== 读穿透: " << keyRange << " 个key, " << reads << " 次读取, 缓存容量 " << capacity << " ===" << std::endl;
+    std::cout << std::left << std::setw(12) << "缓存" << std::right << std::setw(13) << "耗时"
+              << std::setw(11) << "命中率" << std::setw(12) << "存储读取" << std::setw(8) << "错误" << std::endl;
+    {
+        XrmsCache::LruCache<int, std::string> lru(capacity);
+        readWorkload("LruCache", lru, store, keyRange, reads);
+        XrmsCache::LfuCache<int, std::string> lfu(capacity);
+        readWorkload("LfuCache", lfu, store, keyRange, reads);
+        XrmsCache::ArcCache<int, std::string> arc(capacity);
+        readWorkload("ArcCache", arc, store, keyRange, reads);
+    }
+
+    std::cout << "=== 多key读取: 每批32个key ===" << std::endl;
+    {
+        const int batchSize = 32;
+        const long long batches = reads / batchSize;
+        std::vector<int> keys(batchSize);
+        std::vector<std::optional<std::string>> values;
+        std::string value;
+
+        XrmsCache::LruCache<int, std::string> single(capacity);
+        XrmsCache::StoreBackedCache<int, std::string> singleThrough(single, store);
+        std::mt19937 rng(11);
+        uint64_t before = store.readCalls();
+        XrmsBench::Timer timer;
+        for (long long b = 0; b < batches; ++b)
+            for (int i = 0; i < batchSize; ++i)
+                singleThrough.get(nextKey(rng, keyRange), value);
+        double singleMs = timer.elapsedMs();
+        uint64_t singleCalls = store.readCalls() - before;
+
+        XrmsCache::LruCache<int, std::string> batched(capacity);
+        XrmsCache::StoreBackedCache<int, std::string> batchedThrough(batched, store);
+        rng.seed(11);
+        before = store.readBatchCalls();
+        long long wrong = 0;
+        timer.reset();
+        for (long long b = 0; b < batches; ++b)
+        {
+            for (int i = 0; i < batchSize; ++i)
+                keys[i] = nextKey(rng, keyRange);
+            batchedThrough.getAll(keys, values);
+            for (int i = 0; i < batchSize; ++i)
+                wrong += !values[i] || *values[i] != valueOf(keys[i]);
+        }
+        double batchedMs = timer.elapsedMs();
+        std::cout << std::fixed << std::setprecision(2)
+                  << "逐个get: " << singleMs << " ms, 存储调用 " << singleCalls << std::endl
+                  << "getAll:  " << batchedMs << " ms, 存储调用 " << store.readBatchCalls() - before
+                  << ", 错误 " << wrong << std::endl;
+    }
+
+    std::cout << "=== 写穿透: 每7次写失败1次, 2个线程并发读写 ===" << std::endl;
+    bool consistent = true;
+    {
+        FlakyStore flaky(store, 7);
+        XrmsCache::LruCache<int, std::string> cache(capacity);
+        XrmsCache::StoreBackedCache<int, std::string> through(cache, flaky);
+        const int writeKeys = capacity * 2;
+        std::vector<std::thread> workers;
+        for (int t = 0; t < 2; ++t)
+        {
+            workers.emplace_back([&, t]() {
+                std::mt19937 rng(100 + t);
+                std::string value;
+                for (long long i = 0; i < reads / 2; ++i)
+                {
+                    int key = static_cast<int>(rng() % writeKeys);
+                    if (rng() % 2)
+                        through.put(key, "written-" + std::to_string(t) + "-" + std::to_string(i));
+                    else
+                        through.get(key, value);
+                }
+            });
+        }
+        for (auto& worker : workers)
+            worker.join();
+
+        // 缓存中的每个值都必须与存储一致
+        long long mismatched = 0;
+        std::string cached, stored;
+        for (int key = 0; key < writeKeys; ++key)
+        {
+            if (cache.get(key, cached) && (!store.read(key, stored) || cached != stored))
+                ++mismatched;
+        }
+        consistent = mismatched == 0;
+        std::cout << "写失败 " << through.stats().writeFailures << " 次, 缓存与存储不一致的key " << mismatched << std::endl;
+    }
+
+    ::unlink(path.c_str());
+    return consistent ? 0 : 1;
+}
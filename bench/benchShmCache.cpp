@@ -0,0 +1,181 @@
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BenchUtil.h"
+#include "LruCache.h"
+#include "ShmLruCache.h"
+
+// 共享内存缓存测试：
+// 1. 单进程下与进程内的HashLruCaches对比吞吐
+// 2. 多个进程同时读写同一个共享内存段
+// 3. 子进程在修改分片中途退出（确定触发）以及反复在写入过程中SIGKILL子进程，检查重新加锁后分片能恢复成一致状态
+// 用法: benchShmCache [进程数] [每进程操作数] [key范围]
+
+using ShmCache = XrmsCache::ShmLruCache<uint64_t, uint64_t>;
+
+static const char* kSegmentName = "/xrms-bench-shm-cache";
+static const uint32_t kSliceNum = 16;
+static const uint32_t kSliceCapacity = 8192;
+
+// 值由key推出，读到不匹配的值说明数据被破坏
+static uint64_t valueOf(uint64_t key) { return key * 0x9e3779b97f4a7c15ull + 1; }
+
+// 读写混合负载（约80%读），返回值不匹配的次数
+template<typename Cache>
+long long runWorkload(Cache& cache, long long ops, uint64_t keyRange, unsigned seed)
+{
+    std::mt19937_64 rng(seed);
+    long long corrupted = 0;
+    for (long long i = 0; i < ops; ++i)
+    {
+        uint64_t key = rng() % keyRange;
+        uint64_t value = 0;
+        if (rng() % 5 == 0)
+        {
+            cache.put(key, valueOf(key));
+        }
+        else if (cache.get(key, value) && value != valueOf(key))
+        {
+            ++corrupted;
+        }
+    }
+    return corrupted;
+}
+
+int main(int argc, char* argv[])
+{
+    const int procs = static_cast<int>(XrmsBench::argOr(argc, argv, 1, 4));
+    const long long ops = XrmsBench::argOr(argc, argv, 2, 1000000);
+    const uint64_t keyRange = static_cast<uint64_t>(XrmsBench::argOr(argc, argv, 3, 200000));
+
+    ShmCache::unlink(kSegmentName);
+    ShmCache cache(kSegmentName, kSliceNum, kSliceCapacity);
+
+    std::cout << "=== 单进程吞吐: " << ops << " 次操作, key范围 " << keyRange << " ===" << std::endl;
+    {
+        XrmsCache::HashLruCaches<uint64_t, uint64_t> local(kSliceNum * kSliceCapacity, kSliceNum);
+        XrmsBench::Timer timer;
+        runWorkload(local, ops, keyRange, 1);
+        double localMs = timer.elapsedMs();
+
+        timer.reset();
+        long long corrupted = runWorkload(cache, ops, keyRange, 1);
+        double shmMs = timer.elapsedMs();
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << "HashLruCaches: " << ops / localMs / 1000 << " Mops/s" << std::endl
+                  << "ShmLruCache:   " << ops / shmMs / 1000 << " Mops/s, 错误值 " << corrupted << std::endl;
+    }
+
+    std::cout << "=== 多进程共享: " << procs << " 个进程 ===" << std::endl;
+    {
+        cache.clear();
+        XrmsBench::Timer timer;
+        std::vector<pid_t> children;
+        for (int p = 0; p < procs; ++p)
+        {
+            pid_t pid = ::fork();
+            if (pid == 0)
+            {
+                // 子进程各自重新映射同一个段
+                ShmCache child(kSegmentName, kSliceNum, kSliceCapacity);
+                long long corrupted = runWorkload(child, ops, keyRange, 100 + p);
+                ::_exit(corrupted == 0 ? 0 : 1);
+            }
+            children.push_back(pid);
+        }
+        int failed = 0;
+        for (pid_t pid : children)
+        {
+            int status = 0;
+            ::waitpid(pid, &status, 0);
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+                ++failed;
+        }
+        double ms = timer.elapsedMs();
+        std::cout << std::fixed << std::setprecision(1)
+                  << "总吞吐: " << procs * ops / ms / 1000 << " Mops/s, 读到错误值的进程 " << failed
+                  << ", 条目数 " << cache.size() << std::endl;
+    }
+
+    std::cout << "=== 崩溃恢复: 修改分片中途退出 ===" << std::endl;
+    {
+        // 子进程持锁写入一半节点后退出，下一次访问该分片必须重建，且半写的key不可见、其余数据完好
+        cache.clear();
+        const uint64_t keys = 1000;
+        for (uint64_t key = 0; key < keys; ++key)
+        {
+            cache.put(key, valueOf(key));
+        }
+        const uint64_t tornKey = keys;
+        uint64_t before = cache.recoveredSlices();
+        pid_t pid = ::fork();
+        if (pid == 0)
+        {
+            ShmCache child(kSegmentName, kSliceNum, kSliceCapacity);
+            child.crashDuringPut(tornKey, valueOf(tornKey));
+        }
+        ::waitpid(pid, nullptr, 0);
+
+        uint64_t value = 0;
+        bool tornVisible = cache.get(tornKey, value);
+        long long lost = 0;
+        for (uint64_t key = 0; key < keys; ++key)
+        {
+            if (!cache.get(key, value) || value != valueOf(key))
+            {
+                ++lost;
+            }
+        }
+        uint64_t recovered = cache.recoveredSlices() - before;
+        bool consistent = cache.verify();
+        std::cout << "重建分片 " << recovered << " 次, 半写的key" << (tornVisible ? "可见" : "已丢弃")
+                  << ", 丢失或错误 " << lost << ", 一致性检查 " << (consistent ? "通过" : "失败") << std::endl;
+        if (recovered == 0 || tornVisible || lost != 0 || !consistent)
+        {
+            ShmCache::unlink(kSegmentName);
+            return 1;
+        }
+    }
+
+    std::cout << "=== 崩溃恢复: 写入中途SIGKILL ===" << std::endl;
+    {
+        const int rounds = 20;
+        std::mt19937 rng(7);
+        for (int r = 0; r < rounds; ++r)
+        {
+            pid_t pid = ::fork();
+            if (pid == 0)
+            {
+                ShmCache child(kSegmentName, kSliceNum, kSliceCapacity);
+                runWorkload(child, 1LL << 40, keyRange, 1000 + r);
+                ::_exit(0);
+            }
+            ::usleep(2000 + rng() % 8000);
+            ::kill(pid, SIGKILL);
+            ::waitpid(pid, nullptr, 0);
+        }
+        // 被杀的子进程可能持有某个分片的锁，后续加锁会收到EOWNERDEAD，若死在修改中途则重建该分片
+        long long corrupted = runWorkload(cache, 200000, keyRange, 9);
+        bool consistent = cache.verify();
+        std::cout << "杀死子进程 " << rounds << " 次, 重建分片 " << cache.recoveredSlices()
+                  << " 次, 错误值 " << corrupted << ", 一致性检查 " << (consistent ? "通过" : "失败")
+                  << ", 条目数 " << cache.size() << std::endl;
+        if (!consistent || corrupted != 0)
+        {
+            ShmCache::unlink(kSegmentName);
+            return 1;
+        }
+    }
+
+    ShmCache::unlink(kSegmentName);
+    return 0;
+}
@@ -0,0 +1,133 @@
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BenchUtil.h"
+#include "LruCache.h"
+#include "StringLruCache.h"
+
+// 字符串条目存储测试：HashLruCaches<std::string, std::string>与StringLruCache对比
+// 1. 两者执行同一串随机put/get/remove，结果必须一致
+// 2. value长度不同（内联 / 池内分配）时，未命中为主和命中为主的吞吐
+// 3. StringLruCache每条目占用的字节数
+// 用法: benchStringArena [总容量] [操作次数] [分片数]
+
+static std::vector<std::string> makeKeys(size_t count)
+{
+    std::vector<std::string> keys;
+    keys.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+        keys.push_back("user:" + std::to_string(i));
+    return keys;
+}
+
+static std::string makeValue(size_t index, size_t length)
+{
+    std::string value = std::to_string(index) + ":";
+    value.resize(std::max(length, value.size()), 'v');
+    return value;
+}
+
+template<typename Cache>
+static double run(Cache& cache, const std::vector<std::string>& keys, const std::vector<std::string>& values,
+                  const std::vector<uint32_t>& order)
+{
+    std::string value;
+    long long hits = 0;
+    XrmsBench::Timer timer;
+    for (uint32_t index : order)
+    {
+        if (cache.get(keys[index], value))
+            ++hits;
+        else
+            cache.put(keys[index], values[index]);
+    }
+    XrmsBench::doNotOptimize(hits);
+    return order.size() / timer.elapsedMs() / 1000;
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t capacity = static_cast<size_t>(XrmsBench::argOr(argc, argv, 1, 100000));
+    const size_t ops = static_cast<size_t>(XrmsBench::argOr(argc, argv, 2, 2000000));
+    const int sliceNum = static_cast<int>(XrmsBench::argOr(argc, argv, 3, 4));
+
+    bool consistent = true;
+    {
+        XrmsCache::HashLruCaches<std::string, std::string> lru(capacity, sliceNum);
+        XrmsCache::StringLruCache<> arena(capacity, sliceNum);
+        std::vector<std::string> keys = makeKeys(capacity * 2);
+        std::mt19937 rng(3);
+        for (size_t i = 0; i < ops / 4; ++i)
+        {
+            size_t index = rng() % keys.size();
+            int op = static_cast<int>(rng() % 10);
+            if (op == 0)
+            {
+                lru.remove(keys[index]);
+                arena.remove(keys[index]);
+            }
+            else if (op < 6)
+            {
+                std::string a, b;
+                consistent &= lru.get(keys[index], a) == arena.get(keys[index], b) && a == b;
+            }
+            else
+            {
+                // 长度在内联、池内和大块之间变化，覆盖更新时换存储位置的情况
+                std::string value = makeValue(i, rng() % 3 == 0 ? rng() % 6000 : rng() % 64);
+                lru.put(keys[index], value);
+                arena.put(keys[index], value);
+            }
+        }
+    }
+    std::cout << "=== 与HashLruCaches逐次比较: " << (consistent ? "一致" : "不一致") << " ===" << std::endl;
+
+    std::cout << "=== 总容量 " << capacity << ", " << sliceNum << " 个分片, " << ops << " 次操作 ===" << std::endl;
+    std::cout << std::right << std::setw(10) << "value长度" << std::setw(20) << "未命中 LruCache"
+              << std::setw(16) << "StringLru" << std::setw(18) << "命中 LruCache" << std::setw(16) << "StringLru"
+              << std::setw(16) << "字节/条目" << std::endl;
+    for (size_t length : {24, 200, 1000})
+    {
+        std::vector<std::string> keys = makeKeys(capacity * 8);
+        std::vector<std::string> values;
+        values.reserve(keys.size());
+        for (size_t i = 0; i < keys.size(); ++i)
+            values.push_back(makeValue(i, length));
+
+        std::mt19937 rng(5);
+        std::vector<uint32_t> missHeavy(ops), hitHeavy(ops);
+        for (size_t i = 0; i < ops; ++i)
+        {
+            missHeavy[i] = static_cast<uint32_t>(rng() % keys.size());
+            hitHeavy[i] = static_cast<uint32_t>(rng() % (capacity / 2));
+        }
+
+        double results[4];
+        size_t bytesPerEntry = 0;
+        {
+            XrmsCache::HashLruCaches<std::string, std::string> lru(capacity, sliceNum);
+            results[0] = run(lru, keys, values, missHeavy);
+        }
+        {
+            XrmsCache::StringLruCache<> arena(capacity, sliceNum);
+            results[1] = run(arena, keys, values, missHeavy);
+            bytesPerEntry = arena.memoryBytes() / std::max<size_t>(arena.size(), 1);
+        }
+        {
+            XrmsCache::HashLruCaches<std::string, std::string> lru(capacity, sliceNum);
+            results[2] = run(lru, keys, values, hitHeavy);
+        }
+        {
+            XrmsCache::StringLruCache<> arena(capacity, sliceNum);
+            results[3] = run(arena, keys, values, hitHeavy);
+        }
+        std::cout << std::right << std::setw(10) << length << std::fixed << std::setprecision(2)
+                  << std::setw(16) << results[0] << std::setw(16) << results[1]
+                  << std::setw(16) << results[2] << std::setw(16) << results[3]
+                  << std::setw(14) << bytesPerEntry << std::endl;
+    }
+    return consistent ? 0 : 1;
+}
@@ -0,0 +1,68 @@
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BenchUtil.h"
+#include "LruCache.h"
+
+// 长字符串key测试：key长度不同时，分片LRU在未命中为主（每次未命中都要插入并淘汰）
+// 和命中为主两种负载下的吞吐。key的哈希值在选分片时只算一次，淘汰按槽位删除不再重新计算
+// 用法: benchStringKeys [总容量] [操作次数] [分片数]
+
+static std::vector<std::string> makeKeys(size_t count, size_t length)
+{
+    std::vector<std::string> keys;
+    keys.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        std::string key = "user:session:" + std::to_string(i) + ":";
+        key.resize(std::max(length, key.size()), 'x');
+        keys.push_back(std::move(key));
+    }
+    return keys;
+}
+
+// 每次先get，未命中则put；keyRange相对容量的大小决定命中率
+static void run(const char* name, const std::vector<std::string>& keys, size_t capacity, int sliceNum, long long ops)
+{
+    XrmsCache::HashLruCaches<std::string, int> cache(capacity, sliceNum);
+    std::mt19937 rng(5);
+    std::vector<uint32_t> order(static_cast<size_t>(ops));
+    for (auto& index : order)
+        index = static_cast<uint32_t>(rng() % keys.size());
+
+    long long hits = 0;
+    int value;
+    XrmsBench::Timer timer;
+    for (uint32_t index : order)
+    {
+        if (cache.get(keys[index], value))
+            ++hits;
+        else
+            cache.put(keys[index], static_cast<int>(index));
+    }
+    double ms = timer.elapsedMs();
+    std::cout << std::left << std::setw(12) << name << std::right << std::setw(8) << keys[0].size()
+              << std::fixed << std::setprecision(2) << std::setw(12) << ops / ms / 1000
+              << std::setw(11) << 100.0 * hits / ops << "%" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t capacity = static_cast<size_t>(XrmsBench::argOr(argc, argv, 1, 100000));
+    const long long ops = XrmsBench::argOr(argc, argv, 2, 2000000);
+    const int sliceNum = static_cast<int>(XrmsBench::argOr(argc, argv, 3, 4));
+
+    std::cout << "=== 分片LRU<string,int>: 总容量 " << capacity << ", " << sliceNum << " 个分片, "
+              << ops << " 次操作 ===" << std::endl;
+    std::cout << std::left << std::setw(12) << "负载" << std::right << std::setw(10) << "key长度"
+              << std::setw(12) << "Mops/s" << std::setw(12) << "命中率" << std::endl;
+    for (size_t length : {16, 64, 256})
+    {
+        run("未命中为主", makeKeys(capacity * 8, length), capacity, sliceNum, ops);
+        run("命中为主", makeKeys(capacity / 2, length), capacity, sliceNum, ops);
+    }
+    return 0;
+}
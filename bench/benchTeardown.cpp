@@ -0,0 +1,95 @@
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "BenchUtil.h"
+#include "CacheMemory.h"
+#include "LfuCache.h"
+#include "LruCache.h"
+
+// 析构性能测试：填满缓存后分别测量同步析构、后台析构（调用方返回耗时）和clear()
+// 用法: benchTeardown [条目数]
+
+template<typename Cache, typename MakeValue>
+std::unique_ptr<Cache> buildCache(size_t n, MakeValue makeValue)
+{
+    std::vector<std::pair<int, decltype(makeValue(0))>> input;
+    input.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        input.emplace_back(static_cast<int>(i), makeValue(i));
+    }
+    auto cache = std::make_unique<Cache>(n);
+    cache->bulkLoad(input);
+    return cache;
+}
+
+template<typename Cache, typename MakeValue>
+void runCase(const std::string& name, size_t n, MakeValue makeValue)
+{
+    auto syncCache = buildCache<Cache>(n, makeValue);
+    XrmsBench::Timer timer;
+    syncCache.reset();
+    double syncMs = timer.elapsedMs();
+
+    auto asyncCache = buildCache<Cache>(n, makeValue);
+    asyncCache->setBackgroundRelease(true);
+    timer.reset();
+    asyncCache.reset();
+    double asyncMs = timer.elapsedMs();
+    // 等后台线程释放完再进入下一组，避免互相干扰
+    XrmsCache::waitBackgroundRelease();
+
+    std::cout << std::left << std::setw(28) << name
+              << std::right << std::fixed << std::setprecision(2)
+              << std::setw(12) << syncMs << " ms"
+              << std::setw(12) << asyncMs << " ms" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t N = XrmsBench::argOr(argc, argv, 1, 2000000);
+    auto intValue = [](size_t i) { return static_cast<int>(i); };
+    auto stringValue = [](size_t i) { return "value-with-heap-storage-" + std::to_string(i); };
+
+    std::cout << "=== 析构测试: " << N << " 条 ===" << std::endl;
+    std::cout << std::left << std::setw(28) << "缓存"
+              << std::right << std::setw(15) << "同步析构" << std::setw(15) << "后台析构" << std::endl;
+    runCase<XrmsCache::LruCache<int, int>>("LruCache<int, int>", N, intValue);
+    runCase<XrmsCache::LruCache<int, std::string>>("LruCache<int, string>", N, stringValue);
+    runCase<XrmsCache::LfuCache<int, int>>("LfuCache<int, int>", N, intValue);
+    runCase<XrmsCache::LfuCache<int, std::string>>("LfuCache<int, string>", N, stringValue);
+
+    // clear()后缓存仍可继续使用
+    auto cache = buildCache<XrmsCache::LruCache<int, std::string>>(N, stringValue);
+    XrmsBench::Timer timer;
+    cache->clear();
+    double clearMs = timer.elapsedMs();
+    cache->put(1, "again");
+    std::cout << "LruCache<int, string>::clear(): " << clearMs << " ms, 清空后get(1) = "
+              << cache->get(1) << std::endl;
+
+    // 传入resource的缓存必须显式确认才会开启后台释放
+    XrmsCache::CacheMemory::CountingResource counting;
+    {
+        XrmsCache::LfuCache<int, std::string> custom(1000, 10, &counting);
+        bool refused = !custom.setBackgroundRelease(true);
+        bool accepted = custom.setBackgroundRelease(true, true);
+        for (int i = 0; i < 1000; ++i)
+        {
+            custom.put(i, stringValue(static_cast<size_t>(i)));
+        }
+        std::cout << "自定义resource: 未确认时" << (refused ? "拒绝" : "开启")
+                  << ", 确认后" << (accepted ? "开启" : "拒绝") << std::endl;
+        if (!refused || !accepted)
+        {
+            return 1;
+        }
+    }
+    XrmsCache::waitBackgroundRelease();
+    std::cout << "后台释放完成后resource剩余: " << counting.bytes() << " 字节" << std::endl;
+    return counting.bytes() == 0 ? 0 : 1;
+}
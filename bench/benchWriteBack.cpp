@@ -0,0 +1,137 @@
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "BackingStore.h"
+#include "BenchUtil.h"
+#include "LruCache.h"
+
+// 写回模式测试：同一组带热点的写入分别直接写文件存储和经过写回缓存，对比写调用次数与耗时，
+// 最后重新打开存储文件校验每个key的最终值
+// 用法: benchWriteBack [写入次数] [key范围] [缓存容量]
+
+using Store = XrmsCache::FileBackingStore<int, std::string>;
+
+// 80%的写落在5%的key上
+static std::vector<int> makeWrites(long long count, int keyRange)
+{
+    std::mt19937 rng(2024);
+    int hotKeys = std::max(keyRange / 20, 1);
+    std::vector<int> keys(count);
+    for (auto& key : keys)
+    {
+        key = rng() % 100 < 80 ? static_cast<int>(rng() % hotKeys) : static_cast<int>(rng() % keyRange);
+    }
+    return keys;
+}
+
+static std::string valueOf(int key, long long version)
+{
+    return "value-" + std::to_string(key) + "-" + std::to_string(version);
+}
+
+static void printRow(const std::string& name, double ms, const Store& store)
+{
+    std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << ms << " ms" << std::setw(12) << store.writeCalls()
+              << std::setw(12) << store.recordsWritten() << std::endl;
+}
+
+// 重新打开存储文件，检查每个key的值都是最后一次写入的值
+static bool verify(const std::string& path, const std::unordered_map<int, std::string>& expected)
+{
+    Store reopened(path);
+    if (reopened.size() != expected.size())
+    {
+        return false;
+    }
+    std::string value;
+    for (const auto& kv : expected)
+    {
+        if (!reopened.read(kv.first, value) || value != kv.second)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    const long long writes = XrmsBench::argOr(argc, argv, 1, 500000);
+    const int keyRange = static_cast<int>(XrmsBench::argOr(argc, argv, 2, 100000));
+    const size_t capacity = static_cast<size_t>(XrmsBench::argOr(argc, argv, 3, 20000));
+
+    std::vector<int> keys = makeWrites(writes, keyRange);
+    std::unordered_map<int, std::string> expected;
+    for (long long i = 0; i < writes; ++i)
+    {
+        expected[keys[i]] = valueOf(keys[i], i);
+    }
+
+    std::cout << "=== " << writes << " 次写入, key范围 " << keyRange << ", 缓存容量 " << capacity << " ===" << std::endl;
+    std::cout << std::left << std::setw(24) << "方式" << std::right << std::setw(13) << "耗时"
+              << std::setw(12) << "write调用" << std::setw(12) << "写入记录" << std::endl;
+
+    std::string directPath = "/tmp/xrms-writeback-direct.log";
+    std::string cachedPath = "/tmp/xrms-writeback-cached.log";
+    ::unlink(directPath.c_str());
+    ::unlink(cachedPath.c_str());
+
+    bool directOk;
+    {
+        Store store(directPath);
+        XrmsBench::Timer timer;
+        for (long long i = 0; i < writes; ++i)
+        {
+            store.write(keys[i], valueOf(keys[i], i));
+        }
+        printRow("直接写存储", timer.elapsedMs(), store);
+    }
+    directOk = verify(directPath, expected);
+
+    bool cachedOk;
+    {
+        Store store(cachedPath);
+        XrmsCache::HashLruCaches<int, std::string> cache(capacity, 4);
+        cache.setWriteBack(&store, 256, std::chrono::milliseconds(100));
+        XrmsBench::Timer timer;
+        for (long long i = 0; i < writes; ++i)
+        {
+            cache.put(keys[i], valueOf(keys[i], i));
+        }
+        double putMs = timer.elapsedMs();
+        printRow("写回缓存(不含最终flush)", putMs, store);
+
+        // 写回期间读到的必须是最新值，无论数据在缓存、待写队列还是存储中
+        std::string value;
+        long long stale = 0;
+        for (const auto& kv : expected)
+        {
+            if ((cache.get(kv.first, value) || store.read(kv.first, value)) && value != kv.second)
+                ++stale;
+        }
+        timer.reset();
+        cache.flush();
+        printRow("写回缓存(flush后)", putMs + timer.elapsedMs(), store);
+        if (stale != 0)
+        {
+            std::cout << "读到旧值: " << stale << std::endl;
+        }
+    }
+    cachedOk = verify(cachedPath, expected);
+
+    std::cout << "重新打开校验: 直接写 " << (directOk ? "通过" : "失败")
+              << ", 写回缓存 " << (cachedOk ? "通过" : "失败") << std::endl;
+
+    ::unlink(directPath.c_str());
+    ::unlink(cachedPath.c_str());
+    return directOk && cachedOk ? 0 : 1;
+}
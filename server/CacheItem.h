@@ -0,0 +1,164 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "CacheBatch.h"
+
+namespace XrmsServer
+{
+
+// 服务端缓存的值：数据本身加上协议需要的元信息
+// 条目写入后不再修改，更新时整体替换，因此读取方可以不加锁地持有并直接写出其数据
+struct CacheItem
+{
+    std::string data;
+    uint32_t    flags = 0;      // memcached客户端标志
+    int64_t     expireAt = 0;   // 过期时间（unix秒），0表示永不过期
+
+    bool expired(int64_t now) const { return expireAt != 0 && expireAt <= now; }
+};
+
+using ItemPtr = std::shared_ptr<const CacheItem>;
+
+using BatchOp = XrmsCache::CacheBatchOp<std::string, ItemPtr>;
+
+inline int64_t nowSeconds()
+{
+    return static_cast<int64_t>(::time(nullptr));
+}
+
+// 检测缓存是否提供remove / applyBatch / clear / purge，不同分片缓存提供的接口不完全相同
+template<typename C, typename = void>
+struct HasRemove : std::false_type {};
+template<typename C>
+struct HasRemove<C, std::void_t<decltype(std::declval<C&>().remove(std::declval<std::string>()))>>
+    : std::true_type {};
+
+template<typename C, typename = void>
+struct HasApplyBatch : std::false_type {};
+template<typename C>
+struct HasApplyBatch<C, std::void_t<decltype(std::declval<C&>().applyBatch(std::declval<std::vector<BatchOp>&>()))>>
+    : std::true_type {};
+
+template<typename C, typename = void>
+struct HasClear : std::false_type {};
+template<typename C>
+struct HasClear<C, std::void_t<decltype(std::declval<C&>().clear())>> : std::true_type {};
+
+template<typename C, typename = void>
+struct HasPurge : std::false_type {};
+template<typename C>
+struct HasPurge<C, std::void_t<decltype(std::declval<C&>().purge())>> : std::true_type {};
+
+/*
+ * CacheAdapter 把任意分片缓存（HashLruCaches、HashLfuCache等）包装成服务端需要的操作
+ * 过期采用惰性检查：读到过期条目时按未命中处理并顺手删除
+ * 不支持remove的缓存用空指针作为墓碑表示删除
+ */
+template<typename Cache>
+class CacheAdapter
+{
+public:
+    explicit CacheAdapter(Cache& cache) : cache_(cache) {}
+
+    Cache& cache() { return cache_; }
+
+    // 命中且未过期时返回true
+    bool get(const std::string& key, ItemPtr& item, int64_t now)
+    {
+        if (!cache_.get(key, item) || !item)
+        {
+            item.reset();
+            return false;
+        }
+        if (item->expired(now))
+        {
+            remove(key);
+            item.reset();
+            return false;
+        }
+        return true;
+    }
+
+    void put(const std::string& key, ItemPtr item)
+    {
+        cache_.put(key, std::move(item));
+    }
+
+    void remove(const std::string& key)
+    {
+        if constexpr (HasRemove<Cache>::value)
+        {
+            cache_.remove(key);
+        }
+        else
+        {
+            cache_.put(key, ItemPtr());
+        }
+    }
+
+    // 批量执行一组操作：缓存支持时按分片分组、每个分片只加一次锁，否则逐条执行
+    // 过期判断由调用方根据返回的条目自行处理
+    void applyBatch(std::vector<BatchOp>& ops)
+    {
+        if constexpr (HasApplyBatch<Cache>::value)
+        {
+            cache_.applyBatch(ops);
+        }
+        else
+        {
+            for (BatchOp& op : ops)
+            {
+                switch (op.type)
+                {
+                case BatchOp::Type::Get:
+                    op.found = cache_.get(op.key, op.value);
+                    break;
+                case BatchOp::Type::Put:
+                    cache_.put(op.key, op.value);
+                    break;
+                case BatchOp::Type::Remove:
+                    op.found = cache_.get(op.key, op.value);
+                    if (op.found)
+                        remove(op.key);
+                    break;
+                case BatchOp::Type::Update:
+                    op.found = cache_.get(op.key, op.value) && op.update(op.value, op.updateArg);
+                    if (op.found)
+                        cache_.put(op.key, op.value);
+                    break;
+                }
+            }
+        }
+    }
+
+    // 清空缓存，缓存不支持时返回false
+    bool clear()
+    {
+        if constexpr (HasClear<Cache>::value)
+        {
+            cache_.clear();
+            return true;
+        }
+        else if constexpr (HasPurge<Cache>::value)
+        {
+            cache_.purge();
+            return true;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+private:
+    Cache& cache_;
+};
+
+} // namespace XrmsServer
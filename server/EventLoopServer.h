@@ -0,0 +1,360 @@
+#pragma once
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "OutputBuffer.h"
+
+namespace XrmsServer
+{
+
+/*
+ * EventLoopServer 多线程epoll服务端骨架
+ * 每个线程一个事件循环，并各自持有一个开启SO_REUSEPORT的监听socket，
+ * 由内核在线程间分发新连接，线程之间不共享任何连接状态。
+ *
+ * Handler需提供：
+ *   size_t process(const char* data, size_t length, OutputBuffer& out, bool& closeAfterWrite);
+ * 一次尽可能多地解析并执行缓冲区中完整的请求（流水线），回复写入out，
+ * 返回已消费的字节数，不完整的请求留在缓冲区中等待后续数据。
+ * Handler会被多个事件循环线程并发调用，自身须是线程安全的。
+ */
+template<typename Handler>
+class EventLoopServer
+{
+public:
+    EventLoopServer(Handler& handler, uint16_t port, int threadNum, size_t maxRequestBytes = 2 << 20)
+        : handler_(handler)
+        , port_(port)
+        , threadNum_(threadNum > 0 ? threadNum : static_cast<int>(std::thread::hardware_concurrency()))
+        , maxRequestBytes_(maxRequestBytes)
+    {
+        // 在构造时创建全部监听socket，端口被占用等错误可以直接抛给调用方
+        for (int i = 0; i < threadNum_; ++i)
+        {
+            loops_.emplace_back(new Loop(*this, createListener()));
+        }
+    }
+
+    ~EventLoopServer()
+    {
+        stop();
+        join();
+    }
+
+    EventLoopServer(const EventLoopServer&) = delete;
+    EventLoopServer& operator=(const EventLoopServer&) = delete;
+
+    // 启动全部事件循环线程后立即返回
+    void start()
+    {
+        for (auto& loop : loops_)
+        {
+            threads_.emplace_back([&loop]() { loop->run(); });
+        }
+    }
+
+    // 通知所有事件循环退出，可在信号处理函数中调用（只有write系统调用）
+    void stop()
+    {
+        for (auto& loop : loops_)
+        {
+            loop->wakeup();
+        }
+    }
+
+    void join()
+    {
+        for (auto& thread : threads_)
+        {
+            if (thread.joinable())
+            {
+                thread.join();
+            }
+        }
+        threads_.clear();
+    }
+
+    int threadNum() const { return threadNum_; }
+
+private:
+    // 单个连接：输入缓冲区保存尚未处理完的请求，输出缓冲区保存尚未写出的回复
+    struct Connection
+    {
+        int fd;
+        std::string input;
+        OutputBuffer output;
+        bool closeAfterWrite = false;
+        bool writing = false;   // 是否在等待可写事件
+    };
+
+    class Loop
+    {
+    public:
+        Loop(EventLoopServer& server, int listenFd)
+            : server_(server)
+            , listenFd_(listenFd)
+            , epollFd_(::epoll_create1(EPOLL_CLOEXEC))
+            , wakeFd_(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+        {
+            if (epollFd_ < 0 || wakeFd_ < 0)
+            {
+                throw std::runtime_error(std::string("epoll/eventfd: ") + std::strerror(errno));
+            }
+            addFd(listenFd_, EPOLLIN, &listenFd_);
+            addFd(wakeFd_, EPOLLIN, &wakeFd_);
+        }
+
+        ~Loop()
+        {
+            for (auto& pair : connections_)
+            {
+                ::close(pair.first);
+            }
+            ::close(listenFd_);
+            ::close(epollFd_);
+            ::close(wakeFd_);
+        }
+
+        void wakeup()
+        {
+            uint64_t one = 1;
+            ssize_t ignored = ::write(wakeFd_, &one, sizeof(one));
+            (void)ignored;
+        }
+
+        void run()
+        {
+            epoll_event events[256];
+            while (!stopped_)
+            {
+                int n = ::epoll_wait(epollFd_, events, 256, -1);
+                if (n < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    break;
+                }
+                for (int i = 0; i < n; ++i)
+                {
+                    void* ptr = events[i].data.ptr;
+                    if (ptr == &listenFd_)
+                    {
+                        acceptAll();
+                    }
+                    else if (ptr == &wakeFd_)
+                    {
+                        stopped_ = true;
+                    }
+                    else
+                    {
+                        handleEvent(static_cast<Connection*>(ptr), events[i].events);
+                    }
+                }
+            }
+        }
+
+    private:
+        void addFd(int fd, uint32_t events, void* ptr)
+        {
+            epoll_event ev{};
+            ev.events = events;
+            ev.data.ptr = ptr;
+            ::epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev);
+        }
+
+        void modifyFd(Connection* conn, uint32_t events)
+        {
+            epoll_event ev{};
+            ev.events = events;
+            ev.data.ptr = conn;
+            ::epoll_ctl(epollFd_, EPOLL_CTL_MOD, conn->fd, &ev);
+        }
+
+        void acceptAll()
+        {
+            while (true)
+            {
+                int fd = ::accept4(listenFd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                if (fd < 0)
+                {
+                    return;  // EAGAIN：本轮新连接已全部接受
+                }
+                int one = 1;
+                ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                auto conn = std::make_unique<Connection>();
+                conn->fd = fd;
+                addFd(fd, EPOLLIN | EPOLLRDHUP, conn.get());
+                connections_.emplace(fd, std::move(conn));
+            }
+        }
+
+        void handleEvent(Connection* conn, uint32_t events)
+        {
+            if (events & (EPOLLERR | EPOLLHUP))
+            {
+                closeConnection(conn);
+                return;
+            }
+            if (events & EPOLLOUT)
+            {
+                if (!conn->output.flush(conn->fd))
+                {
+                    closeConnection(conn);
+                    return;
+                }
+            }
+            if ((events & (EPOLLIN | EPOLLRDHUP)) && !conn->writing)
+            {
+                if (!readAndProcess(conn))
+                {
+                    closeConnection(conn);
+                    return;
+                }
+            }
+            updateInterest(conn);
+        }
+
+        // 读出socket中全部可读数据，处理其中完整的请求，回复攒在一起后一次性写出
+        bool readAndProcess(Connection* conn)
+        {
+            char buffer[64 * 1024];
+            bool peerClosed = false;
+            while (true)
+            {
+                ssize_t n = ::read(conn->fd, buffer, sizeof(buffer));
+                if (n > 0)
+                {
+                    conn->input.append(buffer, static_cast<size_t>(n));
+                    if (static_cast<size_t>(n) < sizeof(buffer))
+                    {
+                        break;
+                    }
+                }
+                else if (n == 0)
+                {
+                    peerClosed = true;
+                    break;
+                }
+                else if (errno == EINTR)
+                {
+                    continue;
+                }
+                else if (errno == EAGAIN || errno == EWOULDBLOCK)
+                {
+                    break;
+                }
+                else
+                {
+                    return false;
+                }
+            }
+
+            if (!conn->input.empty())
+            {
+                size_t consumed = server_.handler_.process(conn->input.data(), conn->input.size(),
+                                                           conn->output, conn->closeAfterWrite);
+                conn->input.erase(0, consumed);
+                if (conn->input.size() > server_.maxRequestBytes_)
+                {
+                    return false;  // 单个请求过大，直接断开
+                }
+            }
+            if (!conn->output.flush(conn->fd))
+            {
+                return false;
+            }
+            return !peerClosed && !(conn->closeAfterWrite && conn->output.empty());
+        }
+
+        // 输出未写完时只关注可写事件（同时起到背压作用），写完后恢复读
+        void updateInterest(Connection* conn)
+        {
+            if (connections_.find(conn->fd) == connections_.end())
+            {
+                return;
+            }
+            bool wantWrite = !conn->output.empty();
+            if (wantWrite != conn->writing)
+            {
+                conn->writing = wantWrite;
+                modifyFd(conn, wantWrite ? EPOLLOUT : (EPOLLIN | EPOLLRDHUP));
+            }
+            if (!wantWrite && conn->closeAfterWrite)
+            {
+                closeConnection(conn);
+            }
+        }
+
+        void closeConnection(Connection* conn)
+        {
+            int fd = conn->fd;
+            ::epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr);
+            ::close(fd);
+            connections_.erase(fd);
+        }
+
+    private:
+        EventLoopServer& server_;
+        int listenFd_;
+        int epollFd_;
+        int wakeFd_;
+        bool stopped_ = false;
+        std::unordered_map<int, std::unique_ptr<Connection>> connections_;
+    };
+
+    // 创建开启SO_REUSEPORT的非阻塞监听socket，所有线程绑定同一端口
+    int createListener()
+    {
+        int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+        {
+            throw std::runtime_error(std::string("socket: ") + std::strerror(errno));
+        }
+        int one = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(port_);
+        if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0
+            || ::listen(fd, 1024) < 0)
+        {
+            int err = errno;
+            ::close(fd);
+            throw std::runtime_error("bind/listen port " + std::to_string(port_) + ": " + std::strerror(err));
+        }
+        return fd;
+    }
+
+private:
+    Handler&    handler_;           // 协议处理器，所有线程共享
+    uint16_t    port_;              // 监听端口
+    int         threadNum_;         // 事件循环线程数
+    size_t      maxRequestBytes_;   // 单个连接允许缓存的未处理请求上限
+    std::vector<std::unique_ptr<Loop>> loops_;
+    std::vector<std::thread> threads_;
+};
+
+} // namespace XrmsServer
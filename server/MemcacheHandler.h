@@ -0,0 +1,691 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "CacheItem.h"
+#include "OutputBuffer.h"
+
+namespace XrmsServer
+{
+
+/*
+ * MemcacheHandler memcached ASCII协议与meta协议的请求处理器
+ * 支持的文本命令：get gets set add replace append prepend delete touch incr decr
+ *               flush_all version verbosity quit
+ * 支持的meta命令：mg ms md mn
+ * 一次调用处理缓冲区中全部完整的请求（流水线），不完整的请求留待下次
+ * add/replace/append等先读后写的命令不是原子的，并发修改同一个key时以最后一次写入为准
+ */
+template<typename Cache>
+class MemcacheHandler
+{
+public:
+    explicit MemcacheHandler(Cache& cache, size_t maxValueBytes = 1 << 20)
+        : adapter_(cache)
+        , maxValueBytes_(maxValueBytes)
+    {}
+
+    size_t process(const char* data, size_t length, OutputBuffer& out, bool& closeAfterWrite)
+    {
+        size_t pos = 0;
+        int64_t now = nowSeconds();
+        while (pos < length && !closeAfterWrite)
+        {
+            const char* start = data + pos;
+            const char* newline = static_cast<const char*>(std::memchr(start, '\n', length - pos));
+            if (!newline)
+            {
+                if (length - pos > MAX_LINE_LENGTH)
+                {
+                    out.append("CLIENT_ERROR line too long\r\n");
+                    closeAfterWrite = true;
+                    return length;
+                }
+                break;
+            }
+
+            std::string_view line(start, static_cast<size_t>(newline - start));
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.remove_suffix(1);
+            }
+            Request request{tokenize(line), data, length, pos + (newline - start) + 1, now};
+            if (!dispatch(request, out, closeAfterWrite))
+            {
+                break;  // 存储命令的数据块还没收全
+            }
+            pos = request.next;
+        }
+        return pos;
+    }
+
+private:
+    static constexpr size_t MAX_KEY_LENGTH = 250;
+    static constexpr size_t MAX_LINE_LENGTH = 2048;
+    static constexpr size_t MAX_TOKENS = 24;
+    static constexpr int64_t MAX_RELATIVE_EXPTIME = 60 * 60 * 24 * 30;  // 超过30天视为绝对时间
+
+    struct Tokens
+    {
+        std::string_view items[MAX_TOKENS];
+        size_t count = 0;
+
+        std::string_view operator[](size_t i) const { return i < count ? items[i] : std::string_view(); }
+    };
+
+    // 一条请求的上下文：命令行切分结果，以及命令行之后的数据位置
+    struct Request
+    {
+        Tokens tokens;
+        const char* data;
+        size_t length;
+        size_t next;    // 命令行（及数据块）之后的位置，处理完成后即为已消费的字节数
+        int64_t now;
+    };
+
+    enum class StoreMode { Set, Add, Replace, Append, Prepend };
+
+    static Tokens tokenize(std::string_view line)
+    {
+        Tokens tokens;
+        size_t i = 0;
+        while (i < line.size() && tokens.count < MAX_TOKENS)
+        {
+            while (i < line.size() && line[i] == ' ')
+            {
+                ++i;
+            }
+            size_t begin = i;
+            while (i < line.size() && line[i] != ' ')
+            {
+                ++i;
+            }
+            if (i > begin)
+            {
+                tokens.items[tokens.count++] = line.substr(begin, i - begin);
+            }
+        }
+        return tokens;
+    }
+
+    template<typename T>
+    static bool parseNumber(std::string_view text, T& value)
+    {
+        if (text.empty())
+        {
+            return false;
+        }
+        auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size();
+    }
+
+    template<typename T>
+    static void appendNumber(OutputBuffer& out, T value)
+    {
+        char buffer[24];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(std::string_view(buffer, static_cast<size_t>(result.ptr - buffer)));
+    }
+
+    static int64_t toExpireAt(int64_t exptime, int64_t now)
+    {
+        if (exptime == 0)
+        {
+            return 0;
+        }
+        if (exptime < 0)
+        {
+            return now - 1;  // 负数表示立即过期
+        }
+        return exptime > MAX_RELATIVE_EXPTIME ? exptime : now + exptime;
+    }
+
+    static bool validKey(std::string_view key)
+    {
+        return !key.empty() && key.size() <= MAX_KEY_LENGTH;
+    }
+
+    static ItemPtr makeItem(std::string data, uint32_t flags, int64_t expireAt)
+    {
+        auto item = std::make_shared<CacheItem>();
+        item->data = std::move(data);
+        item->flags = flags;
+        item->expireAt = expireAt;
+        return item;
+    }
+
+    // 返回false表示需要更多数据
+    bool dispatch(Request& request, OutputBuffer& out, bool& closeAfterWrite)
+    {
+        std::string_view cmd = request.tokens[0];
+        if (cmd == "get" || cmd == "gets")
+        {
+            handleGet(request, out, cmd == "gets");
+        }
+        else if (cmd == "mg")
+        {
+            handleMetaGet(request, out);
+        }
+        else if (cmd == "set")
+        {
+            return handleStore(request, out, StoreMode::Set, closeAfterWrite);
+        }
+        else if (cmd == "ms")
+        {
+            return handleMetaSet(request, out, closeAfterWrite);
+        }
+        else if (cmd == "add")
+        {
+            return handleStore(request, out, StoreMode::Add, closeAfterWrite);
+        }
+        else if (cmd == "replace")
+        {
+            return handleStore(request, out, StoreMode::Replace, closeAfterWrite);
+        }
+        else if (cmd == "append")
+        {
+            return handleStore(request, out, StoreMode::Append, closeAfterWrite);
+        }
+        else if (cmd == "prepend")
+        {
+            return handleStore(request, out, StoreMode::Prepend, closeAfterWrite);
+        }
+        else if (cmd == "delete")
+        {
+            handleDelete(request, out);
+        }
+        else if (cmd == "md")
+        {
+            handleMetaDelete(request, out);
+        }
+        else if (cmd == "mn")
+        {
+            out.append("MN\r\n");
+        }
+        else if (cmd == "touch")
+        {
+            handleTouch(request, out);
+        }
+        else if (cmd == "incr" || cmd == "decr")
+        {
+            handleArithmetic(request, out, cmd == "incr");
+        }
+        else if (cmd == "flush_all")
+        {
+            bool cleared = adapter_.clear();
+            if (request.tokens[request.tokens.count - 1] != "noreply")
+            {
+                out.append(cleared ? "OK\r\n" : "SERVER_ERROR flush_all not supported\r\n");
+            }
+        }
+        else if (cmd == "version")
+        {
+            out.append("VERSION 1.6.0-xrms\r\n");
+        }
+        else if (cmd == "verbosity")
+        {
+            out.append("OK\r\n");
+        }
+        else if (cmd == "quit")
+        {
+            closeAfterWrite = true;
+        }
+        else if (request.tokens.count > 0)
+        {
+            out.append("ERROR\r\n");
+        }
+        return true;
+    }
+
+    // 值头部为协议文本，数据本身以引用方式交给writev
+    void appendValue(OutputBuffer& out, std::string_view key, const ItemPtr& item, bool withCas)
+    {
+        out.append("VALUE ");
+        out.append(key);
+        out.append(" ");
+        appendNumber(out, item->flags);
+        out.append(" ");
+        appendNumber(out, item->data.size());
+        out.append(withCas ? " 0\r\n" : "\r\n");
+        out.appendRef(item->data.data(), item->data.size(), item);
+        out.append("\r\n");
+    }
+
+    // get <key>*
+    void handleGet(Request& request, OutputBuffer& out, bool withCas)
+    {
+        if (request.tokens.count < 2)
+        {
+            out.append("ERROR\r\n");
+            return;
+        }
+        std::string key;
+        ItemPtr item;
+        for (size_t i = 1; i < request.tokens.count; ++i)
+        {
+            if (!validKey(request.tokens[i]))
+            {
+                out.append("CLIENT_ERROR bad command line format\r\n");
+                return;
+            }
+            key.assign(request.tokens[i]);
+            if (adapter_.get(key, item, request.now))
+            {
+                appendValue(out, request.tokens[i], item, withCas);
+            }
+        }
+        out.append("END\r\n");
+    }
+
+    // 取出命令行之后的数据块，返回false表示数据未收全；badChunk表示数据块不以\r\n结尾
+    bool takeDataBlock(Request& request, size_t bytes, std::string_view& value, bool& badChunk)
+    {
+        if (request.length - request.next < bytes + 2)
+        {
+            return false;
+        }
+        const char* begin = request.data + request.next;
+        value = std::string_view(begin, bytes);
+        badChunk = begin[bytes] != '\r' || begin[bytes + 1] != '\n';
+        request.next += bytes + 2;
+        return true;
+    }
+
+    // 数据块过大：已收全则跳过，否则无法同步协议，回复后断开连接
+    bool rejectTooLarge(Request& request, size_t bytes, OutputBuffer& out, bool& closeAfterWrite)
+    {
+        out.append("SERVER_ERROR object too large for cache\r\n");
+        if (request.length - request.next >= bytes + 2)
+        {
+            request.next += bytes + 2;
+        }
+        else
+        {
+            closeAfterWrite = true;
+            request.next = request.length;
+        }
+        return true;
+    }
+
+    bool store(StoreMode mode, const std::string& key, std::string_view value,
+               uint32_t flags, int64_t expireAt, int64_t now)
+    {
+        if (mode == StoreMode::Set)
+        {
+            adapter_.put(key, makeItem(std::string(value), flags, expireAt));
+            return true;
+        }
+
+        ItemPtr old;
+        bool exists = adapter_.get(key, old, now);
+        switch (mode)
+        {
+        case StoreMode::Add:
+            if (exists)
+                return false;
+            adapter_.put(key, makeItem(std::string(value), flags, expireAt));
+            return true;
+        case StoreMode::Replace:
+            if (!exists)
+                return false;
+            adapter_.put(key, makeItem(std::string(value), flags, expireAt));
+            return true;
+        case StoreMode::Append:
+        case StoreMode::Prepend:
+        {
+            if (!exists)
+                return false;
+            std::string data;
+            data.reserve(old->data.size() + value.size());
+            if (mode == StoreMode::Append)
+            {
+                data.append(old->data).append(value);
+            }
+            else
+            {
+                data.append(value).append(old->data);
+            }
+            // append/prepend保留原有的标志和过期时间
+            adapter_.put(key, makeItem(std::move(data), old->flags, old->expireAt));
+            return true;
+        }
+        default:
+            return false;
+        }
+    }
+
+    // <cmd> <key> <flags> <exptime> <bytes> [noreply]\r\n<data>\r\n
+    bool handleStore(Request& request, OutputBuffer& out, StoreMode mode, bool& closeAfterWrite)
+    {
+        const Tokens& tokens = request.tokens;
+        uint32_t flags = 0;
+        int64_t exptime = 0;
+        size_t bytes = 0;
+        if (tokens.count < 5 || !validKey(tokens[1]) || !parseNumber(tokens[2], flags)
+            || !parseNumber(tokens[3], exptime) || !parseNumber(tokens[4], bytes))
+        {
+            out.append("CLIENT_ERROR bad command line format\r\n");
+            return true;
+        }
+        if (bytes > maxValueBytes_)
+        {
+            return rejectTooLarge(request, bytes, out, closeAfterWrite);
+        }
+
+        std::string_view value;
+        bool badChunk = false;
+        if (!takeDataBlock(request, bytes, value, badChunk))
+        {
+            return false;
+        }
+        if (badChunk)
+        {
+            out.append("CLIENT_ERROR bad data chunk\r\n");
+            return true;
+        }
+
+        bool stored = store(mode, std::string(tokens[1]), value, flags,
+                            toExpireAt(exptime, request.now), request.now);
+        if (tokens[5] != "noreply")
+        {
+            out.append(stored ? "STORED\r\n" : "NOT_STORED\r\n");
+        }
+        return true;
+    }
+
+    // delete <key> [0] [noreply]
+    void handleDelete(Request& request, OutputBuffer& out)
+    {
+        const Tokens& tokens = request.tokens;
+        if (tokens.count < 2 || !validKey(tokens[1]))
+        {
+            out.append("CLIENT_ERROR bad command line format\r\n");
+            return;
+        }
+        std::string key(tokens[1]);
+        ItemPtr item;
+        bool found = adapter_.get(key, item, request.now);
+        if (found)
+        {
+            adapter_.remove(key);
+        }
+        if (tokens[tokens.count - 1] != "noreply")
+        {
+            out.append(found ? "DELETED\r\n" : "NOT_FOUND\r\n");
+        }
+    }
+
+    // touch <key> <exptime> [noreply]
+    void handleTouch(Request& request, OutputBuffer& out)
+    {
+        const Tokens& tokens = request.tokens;
+        int64_t exptime = 0;
+        if (tokens.count < 3 || !validKey(tokens[1]) || !parseNumber(tokens[2], exptime))
+        {
+            out.append("CLIENT_ERROR bad command line format\r\n");
+            return;
+        }
+        bool found = touch(std::string(tokens[1]), toExpireAt(exptime, request.now), request.now);
+        if (tokens[3] != "noreply")
+        {
+            out.append(found ? "TOUCHED\r\n" : "NOT_FOUND\r\n");
+        }
+    }
+
+    bool touch(const std::string& key, int64_t expireAt, int64_t now)
+    {
+        ItemPtr item;
+        if (!adapter_.get(key, item, now))
+        {
+            return false;
+        }
+        adapter_.put(key, makeItem(item->data, item->flags, expireAt));
+        return true;
+    }
+
+    // incr|decr <key> <delta> [noreply]
+    void handleArithmetic(Request& request, OutputBuffer& out, bool increment)
+    {
+        const Tokens& tokens = request.tokens;
+        uint64_t delta = 0;
+        if (tokens.count < 3 || !validKey(tokens[1]) || !parseNumber(tokens[2], delta))
+        {
+            out.append("CLIENT_ERROR invalid numeric delta argument\r\n");
+            return;
+        }
+        bool noreply = tokens[3] == "noreply";
+        std::string key(tokens[1]);
+        ItemPtr item;
+        if (!adapter_.get(key, item, request.now))
+        {
+            if (!noreply)
+                out.append("NOT_FOUND\r\n");
+            return;
+        }
+        uint64_t current = 0;
+        if (!parseNumber(std::string_view(item->data), current))
+        {
+            out.append("CLIENT_ERROR cannot increment or decrement non-numeric value\r\n");
+            return;
+        }
+        // 自增按64位回绕，自减不小于0
+        current = increment ? current + delta : (delta > current ? 0 : current - delta);
+        std::string data = std::to_string(current);
+        adapter_.put(key, makeItem(data, item->flags, item->expireAt));
+        if (!noreply)
+        {
+            out.append(data);
+            out.append("\r\n");
+        }
+    }
+
+    // meta命令的回显标志：O(opaque)与k(key)原样带回
+    static void appendEchoFlags(OutputBuffer& out, const Tokens& tokens, size_t firstFlag)
+    {
+        for (size_t i = firstFlag; i < tokens.count; ++i)
+        {
+            char flag = tokens[i][0];
+            if (flag == 'O')
+            {
+                out.append(" ");
+                out.append(tokens[i]);
+            }
+            else if (flag == 'k')
+            {
+                out.append(" k");
+                out.append(tokens[1]);
+            }
+        }
+    }
+
+    static bool hasFlag(const Tokens& tokens, size_t firstFlag, char flag)
+    {
+        for (size_t i = firstFlag; i < tokens.count; ++i)
+        {
+            if (tokens[i][0] == flag)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // mg <key> <flags>*   支持 v f t s k O q T c
+    void handleMetaGet(Request& request, OutputBuffer& out)
+    {
+        const Tokens& tokens = request.tokens;
+        if (tokens.count < 2 || !validKey(tokens[1]))
+        {
+            out.append("CLIENT_ERROR bad command line format\r\n");
+            return;
+        }
+        std::string key(tokens[1]);
+        ItemPtr item;
+        if (!adapter_.get(key, item, request.now))
+        {
+            if (!hasFlag(tokens, 2, 'q'))
+            {
+                out.append("EN\r\n");
+            }
+            return;
+        }
+
+        // T<ttl>：读取的同时更新过期时间
+        for (size_t i = 2; i < tokens.count; ++i)
+        {
+            int64_t ttl = 0;
+            if (tokens[i][0] == 'T' && parseNumber(tokens[i].substr(1), ttl))
+            {
+                int64_t expireAt = toExpireAt(ttl, request.now);
+                adapter_.put(key, makeItem(item->data, item->flags, expireAt));
+                adapter_.get(key, item, request.now);
+                break;
+            }
+        }
+
+        bool withValue = hasFlag(tokens, 2, 'v');
+        if (withValue)
+        {
+            out.append("VA ");
+            appendNumber(out, item->data.size());
+        }
+        else
+        {
+            out.append("HD");
+        }
+        for (size_t i = 2; i < tokens.count; ++i)
+        {
+            switch (tokens[i][0])
+            {
+            case 'f':
+                out.append(" f");
+                appendNumber(out, item->flags);
+                break;
+            case 't':
+                out.append(" t");
+                appendNumber(out, item->expireAt == 0 ? int64_t(-1) : item->expireAt - request.now);
+                break;
+            case 's':
+                out.append(" s");
+                appendNumber(out, item->data.size());
+                break;
+            case 'c':
+                out.append(" c0");
+                break;
+            default:
+                break;
+            }
+        }
+        appendEchoFlags(out, tokens, 2);
+        out.append("\r\n");
+        if (withValue)
+        {
+            out.appendRef(item->data.data(), item->data.size(), item);
+            out.append("\r\n");
+        }
+    }
+
+    // ms <key> <datalen> <flags>*\r\n<data>\r\n   支持 T F M(S|E|A|P|R) q O k
+    bool handleMetaSet(Request& request, OutputBuffer& out, bool& closeAfterWrite)
+    {
+        const Tokens& tokens = request.tokens;
+        size_t bytes = 0;
+        if (tokens.count < 3 || !validKey(tokens[1]) || !parseNumber(tokens[2], bytes))
+        {
+            out.append("CLIENT_ERROR bad command line format\r\n");
+            return true;
+        }
+        if (bytes > maxValueBytes_)
+        {
+            return rejectTooLarge(request, bytes, out, closeAfterWrite);
+        }
+
+        std::string_view value;
+        bool badChunk = false;
+        if (!takeDataBlock(request, bytes, value, badChunk))
+        {
+            return false;
+        }
+        if (badChunk)
+        {
+            out.append("CLIENT_ERROR bad data chunk\r\n");
+            return true;
+        }
+
+        uint32_t flags = 0;
+        int64_t ttl = 0;
+        StoreMode mode = StoreMode::Set;
+        for (size_t i = 3; i < tokens.count; ++i)
+        {
+            std::string_view arg = tokens[i].substr(1);
+            switch (tokens[i][0])
+            {
+            case 'F':
+                parseNumber(arg, flags);
+                break;
+            case 'T':
+                parseNumber(arg, ttl);
+                break;
+            case 'M':
+                switch (arg.empty() ? 'S' : arg[0])
+                {
+                case 'E': case 'e': mode = StoreMode::Add; break;
+                case 'A': case 'a': mode = StoreMode::Append; break;
+                case 'P': case 'p': mode = StoreMode::Prepend; break;
+                case 'R': case 'r': mode = StoreMode::Replace; break;
+                default: mode = StoreMode::Set; break;
+                }
+                break;
+            default:
+                break;
+            }
+        }
+
+        bool stored = store(mode, std::string(tokens[1]), value, flags,
+                            toExpireAt(ttl, request.now), request.now);
+        if (stored && hasFlag(tokens, 3, 'q'))
+        {
+            return true;
+        }
+        out.append(stored ? "HD" : "NS");
+        appendEchoFlags(out, tokens, 3);
+        out.append("\r\n");
+        return true;
+    }
+
+    // md <key> <flags>*   支持 q O k
+    void handleMetaDelete(Request& request, OutputBuffer& out)
+    {
+        const Tokens& tokens = request.tokens;
+        if (tokens.count < 2 || !validKey(tokens[1]))
+        {
+            out.append("CLIENT_ERROR bad command line format\r\n");
+            return;
+        }
+        std::string key(tokens[1]);
+        ItemPtr item;
+        bool found = adapter_.get(key, item, request.now);
+        if (found)
+        {
+            adapter_.remove(key);
+        }
+        if (hasFlag(tokens, 2, 'q'))
+        {
+            return;
+        }
+        out.append(found ? "HD" : "NF");
+        appendEchoFlags(out, tokens, 2);
+        out.append("\r\n");
+    }
+
+private:
+    CacheAdapter<Cache> adapter_;
+    size_t maxValueBytes_;  // 单个值的最大字节数
+};
+
+} // namespace XrmsServer
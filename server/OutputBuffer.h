@@ -0,0 +1,152 @@
+#pragma once
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace XrmsServer
+{
+
+/*
+ * OutputBuffer 连接的输出缓冲区
+ * 协议文本（命令回复、值头部）拷贝进内部的text_，缓存中的值只记录指针和长度，
+ * 并持有其shared_ptr保证写出前不被淘汰释放，最后用writev一次性写出，值本身不做拷贝。
+ */
+class OutputBuffer
+{
+public:
+    // 追加一段协议文本（拷贝）
+    void append(std::string_view text)
+    {
+        if (text.empty())
+        {
+            return;
+        }
+        if (!segments_.empty() && segments_.back().external == nullptr
+            && segments_.back().offset + segments_.back().length == text_.size())
+        {
+            // 与上一段内部文本相邻，直接合并
+            segments_.back().length += text.size();
+        }
+        else
+        {
+            segments_.push_back({nullptr, text_.size(), text.size()});
+        }
+        text_.append(text.data(), text.size());
+    }
+
+    // 追加一段外部数据（不拷贝），holder保证数据在写出前一直有效
+    void appendRef(const char* data, size_t length, std::shared_ptr<const void> holder)
+    {
+        if (length == 0)
+        {
+            return;
+        }
+        segments_.push_back({data, 0, length});
+        holders_.push_back(std::move(holder));
+    }
+
+    bool empty() const { return segments_.size() == flushed_; }
+
+    // 尚未写出的字节数
+    size_t pendingBytes() const
+    {
+        size_t total = 0;
+        for (size_t i = flushed_; i < segments_.size(); ++i)
+        {
+            total += segments_[i].length;
+        }
+        return total;
+    }
+
+    // 尽可能多地写出，返回false表示连接出错；写不完的部分留待下次可写时继续
+    bool flush(int fd)
+    {
+        while (!empty())
+        {
+            iovec iov[IOV_MAX_BATCH];
+            int count = 0;
+            for (size_t i = flushed_; i < segments_.size() && count < IOV_MAX_BATCH; ++i, ++count)
+            {
+                const Segment& seg = segments_[i];
+                const char* base = seg.external ? seg.external : text_.data() + seg.offset;
+                iov[count].iov_base = const_cast<char*>(base);
+                iov[count].iov_len = seg.length;
+            }
+
+            ssize_t written = ::writev(fd, iov, count);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return errno == EAGAIN || errno == EWOULDBLOCK;
+            }
+            consume(static_cast<size_t>(written));
+        }
+        clear();
+        return true;
+    }
+
+    void clear()
+    {
+        text_.clear();
+        segments_.clear();
+        holders_.clear();
+        flushed_ = 0;
+    }
+
+private:
+    static constexpr int IOV_MAX_BATCH = std::min(IOV_MAX, 512);
+
+    struct Segment
+    {
+        const char* external;  // 外部数据指针，nullptr表示位于text_中
+        size_t offset;         // 在text_中的偏移
+        size_t length;
+    };
+
+    // 跳过已写出的字节，部分写出的段调整起点
+    void consume(size_t written)
+    {
+        while (written > 0 && flushed_ < segments_.size())
+        {
+            Segment& seg = segments_[flushed_];
+            if (written >= seg.length)
+            {
+                written -= seg.length;
+                ++flushed_;
+            }
+            else
+            {
+                if (seg.external)
+                {
+                    seg.external += written;
+                }
+                else
+                {
+                    seg.offset += written;
+                }
+                seg.length -= written;
+                written = 0;
+            }
+        }
+    }
+
+private:
+    std::string text_;                  // 协议文本
+    std::vector<Segment> segments_;     // 按写出顺序排列的数据段
+    std::vector<std::shared_ptr<const void>> holders_;  // 外部数据的持有者
+    size_t flushed_ = 0;                // 已完整写出的段数
+};
+
+} // namespace XrmsServer
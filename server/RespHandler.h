@@ -0,0 +1,543 @@
+#pragma once
+
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "CacheItem.h"
+#include "OutputBuffer.h"
+
+namespace XrmsServer
+{
+
+/*
+ * RespHandler Redis RESP2协议子集的请求处理器
+ * 支持的命令：GET SET(EX|PX) MGET MSET DEL EXPIRE TTL PING ECHO SELECT FLUSHALL FLUSHDB COMMAND QUIT
+ * 一次调用先把缓冲区中全部完整的命令解码成一批缓存操作，交给分片缓存按分片分组执行
+ * （每个分片每批只加一次锁），再按命令顺序组装回复，值以引用方式写出，不做拷贝。
+ */
+template<typename Cache>
+class RespHandler
+{
+public:
+    explicit RespHandler(Cache& cache, size_t maxBulkBytes = 64 << 20)
+        : adapter_(cache)
+        , maxBulkBytes_(maxBulkBytes)
+    {}
+
+    size_t process(const char* data, size_t length, OutputBuffer& out, bool& closeAfterWrite)
+    {
+        // 解码用的临时数组按线程复用，避免每批请求都重新分配
+        thread_local Batch batch;
+        size_t pos = 0;
+        while (pos < length && !closeAfterWrite)
+        {
+            batch.clear();
+            int64_t now = nowSeconds();
+            bool barrier = false;
+            size_t consumed = decodeBatch(data + pos, length - pos, batch, now, barrier, closeAfterWrite);
+            if (batch.commands.empty())
+            {
+                pos += consumed;
+                break;
+            }
+
+            bindUpdateArgs(batch);
+            adapter_.applyBatch(batch.ops);
+            for (const Command& command : batch.commands)
+            {
+                render(command, batch, out, now, closeAfterWrite);
+            }
+            pos += consumed;
+            if (!barrier)
+            {
+                break;
+            }
+        }
+        return pos;
+    }
+
+private:
+    enum class Kind { Get, Set, MGet, MSet, Del, Expire, Ttl, Ping, Echo, Ok, FlushAll, EmptyArray, Quit, Error };
+
+    struct ExpireArg
+    {
+        int64_t expireAt;
+        int64_t now;
+    };
+
+    // 一条命令对应的回复信息，以及它在本批操作数组中占用的区间
+    struct Command
+    {
+        Kind kind = Kind::Error;
+        size_t firstOp = 0;
+        size_t opCount = 0;
+        std::string text;       // Ping/Echo的回显内容，Error的错误信息
+        ExpireArg expire{0, 0}; // EXPIRE的参数
+    };
+
+    struct Batch
+    {
+        std::vector<std::string_view> args;
+        std::vector<Command> commands;
+        std::vector<BatchOp> ops;
+
+        void clear()
+        {
+            args.clear();
+            commands.clear();
+            ops.clear();
+        }
+    };
+
+    static constexpr size_t NEED_MORE = 0;
+    static constexpr size_t PROTOCOL_ERROR = std::numeric_limits<size_t>::max();
+    static constexpr size_t MAX_INLINE_LENGTH = 64 * 1024;
+    static constexpr size_t MAX_ARGS = 1024 * 1024;
+
+    template<typename T>
+    static bool parseNumber(std::string_view text, T& value)
+    {
+        if (text.empty())
+        {
+            return false;
+        }
+        auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size();
+    }
+
+    template<typename T>
+    static void appendNumber(OutputBuffer& out, T value)
+    {
+        char buffer[24];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(std::string_view(buffer, static_cast<size_t>(result.ptr - buffer)));
+    }
+
+    // 读取一行（不含\r\n），返回下一行的起始位置，行不完整时返回NEED_MORE
+    static size_t readLine(const char* data, size_t length, size_t pos, std::string_view& line)
+    {
+        const char* newline = static_cast<const char*>(std::memchr(data + pos, '\n', length - pos));
+        if (!newline)
+        {
+            return NEED_MORE;
+        }
+        size_t end = static_cast<size_t>(newline - data);
+        line = std::string_view(data + pos, end - pos);
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.remove_suffix(1);
+        }
+        return end + 1;
+    }
+
+    // 解析一条命令的参数，返回消费的字节数；不完整返回NEED_MORE，格式错误返回PROTOCOL_ERROR
+    size_t parseCommand(const char* data, size_t length, std::vector<std::string_view>& args) const
+    {
+        std::string_view line;
+        size_t pos = readLine(data, length, 0, line);
+        if (pos == NEED_MORE)
+        {
+            return length > MAX_INLINE_LENGTH ? PROTOCOL_ERROR : NEED_MORE;
+        }
+
+        if (line.empty() || line[0] != '*')
+        {
+            // 内联命令：以空格分隔的一行，便于telnet等工具调试
+            size_t i = 0;
+            while (i < line.size())
+            {
+                while (i < line.size() && line[i] == ' ')
+                    ++i;
+                size_t begin = i;
+                while (i < line.size() && line[i] != ' ')
+                    ++i;
+                if (i > begin)
+                    args.push_back(line.substr(begin, i - begin));
+            }
+            return pos;
+        }
+
+        size_t count = 0;
+        if (!parseNumber(line.substr(1), count) || count > MAX_ARGS)
+        {
+            return PROTOCOL_ERROR;
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (pos >= length)
+            {
+                return NEED_MORE;
+            }
+            size_t next = readLine(data, length, pos, line);
+            if (next == NEED_MORE)
+            {
+                return NEED_MORE;
+            }
+            size_t bulkLength = 0;
+            if (line.empty() || line[0] != '$' || !parseNumber(line.substr(1), bulkLength)
+                || bulkLength > maxBulkBytes_)
+            {
+                return PROTOCOL_ERROR;
+            }
+            if (length - next < bulkLength + 2)
+            {
+                return NEED_MORE;
+            }
+            args.emplace_back(data + next, bulkLength);
+            pos = next + bulkLength + 2;
+        }
+        return pos;
+    }
+
+    static bool equalsIgnoreCase(std::string_view a, const char* b)
+    {
+        size_t n = std::strlen(b);
+        if (a.size() != n)
+        {
+            return false;
+        }
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (std::toupper(static_cast<unsigned char>(a[i])) != b[i])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static ItemPtr makeItem(std::string_view data, int64_t expireAt)
+    {
+        auto item = std::make_shared<CacheItem>();
+        item->data.assign(data.data(), data.size());
+        item->expireAt = expireAt;
+        return item;
+    }
+
+    static void addOp(Batch& batch, BatchOp::Type type, std::string_view key, ItemPtr value = ItemPtr())
+    {
+        batch.ops.emplace_back();
+        BatchOp& op = batch.ops.back();
+        op.type = type;
+        op.key.assign(key.data(), key.size());
+        op.value = std::move(value);
+    }
+
+    // EXPIRE在分片锁内执行：条目存在且未过期时替换为带新过期时间的副本
+    static bool applyExpire(ItemPtr& item, const void* arg)
+    {
+        const ExpireArg* expire = static_cast<const ExpireArg*>(arg);
+        if (!item || item->expired(expire->now))
+        {
+            return false;
+        }
+        auto copy = std::make_shared<CacheItem>(*item);
+        copy->expireAt = expire->expireAt;
+        item = std::move(copy);
+        return true;
+    }
+
+    // 命令数组全部解码完成、地址不再变化后，再把EXPIRE的参数地址填入对应操作
+    static void bindUpdateArgs(Batch& batch)
+    {
+        for (Command& command : batch.commands)
+        {
+            if (command.kind == Kind::Expire)
+            {
+                batch.ops[command.firstOp].updateArg = &command.expire;
+            }
+        }
+    }
+
+    static Command errorCommand(std::string message)
+    {
+        Command command;
+        command.text = std::move(message);
+        return command;
+    }
+
+    static Command wrongArity(std::string_view name)
+    {
+        return errorCommand("ERR wrong number of arguments for '" + std::string(name) + "' command");
+    }
+
+    // 解码尽可能多的完整命令，遇到FLUSHALL这类必须与前后命令隔开的命令时截断本批（barrier=true）
+    size_t decodeBatch(const char* data, size_t length, Batch& batch, int64_t now,
+                       bool& barrier, bool& closeAfterWrite)
+    {
+        size_t pos = 0;
+        while (pos < length)
+        {
+            batch.args.clear();
+            size_t used = parseCommand(data + pos, length - pos, batch.args);
+            if (used == NEED_MORE)
+            {
+                break;
+            }
+            if (used == PROTOCOL_ERROR)
+            {
+                // 协议已无法同步：先回复已解码的命令，再报错断开
+                batch.commands.push_back(errorCommand("ERR Protocol error"));
+                closeAfterWrite = true;
+                return length;
+            }
+            pos += used;
+            if (batch.args.empty())
+            {
+                continue;
+            }
+            decodeCommand(batch, now);
+            if (batch.commands.back().kind == Kind::FlushAll || batch.commands.back().kind == Kind::Quit)
+            {
+                barrier = true;
+                break;
+            }
+        }
+        return pos;
+    }
+
+    void decodeCommand(Batch& batch, int64_t now)
+    {
+        const std::vector<std::string_view>& args = batch.args;
+        std::string_view name = args[0];
+        size_t argc = args.size();
+        Command command;
+        command.firstOp = batch.ops.size();
+
+        if (equalsIgnoreCase(name, "GET"))
+        {
+            if (argc != 2)
+            {
+                batch.commands.push_back(wrongArity(name));
+                return;
+            }
+            command.kind = Kind::Get;
+            addOp(batch, BatchOp::Type::Get, args[1]);
+        }
+        else if (equalsIgnoreCase(name, "SET"))
+        {
+            if (argc < 3)
+            {
+                batch.commands.push_back(wrongArity(name));
+                return;
+            }
+            int64_t expireAt = 0;
+            for (size_t i = 3; i < argc; ++i)
+            {
+                int64_t amount = 0;
+                bool seconds = equalsIgnoreCase(args[i], "EX");
+                if ((!seconds && !equalsIgnoreCase(args[i], "PX")) || i + 1 >= argc
+                    || !parseNumber(args[i + 1], amount) || amount <= 0)
+                {
+                    batch.commands.push_back(errorCommand("ERR syntax error"));
+                    return;
+                }
+                expireAt = now + (seconds ? amount : (amount + 999) / 1000);
+                ++i;
+            }
+            command.kind = Kind::Set;
+            addOp(batch, BatchOp::Type::Put, args[1], makeItem(args[2], expireAt));
+        }
+        else if (equalsIgnoreCase(name, "MGET"))
+        {
+            if (argc < 2)
+            {
+                batch.commands.push_back(wrongArity(name));
+                return;
+            }
+            command.kind = Kind::MGet;
+            for (size_t i = 1; i < argc; ++i)
+                addOp(batch, BatchOp::Type::Get, args[i]);
+        }
+        else if (equalsIgnoreCase(name, "MSET"))
+        {
+            if (argc < 3 || argc % 2 == 0)
+            {
+                batch.commands.push_back(wrongArity(name));
+                return;
+            }
+            command.kind = Kind::MSet;
+            for (size_t i = 1; i + 1 < argc; i += 2)
+                addOp(batch, BatchOp::Type::Put, args[i], makeItem(args[i + 1], 0));
+        }
+        else if (equalsIgnoreCase(name, "DEL"))
+        {
+            if (argc < 2)
+            {
+                batch.commands.push_back(wrongArity(name));
+                return;
+            }
+            command.kind = Kind::Del;
+            for (size_t i = 1; i < argc; ++i)
+                addOp(batch, BatchOp::Type::Remove, args[i]);
+        }
+        else if (equalsIgnoreCase(name, "EXPIRE"))
+        {
+            int64_t seconds = 0;
+            if (argc != 3)
+            {
+                batch.commands.push_back(wrongArity(name));
+                return;
+            }
+            if (!parseNumber(args[2], seconds))
+            {
+                batch.commands.push_back(errorCommand("ERR value is not an integer or out of range"));
+                return;
+            }
+            command.kind = Kind::Expire;
+            command.expire = ExpireArg{seconds > 0 ? now + seconds : now - 1, now};
+            addOp(batch, BatchOp::Type::Update, args[1]);
+            batch.ops.back().update = &RespHandler::applyExpire;
+        }
+        else if (equalsIgnoreCase(name, "TTL"))
+        {
+            if (argc != 2)
+            {
+                batch.commands.push_back(wrongArity(name));
+                return;
+            }
+            command.kind = Kind::Ttl;
+            addOp(batch, BatchOp::Type::Get, args[1]);
+        }
+        else if (equalsIgnoreCase(name, "PING"))
+        {
+            command.kind = argc > 1 ? Kind::Echo : Kind::Ping;
+            if (argc > 1)
+                command.text.assign(args[1].data(), args[1].size());
+        }
+        else if (equalsIgnoreCase(name, "ECHO"))
+        {
+            if (argc != 2)
+            {
+                batch.commands.push_back(wrongArity(name));
+                return;
+            }
+            command.kind = Kind::Echo;
+            command.text.assign(args[1].data(), args[1].size());
+        }
+        else if (equalsIgnoreCase(name, "SELECT"))
+        {
+            command.kind = Kind::Ok;
+        }
+        else if (equalsIgnoreCase(name, "FLUSHALL") || equalsIgnoreCase(name, "FLUSHDB"))
+        {
+            command.kind = Kind::FlushAll;
+        }
+        else if (equalsIgnoreCase(name, "COMMAND"))
+        {
+            command.kind = Kind::EmptyArray;
+        }
+        else if (equalsIgnoreCase(name, "QUIT"))
+        {
+            command.kind = Kind::Quit;
+        }
+        else
+        {
+            command = errorCommand("ERR unknown command '" + std::string(name) + "'");
+        }
+        command.opCount = batch.ops.size() - command.firstOp;
+        batch.commands.push_back(std::move(command));
+    }
+
+    static bool live(const BatchOp& op, int64_t now)
+    {
+        return op.found && op.value && !op.value->expired(now);
+    }
+
+    static void appendBulk(OutputBuffer& out, const BatchOp& op, int64_t now)
+    {
+        if (!live(op, now))
+        {
+            out.append("$-1\r\n");
+            return;
+        }
+        const ItemPtr& item = op.value;
+        out.append("$");
+        appendNumber(out, item->data.size());
+        out.append("\r\n");
+        out.appendRef(item->data.data(), item->data.size(), item);
+        out.append("\r\n");
+    }
+
+    void render(const Command& command, const Batch& batch, OutputBuffer& out, int64_t now, bool& closeAfterWrite)
+    {
+        const BatchOp* ops = batch.ops.data() + command.firstOp;
+        switch (command.kind)
+        {
+        case Kind::Get:
+            appendBulk(out, ops[0], now);
+            break;
+        case Kind::MGet:
+            out.append("*");
+            appendNumber(out, command.opCount);
+            out.append("\r\n");
+            for (size_t i = 0; i < command.opCount; ++i)
+                appendBulk(out, ops[i], now);
+            break;
+        case Kind::Set:
+        case Kind::MSet:
+        case Kind::Ok:
+            out.append("+OK\r\n");
+            break;
+        case Kind::Del:
+        {
+            size_t removed = 0;
+            for (size_t i = 0; i < command.opCount; ++i)
+                removed += live(ops[i], now) ? 1 : 0;
+            out.append(":");
+            appendNumber(out, removed);
+            out.append("\r\n");
+            break;
+        }
+        case Kind::Expire:
+            out.append(ops[0].found ? ":1\r\n" : ":0\r\n");
+            break;
+        case Kind::Ttl:
+            out.append(":");
+            if (!live(ops[0], now))
+                appendNumber(out, -2);
+            else
+                appendNumber(out, ops[0].value->expireAt == 0 ? int64_t(-1) : ops[0].value->expireAt - now);
+            out.append("\r\n");
+            break;
+        case Kind::Ping:
+            out.append("+PONG\r\n");
+            break;
+        case Kind::Echo:
+            out.append("$");
+            appendNumber(out, command.text.size());
+            out.append("\r\n");
+            out.append(command.text);
+            out.append("\r\n");
+            break;
+        case Kind::FlushAll:
+            out.append(adapter_.clear() ? "+OK\r\n" : "-ERR flush not supported\r\n");
+            break;
+        case Kind::EmptyArray:
+            out.append("*0\r\n");
+            break;
+        case Kind::Quit:
+            out.append("+OK\r\n");
+            closeAfterWrite = true;
+            break;
+        case Kind::Error:
+            out.append("-");
+            out.append(command.text);
+            out.append("\r\n");
+            break;
+        }
+    }
+
+private:
+    CacheAdapter<Cache> adapter_;
+    size_t maxBulkBytes_;   // 单个参数的最大字节数
+};
+
+} // namespace XrmsServer
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <getopt.h>
+#include <signal.h>
+
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "CacheItem.h"
+#include "EventLoopServer.h"
+#include "LfuCache.h"
+#include "LruCache.h"
+#include "MetricsExporter.h"
+
+namespace XrmsServer
+{
+
+// 各协议服务端共用的启动流程：解析命令行、按策略创建分片缓存、启动事件循环并等待退出信号
+// 选项: [-p 端口] [-t 线程数] [-m 容量(条目数)] [-s 分片数] [-P lru|lfu] [-M 指标端口]
+// 指定-M时在127.0.0.1的该端口以Prometheus格式导出缓存指标（GET /metrics），默认不导出
+
+inline std::function<void()>& serverStopHook()
+{
+    static std::function<void()> hook;
+    return hook;
+}
+
+inline void onStopSignal(int)
+{
+    if (serverStopHook())
+    {
+        serverStopHook()();
+    }
+}
+
+template<template<typename> class Handler, typename Cache>
+int serveCache(Cache& cache, const char* name, const std::string& policy, uint16_t port, int threads,
+               uint16_t metricsPort)
+{
+    XrmsCache::CacheMetrics metrics;
+    std::unique_ptr<XrmsCache::MetricsExporter> exporter;
+    if (metricsPort > 0)
+    {
+        cache.setMetrics(metrics, policy);
+        exporter.reset(new XrmsCache::MetricsExporter(metrics, metricsPort));
+        std::cout << "指标导出 http://127.0.0.1:" << exporter->port() << "/metrics" << std::endl;
+    }
+
+    Handler<Cache> handler(cache);
+    EventLoopServer<Handler<Cache>> server(handler, port, threads);
+    serverStopHook() = [&server]() { server.stop(); };
+    ::signal(SIGINT, onStopSignal);
+    ::signal(SIGTERM, onStopSignal);
+    ::signal(SIGPIPE, SIG_IGN);
+
+    std::cout << name << " 监听端口 " << port << "，事件循环线程 " << server.threadNum() << std::endl;
+    server.start();
+    server.join();
+    serverStopHook() = nullptr;
+    return 0;
+}
+
+template<template<typename> class Handler>
+int runServerMain(int argc, char* argv[], const char* name, uint16_t defaultPort)
+{
+    uint16_t port = defaultPort;
+    int threads = 0;
+    size_t capacity = 1000000;
+    int slices = 0;
+    std::string policy = "lru";
+    uint16_t metricsPort = 0;
+
+    int opt;
+    while ((opt = ::getopt(argc, argv, "p:t:m:s:P:M:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'p': port = static_cast<uint16_t>(std::atoi(optarg)); break;
+        case 't': threads = std::atoi(optarg); break;
+        case 'm': capacity = std::strtoull(optarg, nullptr, 10); break;
+        case 's': slices = std::atoi(optarg); break;
+        case 'P': policy = optarg; break;
+        case 'M': metricsPort = static_cast<uint16_t>(std::atoi(optarg)); break;
+        default:
+            std::cerr << "用法: " << argv[0] << " [-p 端口] [-t 线程数] [-m 容量] [-s 分片数] [-P lru|lfu] [-M 指标端口]"
+                      << std::endl;
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    try
+    {
+        if (policy == "lfu")
+        {
+            XrmsCache::HashLfuCache<std::string, ItemPtr> cache(capacity, slices);
+            return serveCache<Handler>(cache, name, policy, port, threads, metricsPort);
+        }
+        XrmsCache::HashLruCaches<std::string, ItemPtr> cache(capacity, slices);
+        return serveCache<Handler>(cache, name, policy, port, threads, metricsPort);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "启动失败: " << e.what() << std::endl;
+        return 1;
+    }
+}
+
+} // namespace XrmsServer
@@ -0,0 +1,278 @@
+#include <arpa/inet.h>
+#include <getopt.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// memcachedServer 的回环压测工具：多连接、每个连接流水线发送一批请求后统一读取回复
+// 用法: memcachedLoadGen [-H 主机] [-p 端口] [-c 连接数] [-d 流水线深度] [-n 秒数]
+//                        [-k key数量] [-v 值字节数] [-r get百分比] [-M text|meta]
+
+namespace
+{
+
+struct Options
+{
+    std::string host = "127.0.0.1";
+    uint16_t port = 11211;
+    int connections = 4;
+    int depth = 32;
+    int seconds = 5;
+    int keys = 100000;
+    int valueSize = 32;
+    int getPercent = 90;
+    bool meta = false;
+};
+
+int connectTo(const Options& opt)
+{
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(opt.port);
+    ::inet_pton(AF_INET, opt.host.c_str(), &addr.sin_addr);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0)
+    {
+        std::cerr << "连接 " << opt.host << ":" << opt.port << " 失败: " << std::strerror(errno) << std::endl;
+        std::exit(1);
+    }
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+bool writeAll(int fd, const std::string& data)
+{
+    size_t sent = 0;
+    while (sent < data.size())
+    {
+        ssize_t n = ::write(fd, data.data() + sent, data.size() - sent);
+        if (n <= 0)
+            return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// 解析一条回复，返回消费的字节数，数据不完整时返回0；hit记录get是否命中
+size_t parseReply(std::string_view buf, bool isGet, bool meta, bool& hit)
+{
+    size_t eol = buf.find("\r\n");
+    if (eol == std::string_view::npos)
+        return 0;
+    std::string_view line = buf.substr(0, eol);
+    size_t pos = eol + 2;
+    if (!isGet)
+    {
+        hit = true;
+        return pos;
+    }
+    if (meta)
+    {
+        // VA <n> ... \r\n<data>\r\n  或  EN\r\n
+        if (line.substr(0, 2) != "VA")
+        {
+            hit = false;
+            return pos;
+        }
+        size_t n = std::strtoull(std::string(line.substr(3)).c_str(), nullptr, 10);
+        if (buf.size() < pos + n + 2)
+            return 0;
+        hit = true;
+        return pos + n + 2;
+    }
+    // VALUE <key> <flags> <n>\r\n<data>\r\nEND\r\n  或  END\r\n
+    if (line == "END")
+    {
+        hit = false;
+        return pos;
+    }
+    size_t lastSpace = line.rfind(' ');
+    size_t n = std::strtoull(std::string(line.substr(lastSpace + 1)).c_str(), nullptr, 10);
+    if (buf.size() < pos + n + 2 + 5)
+        return 0;
+    hit = true;
+    return pos + n + 2 + 5;
+}
+
+// 发送一批请求并读取全部回复，返回命中次数，出错返回-1
+int roundTrip(int fd, const std::string& batch, const std::vector<bool>& isGet, bool meta, std::string& inbuf)
+{
+    if (!writeAll(fd, batch))
+        return -1;
+    size_t parsed = 0;
+    size_t offset = 0;
+    int hits = 0;
+    char buffer[64 * 1024];
+    inbuf.clear();
+    while (parsed < isGet.size())
+    {
+        bool hit = false;
+        size_t used = parseReply(std::string_view(inbuf).substr(offset), isGet[parsed], meta, hit);
+        if (used > 0)
+        {
+            offset += used;
+            hits += (isGet[parsed] && hit) ? 1 : 0;
+            ++parsed;
+            continue;
+        }
+        ssize_t n = ::read(fd, buffer, sizeof(buffer));
+        if (n <= 0)
+            return -1;
+        inbuf.append(buffer, static_cast<size_t>(n));
+    }
+    return hits;
+}
+
+std::string keyOf(int i)
+{
+    return "key:" + std::to_string(i);
+}
+
+void appendSet(std::string& batch, const std::string& key, const std::string& value, bool meta)
+{
+    if (meta)
+        batch += "ms " + key + " " + std::to_string(value.size()) + "\r\n" + value + "\r\n";
+    else
+        batch += "set " + key + " 0 0 " + std::to_string(value.size()) + "\r\n" + value + "\r\n";
+}
+
+void appendGet(std::string& batch, const std::string& key, bool meta)
+{
+    batch += meta ? "mg " + key + " v\r\n" : "get " + key + "\r\n";
+}
+
+// 预热全部key，并抽查回读内容是否一致
+bool preload(const Options& opt, const std::string& value)
+{
+    int fd = connectTo(opt);
+    std::string inbuf;
+    for (int begin = 0; begin < opt.keys; begin += 1000)
+    {
+        std::string batch;
+        std::vector<bool> isGet;
+        for (int i = begin; i < std::min(opt.keys, begin + 1000); ++i)
+        {
+            appendSet(batch, keyOf(i), value, opt.meta);
+            isGet.push_back(false);
+        }
+        if (roundTrip(fd, batch, isGet, opt.meta, inbuf) < 0)
+            return false;
+    }
+
+    std::string check = "get " + keyOf(0) + "\r\n";
+    std::string expected = "VALUE " + keyOf(0) + " 0 " + std::to_string(value.size()) + "\r\n" + value + "\r\nEND\r\n";
+    std::vector<bool> isGet{true};
+    bool ok = roundTrip(fd, check, isGet, false, inbuf) >= 0 && inbuf == expected;
+    ::close(fd);
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Options opt;
+    int c;
+    while ((c = ::getopt(argc, argv, "H:p:c:d:n:k:v:r:M:h")) != -1)
+    {
+        switch (c)
+        {
+        case 'H': opt.host = optarg; break;
+        case 'p': opt.port = static_cast<uint16_t>(std::atoi(optarg)); break;
+        case 'c': opt.connections = std::atoi(optarg); break;
+        case 'd': opt.depth = std::atoi(optarg); break;
+        case 'n': opt.seconds = std::atoi(optarg); break;
+        case 'k': opt.keys = std::atoi(optarg); break;
+        case 'v': opt.valueSize = std::atoi(optarg); break;
+        case 'r': opt.getPercent = std::atoi(optarg); break;
+        case 'M': opt.meta = std::string(optarg) == "meta"; break;
+        default:
+            std::cerr << "用法: " << argv[0] << " [-H 主机] [-p 端口] [-c 连接数] [-d 流水线深度] [-n 秒数]"
+                      << " [-k key数量] [-v 值字节数] [-r get百分比] [-M text|meta]" << std::endl;
+            return c == 'h' ? 0 : 1;
+        }
+    }
+
+    const std::string value(opt.valueSize, 'x');
+    if (!preload(opt, value))
+    {
+        std::cerr << "预热或回读校验失败" << std::endl;
+        return 1;
+    }
+
+    std::atomic<bool> running{true};
+    std::atomic<long long> totalOps{0};
+    std::atomic<long long> totalHits{0};
+    std::atomic<long long> totalGets{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < opt.connections; ++t)
+    {
+        workers.emplace_back([&, t]() {
+            int fd = connectTo(opt);
+            std::mt19937 gen(t * 7919 + 1);
+            std::string batch;
+            std::string inbuf;
+            std::vector<bool> isGet;
+            long long ops = 0, hits = 0, gets = 0;
+            while (running.load(std::memory_order_relaxed))
+            {
+                batch.clear();
+                isGet.clear();
+                for (int i = 0; i < opt.depth; ++i)
+                {
+                    std::string key = keyOf(static_cast<int>(gen() % opt.keys));
+                    bool get = static_cast<int>(gen() % 100) < opt.getPercent;
+                    if (get)
+                        appendGet(batch, key, opt.meta);
+                    else
+                        appendSet(batch, key, value, opt.meta);
+                    isGet.push_back(get);
+                    gets += get ? 1 : 0;
+                }
+                int h = roundTrip(fd, batch, isGet, opt.meta, inbuf);
+                if (h < 0)
+                {
+                    std::cerr << "连接中断" << std::endl;
+                    break;
+                }
+                hits += h;
+                ops += opt.depth;
+            }
+            ::close(fd);
+            totalOps += ops;
+            totalHits += hits;
+            totalGets += gets;
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::seconds(opt.seconds));
+    running = false;
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "连接数 " << opt.connections << "，流水线深度 " << opt.depth
+              << "，协议 " << (opt.meta ? "meta" : "text") << std::endl;
+    std::cout << std::fixed << std::setprecision(0)
+              << "吞吐: " << totalOps / seconds << " ops/s"
+              << std::setprecision(2) << "，get命中率: "
+              << (totalGets > 0 ? 100.0 * totalHits / totalGets : 0.0) << "%" << std::endl;
+    return 0;
+}
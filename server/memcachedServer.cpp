@@ -0,0 +1,10 @@
+#include "MemcacheHandler.h"
+#include "ServerMain.h"
+
+// memcached协议缓存服务：以分片缓存作为存储，每个CPU核一个epoll事件循环
+// 用法: memcachedServer [-p 端口] [-t 线程数] [-m 容量(条目数)] [-s 分片数] [-P lru|lfu]
+
+int main(int argc, char* argv[])
+{
+    return XrmsServer::runServerMain<XrmsServer::MemcacheHandler>(argc, argv, "memcachedServer", 11211);
+}
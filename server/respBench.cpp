@@ -0,0 +1,269 @@
+#include <arpa/inet.h>
+#include <getopt.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// respServer 的回环压测客户端：多连接流水线发送GET/SET（或MGET），统计吞吐与命中率
+// 用法: respBench [-H 主机] [-p 端口] [-c 连接数] [-d 流水线深度] [-n 秒数]
+//                 [-k key数量] [-v 值字节数] [-r 读百分比] [-b 每个MGET的key数(1表示用GET)]
+
+namespace
+{
+
+struct Options
+{
+    std::string host = "127.0.0.1";
+    uint16_t port = 6379;
+    int connections = 4;
+    int depth = 32;
+    int seconds = 5;
+    int keys = 100000;
+    int valueSize = 32;
+    int readPercent = 90;
+    int mgetKeys = 1;
+};
+
+const size_t INCOMPLETE = std::string_view::npos;
+
+int connectTo(const Options& opt)
+{
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(opt.port);
+    ::inet_pton(AF_INET, opt.host.c_str(), &addr.sin_addr);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0)
+    {
+        std::cerr << "连接 " << opt.host << ":" << opt.port << " 失败: " << std::strerror(errno) << std::endl;
+        std::exit(1);
+    }
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+bool writeAll(int fd, const std::string& data)
+{
+    size_t sent = 0;
+    while (sent < data.size())
+    {
+        ssize_t n = ::write(fd, data.data() + sent, data.size() - sent);
+        if (n <= 0)
+            return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// 解析一个RESP回复，返回其后的位置，不完整返回INCOMPLETE；非空的bulk计为一次命中
+size_t parseReply(std::string_view buf, size_t pos, long long& hits)
+{
+    size_t eol = buf.find("\r\n", pos);
+    if (eol == std::string_view::npos)
+        return INCOMPLETE;
+    char type = buf[pos];
+    long long n = std::strtoll(std::string(buf.substr(pos + 1, eol - pos - 1)).c_str(), nullptr, 10);
+    pos = eol + 2;
+    if (type == '$')
+    {
+        if (n < 0)
+            return pos;
+        if (buf.size() < pos + n + 2)
+            return INCOMPLETE;
+        ++hits;
+        return pos + n + 2;
+    }
+    if (type == '*')
+    {
+        for (long long i = 0; i < n; ++i)
+        {
+            pos = parseReply(buf, pos, hits);
+            if (pos == INCOMPLETE)
+                return INCOMPLETE;
+        }
+    }
+    return pos;
+}
+
+// 发送一批命令并读完replies条回复，返回命中数，出错返回-1
+long long roundTrip(int fd, const std::string& batch, int replies, std::string& inbuf)
+{
+    if (!writeAll(fd, batch))
+        return -1;
+    inbuf.clear();
+    size_t pos = 0;
+    long long hits = 0;
+    char buffer[64 * 1024];
+    for (int parsed = 0; parsed < replies; )
+    {
+        long long h = 0;
+        size_t next = parseReply(inbuf, pos, h);
+        if (next != INCOMPLETE && pos < inbuf.size())
+        {
+            pos = next;
+            hits += h;
+            ++parsed;
+            continue;
+        }
+        ssize_t n = ::read(fd, buffer, sizeof(buffer));
+        if (n <= 0)
+            return -1;
+        inbuf.append(buffer, static_cast<size_t>(n));
+    }
+    return hits;
+}
+
+void appendCommand(std::string& out, const std::vector<std::string>& args)
+{
+    out += "*" + std::to_string(args.size()) + "\r\n";
+    for (const auto& arg : args)
+    {
+        out += "$" + std::to_string(arg.size()) + "\r\n" + arg + "\r\n";
+    }
+}
+
+std::string keyOf(int i)
+{
+    return "key:" + std::to_string(i);
+}
+
+// 用MSET预热全部key，并用GET抽查回读内容
+bool preload(const Options& opt, const std::string& value)
+{
+    int fd = connectTo(opt);
+    std::string inbuf;
+    for (int begin = 0; begin < opt.keys; begin += 1000)
+    {
+        std::vector<std::string> args{"MSET"};
+        for (int i = begin; i < std::min(opt.keys, begin + 1000); ++i)
+        {
+            args.push_back(keyOf(i));
+            args.push_back(value);
+        }
+        std::string batch;
+        appendCommand(batch, args);
+        if (roundTrip(fd, batch, 1, inbuf) < 0)
+            return false;
+    }
+    std::string check;
+    appendCommand(check, {"GET", keyOf(0)});
+    bool ok = roundTrip(fd, check, 1, inbuf) == 1
+              && inbuf == "$" + std::to_string(value.size()) + "\r\n" + value + "\r\n";
+    ::close(fd);
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Options opt;
+    int c;
+    while ((c = ::getopt(argc, argv, "H:p:c:d:n:k:v:r:b:h")) != -1)
+    {
+        switch (c)
+        {
+        case 'H': opt.host = optarg; break;
+        case 'p': opt.port = static_cast<uint16_t>(std::atoi(optarg)); break;
+        case 'c': opt.connections = std::atoi(optarg); break;
+        case 'd': opt.depth = std::atoi(optarg); break;
+        case 'n': opt.seconds = std::atoi(optarg); break;
+        case 'k': opt.keys = std::atoi(optarg); break;
+        case 'v': opt.valueSize = std::atoi(optarg); break;
+        case 'r': opt.readPercent = std::atoi(optarg); break;
+        case 'b': opt.mgetKeys = std::max(1, std::atoi(optarg)); break;
+        default:
+            std::cerr << "用法: " << argv[0] << " [-H 主机] [-p 端口] [-c 连接数] [-d 流水线深度] [-n 秒数]"
+                      << " [-k key数量] [-v 值字节数] [-r 读百分比] [-b 每个MGET的key数]" << std::endl;
+            return c == 'h' ? 0 : 1;
+        }
+    }
+
+    const std::string value(opt.valueSize, 'x');
+    if (!preload(opt, value))
+    {
+        std::cerr << "预热或回读校验失败" << std::endl;
+        return 1;
+    }
+
+    std::atomic<bool> running{true};
+    std::atomic<long long> totalKeys{0};
+    std::atomic<long long> totalReads{0};
+    std::atomic<long long> totalHits{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < opt.connections; ++t)
+    {
+        workers.emplace_back([&, t]() {
+            int fd = connectTo(opt);
+            std::mt19937 gen(t * 7919 + 1);
+            std::string batch;
+            std::string inbuf;
+            std::vector<std::string> args;
+            long long keys = 0, reads = 0, hits = 0;
+            while (running.load(std::memory_order_relaxed))
+            {
+                batch.clear();
+                for (int i = 0; i < opt.depth; ++i)
+                {
+                    args.clear();
+                    if (static_cast<int>(gen() % 100) < opt.readPercent)
+                    {
+                        args.push_back(opt.mgetKeys > 1 ? "MGET" : "GET");
+                        for (int k = 0; k < opt.mgetKeys; ++k)
+                            args.push_back(keyOf(static_cast<int>(gen() % opt.keys)));
+                        reads += opt.mgetKeys;
+                        keys += opt.mgetKeys;
+                    }
+                    else
+                    {
+                        args = {"SET", keyOf(static_cast<int>(gen() % opt.keys)), value};
+                        keys += 1;
+                    }
+                    appendCommand(batch, args);
+                }
+                long long h = roundTrip(fd, batch, opt.depth, inbuf);
+                if (h < 0)
+                {
+                    std::cerr << "连接中断" << std::endl;
+                    break;
+                }
+                hits += h;
+            }
+            ::close(fd);
+            totalKeys += keys;
+            totalReads += reads;
+            totalHits += hits;
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::seconds(opt.seconds));
+    running = false;
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "连接数 " << opt.connections << "，流水线深度 " << opt.depth
+              << "，每次读取key数 " << opt.mgetKeys << std::endl;
+    std::cout << std::fixed << std::setprecision(0)
+              << "吞吐: " << totalKeys / seconds << " keys/s"
+              << std::setprecision(2) << "，读命中率: "
+              << (totalReads > 0 ? 100.0 * totalHits / totalReads : 0.0) << "%" << std::endl;
+    return 0;
+}
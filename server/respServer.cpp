@@ -0,0 +1,10 @@
+#include "RespHandler.h"
+#include "ServerMain.h"
+
+// RESP2(Redis协议)子集缓存服务：流水线命令按分片分组批量执行
+// 用法: respServer [-p 端口] [-t 线程数] [-m 容量(条目数)] [-s 分片数] [-P lru|lfu]
+
+int main(int argc, char* argv[])
+{
+    return XrmsServer::runServerMain<XrmsServer::RespHandler>(argc, argv, "respServer", 6379);
+}
@@ -5,6 +5,7 @@
 #include <iomanip>
 #include <random>
 #include <algorithm>
+#include <array>
 
 // 引入自定义的缓存策略头文件
 #include "ICachePolicy.h"